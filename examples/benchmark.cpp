@@ -0,0 +1,221 @@
+#include <ESPTools/logger.h>
+#include <ESPTools/benchmark.h>
+#include <ESPTools/core.h>
+#include <ESPTools/fast_gpio.h>
+#include <ESPTools/gpio_event.h>
+#include <ESPTools/gpio_state_set.h>
+#include <ESPTools/isr_dispatch.h>
+#include <ESPTools/ring_buffer.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+#include <driver/gpio.h>
+#include <esp_attr.h>
+#include <esp_cpu.h>
+#include <esp_timer.h>
+
+extern "C"
+{
+  void app_main(void);
+}
+
+// Pin used by the GPIO benchmarks. It is configured as input/output, so the ISR latency is
+// measured by triggering the interrupt with its own output, no external wiring is needed.
+#ifndef ESPTOOLS_BENCHMARK_PIN
+#define ESPTOOLS_BENCHMARK_PIN GPIO_NUM_4
+#endif
+
+namespace
+{
+
+  using BenchmarkPin = ESPTools::FastGpio<ESPTOOLS_BENCHMARK_PIN>;
+
+  // Number of items used by the queue/ring buffer benchmarks
+  constexpr size_t QUEUE_ITEMS{64};
+
+  // Shared harness, reset before every benchmark
+  ESPTools::Benchmark<> benchmark;
+
+  // Written by the ISR of the latency benchmark
+  volatile uint32_t isr_cycles{0};
+  volatile bool isr_fired{false};
+
+  void IRAM_ATTR LatencyIsr(void *)
+  {
+    isr_cycles = esp_cpu_get_cycle_count();
+    isr_fired = true;
+  }
+
+  template <typename Function>
+  void Run(const char *const name, Function &&function)
+  {
+    benchmark.Reset();
+    benchmark.Measure(function).Report(name);
+  }
+
+  void BenchmarkGpio()
+  {
+    BenchmarkPin::ConfigureOutput();
+    volatile int level{0};
+    Run("gpio_get_level", [&]
+        { level = gpio_get_level(BenchmarkPin::NUM); });
+    Run("FastGpio::Read", [&]
+        { level = BenchmarkPin::Read(); });
+    Run("GpioStateSet::ReadInputs", [&]
+        { level = ESPTools::GpioStateSet::ReadInputs().CountHigh(); });
+    Run("gpio_set_level", []
+        { gpio_set_level(BenchmarkPin::NUM, 1); });
+    Run("FastGpio::Set", []
+        { BenchmarkPin::Set(); });
+    Run("FastGpio::Toggle", []
+        { BenchmarkPin::Toggle(); });
+  }
+
+  void BenchmarkLogger()
+  {
+    // Tag used for the logging system. Disabled at runtime, so only the cost of a filtered
+    // message is measured, not the UART output.
+    static constexpr char LOG_TAG[]{"Benchmark Logger"};
+    esp_log_level_set(LOG_TAG, ESP_LOG_NONE);
+    Run("ESPTOOLS_LOGV (filtered)", []
+        { ESPTOOLS_LOGV("Value %d", 1); });
+    Run("ESPTOOLS_LOGD (filtered)", []
+        { ESPTOOLS_LOGD("Value %d", 1); });
+    Run("ESPTOOLS_LOGI (filtered)", []
+        { ESPTOOLS_LOGI("Value %d", 1); });
+    Run("ESPTOOLS_LOGW (filtered)", []
+        { ESPTOOLS_LOGW("Value %d", 1); });
+    Run("ESPTOOLS_LOGE (filtered)", []
+        { ESPTOOLS_LOGE("Value %d", 1); });
+  }
+
+  void BenchmarkIsrLatency()
+  {
+    BenchmarkPin::ConfigureOutput();
+    // The latency is only meaningful with the ISR running from IRAM
+    ESPTools::RequireIsrServiceFlags(ESP_INTR_FLAG_IRAM);
+    ESP_ERROR_CHECK(gpio_set_intr_type(BenchmarkPin::NUM, GPIO_INTR_ANYEDGE));
+    ESP_ERROR_CHECK(gpio_isr_handler_add(BenchmarkPin::NUM, LatencyIsr, nullptr));
+    ESP_ERROR_CHECK(gpio_intr_enable(BenchmarkPin::NUM));
+
+    benchmark.Reset();
+    for (int i{0}; i < 256; ++i)
+    {
+      isr_fired = false;
+      const uint32_t start{esp_cpu_get_cycle_count()};
+      BenchmarkPin::Toggle();
+      const int64_t timeout_us{esp_timer_get_time() + 1000};
+      while (!isr_fired && esp_timer_get_time() < timeout_us)
+      {
+      }
+      if (isr_fired)
+      {
+        benchmark.AddSample(isr_cycles - start);
+      }
+    }
+    benchmark.Report("ISR entry latency");
+
+    ESP_ERROR_CHECK(gpio_intr_disable(BenchmarkPin::NUM));
+    ESP_ERROR_CHECK(gpio_isr_handler_remove(BenchmarkPin::NUM));
+  }
+
+  void BenchmarkIsrDispatch()
+  {
+    // Same loopback, through the ESPTools dispatch table, which measures the latency itself
+    BenchmarkPin::ConfigureOutput();
+    ESP_ERROR_CHECK(gpio_set_intr_type(BenchmarkPin::NUM, GPIO_INTR_ANYEDGE));
+    ESPTools::IsrDispatchTable::Register<BenchmarkPin::NUM>(LatencyIsr);
+    ESP_ERROR_CHECK(gpio_intr_enable(BenchmarkPin::NUM));
+
+    for (int i{0}; i < 256; ++i)
+    {
+      isr_fired = false;
+      ESPTools::IsrDispatchTable::MarkTrigger(BenchmarkPin::NUM);
+      BenchmarkPin::Toggle();
+      const int64_t timeout_us{esp_timer_get_time() + 1000};
+      while (!isr_fired && esp_timer_get_time() < timeout_us)
+      {
+      }
+    }
+    ESPTools::IsrDispatchTable::Report();
+
+    ESP_ERROR_CHECK(gpio_intr_disable(BenchmarkPin::NUM));
+    ESPTools::IsrDispatchTable::Unregister(BenchmarkPin::NUM);
+  }
+
+  void BenchmarkQueues()
+  {
+    static StaticQueue_t queue_buffer;
+    static uint8_t queue_storage[QUEUE_ITEMS * sizeof(ESPTools::GpioEvent)];
+    const QueueHandle_t queue{xQueueCreateStatic(QUEUE_ITEMS, sizeof(ESPTools::GpioEvent),
+                                                 queue_storage, &queue_buffer)};
+    static ESPTools::SpscRingBuffer<ESPTools::GpioEvent, QUEUE_ITEMS> spsc;
+    static ESPTools::MpscRingBuffer<ESPTools::GpioEvent, QUEUE_ITEMS> mpsc;
+    ESPTools::GpioEvent event{0, ESPTOOLS_BENCHMARK_PIN, ESPTools::GpioState::High};
+
+    Run("FreeRTOS queue push+pop", [&]
+        {
+          xQueueSend(queue, &event, 0);
+          xQueueReceive(queue, &event, 0);
+        });
+    Run("SpscRingBuffer push+pop", [&]
+        {
+          spsc.Push(event);
+          spsc.Pop(event);
+        });
+    Run("MpscRingBuffer push+pop", [&]
+        {
+          mpsc.Push(event);
+          mpsc.Pop(event);
+        });
+
+    // Throughput of a full batch
+    ESPTools::GpioEvent batch[QUEUE_ITEMS];
+    Run("FreeRTOS queue batch (64 items)", [&]
+        {
+          for (size_t i{0}; i < QUEUE_ITEMS; ++i)
+          {
+            xQueueSend(queue, &event, 0);
+          }
+          for (size_t i{0}; i < QUEUE_ITEMS; ++i)
+          {
+            xQueueReceive(queue, &event, 0);
+          }
+        });
+    Run("SpscRingBuffer batch (64 items)", [&]
+        {
+          for (size_t i{0}; i < QUEUE_ITEMS; ++i)
+          {
+            spsc.Push(event);
+          }
+          spsc.PopBatch(batch, QUEUE_ITEMS);
+        });
+
+    vQueueDelete(queue);
+  }
+
+} // namespace
+
+void app_main()
+{
+  // Tag used for the logging system
+  static constexpr char LOG_TAG[]{"Benchmark"};
+
+  ESPTOOLS_LOGI("Running benchmarks on GPIO %d at %" PRIu32 " MHz",
+                ESPTOOLS_BENCHMARK_PIN, esp_rom_get_cpu_ticks_per_us());
+  const int64_t start_us{esp_timer_get_time()};
+  BenchmarkGpio();
+  BenchmarkLogger();
+  BenchmarkIsrLatency();
+  BenchmarkIsrDispatch();
+  BenchmarkQueues();
+  ESPTOOLS_LOGI("Benchmarks finished in %" PRIu32 " ms",
+                static_cast<uint32_t>((esp_timer_get_time() - start_us) / 1000));
+
+  while (true)
+  {
+    vTaskDelay(portMAX_DELAY);
+  }
+}
@@ -0,0 +1,78 @@
+#include <ESPTools/board_pins.h>
+#include <ESPTools/gpio_state_set.h>
+#include <ESPTools/logger.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <driver/gpio.h>
+
+#include <cinttypes>
+
+extern "C"
+{
+  void app_main(void);
+}
+
+// Tag used for the logging system
+static constexpr char LOG_TAG[]{"Board Pins"};
+
+namespace
+{
+  using Pins = ESPTools::BoardPins<>;
+
+  // Options of the pins, shared by every board
+  constexpr ESPTools::PinGroupOptions BUTTON_OPTIONS{GPIO_MODE_INPUT, true};
+  // The BOOT button is on a strapping pin, it is only read once the chip is running
+  constexpr ESPTools::PinGroupOptions BOOT_OPTIONS{.mode = GPIO_MODE_INPUT,
+                                                   .pull_up = true,
+                                                   .allow_strapping = true};
+  constexpr ESPTools::PinGroupOptions LED_OPTIONS{GPIO_MODE_OUTPUT};
+
+  // Pin map of each board. A pin that cannot be used for its function fails the build.
+#if CONFIG_IDF_TARGET_ESP32C2
+  // esp32-c2-devkitm-1
+  struct Board
+  {
+    using Boot = Pins::Group<BOOT_OPTIONS, GPIO_NUM_9>;
+    using Buttons = Pins::Group<BUTTON_OPTIONS, GPIO_NUM_2, GPIO_NUM_3, GPIO_NUM_4>;
+    using Leds = Pins::Group<LED_OPTIONS, GPIO_NUM_5, GPIO_NUM_6>;
+  };
+#elif CONFIG_IDF_TARGET_ESP32S3
+  // esp32-s3-devkitc-1
+  struct Board
+  {
+    using Boot = Pins::Group<BOOT_OPTIONS, GPIO_NUM_0>;
+    using Buttons = Pins::Group<BUTTON_OPTIONS, GPIO_NUM_4, GPIO_NUM_5, GPIO_NUM_6>;
+    using Leds = Pins::Group<LED_OPTIONS, GPIO_NUM_7, GPIO_NUM_15>;
+  };
+#else
+  // esp32dev and featheresp32. GPIO34-39 have no pull resistors, so the buttons cannot use them
+  // without external pull-ups.
+  struct Board
+  {
+    using Boot = Pins::Group<BOOT_OPTIONS, GPIO_NUM_0>;
+    using Buttons = Pins::Group<BUTTON_OPTIONS, GPIO_NUM_25, GPIO_NUM_26, GPIO_NUM_27>;
+    using Leds = Pins::Group<LED_OPTIONS, GPIO_NUM_13, GPIO_NUM_14>;
+  };
+#endif
+} // namespace
+
+void app_main()
+{
+  // Set the logging level of this tag to verbose
+  esp_log_level_set(LOG_TAG, ESP_LOG_VERBOSE);
+
+  // One gpio_config() call per group, the masks have been computed by the compiler
+  ESPTools::ConfigurePinGroups<Board::Boot, Board::Buttons, Board::Leds>();
+
+  constexpr ESPTools::GpioStateSet::Mask inputs{Board::Boot::MASK | Board::Buttons::MASK};
+  while (true)
+  {
+    // Buttons are active low, so released buttons read as High
+    const ESPTools::GpioStateSet::Mask released{
+        ESPTools::GpioStateSet::ReadInputs(inputs).GetHigh()};
+    ESPTOOLS_LOGV("Released buttons -> 0x%08" PRIx32, static_cast<uint32_t>(released));
+    vTaskDelay(pdMS_TO_TICKS(500));
+  }
+}
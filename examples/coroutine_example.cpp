@@ -0,0 +1,91 @@
+#include <ESPTools/logger.h>
+#include <ESPTools/coroutine.h>
+#include <ESPTools/gpio_state.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <driver/gpio.h>
+
+extern "C"
+{
+  void app_main(void);
+}
+
+// Tag used for the logging system
+static constexpr char LOG_TAG[]{"Coroutine"};
+
+// Set by the button behavior, awaited by the reporter
+static ESPTools::AsyncEvent button_pressed;
+
+// Blinks a LED forever, the frame only holds the pin and the awaiter
+static ESPTools::CoTask Blink(const gpio_num_t pin, const uint32_t period_ms)
+{
+  while (true)
+  {
+    gpio_set_level(pin, 1);
+    co_await ESPTools::Delay(period_ms / 2);
+    gpio_set_level(pin, 0);
+    co_await ESPTools::Delay(period_ms / 2);
+  }
+}
+
+// Waits for presses of an active low button, debounced by waiting after every edge
+static ESPTools::CoTask Button(const gpio_num_t pin)
+{
+  while (true)
+  {
+    const int64_t pressed_us{co_await ESPTools::PinEdge(pin, ESPTools::GpioState::High, true)};
+    ESPTOOLS_LOGI("Button pressed at %" PRId64 " us", pressed_us);
+    button_pressed.Set();
+    co_await ESPTools::PinEdge(pin, ESPTools::GpioState::Low, true);
+    co_await ESPTools::Delay(20);
+  }
+}
+
+// Counts the presses reported through the event
+static ESPTools::CoTask Reporter()
+{
+  uint32_t presses{0};
+  while (true)
+  {
+    co_await button_pressed;
+    ESPTOOLS_LOGI("%" PRIu32 " presses", ++presses);
+  }
+}
+
+void app_main()
+{
+  constexpr gpio_num_t BUTTON_PIN{GPIO_NUM_9};
+  constexpr gpio_num_t LED_PINS[]{GPIO_NUM_4, GPIO_NUM_5, GPIO_NUM_6};
+
+  const gpio_config_t button_config{
+      .pin_bit_mask = ESPTools::CreateBitMaskAt<uint64_t>(BUTTON_PIN),
+      .mode = GPIO_MODE_INPUT,
+      .pull_up_en = GPIO_PULLUP_ENABLE,
+      .pull_down_en = GPIO_PULLDOWN_DISABLE,
+      .intr_type = GPIO_INTR_DISABLE,
+  };
+  ESP_ERROR_CHECK(gpio_config(&button_config));
+
+  // Every behavior runs on the stack of this single executor task
+  static ESPTools::CoExecutor executor;
+  uint32_t period_ms{500};
+  for (const gpio_num_t pin : LED_PINS)
+  {
+    ESP_ERROR_CHECK(gpio_set_direction(pin, GPIO_MODE_OUTPUT));
+    executor.Spawn(Blink(pin, period_ms));
+    period_ms += 250;
+  }
+  executor.Spawn(Button(BUTTON_PIN));
+  executor.Spawn(Reporter());
+  executor.Start();
+
+  while (true)
+  {
+    ESPTOOLS_LOGI("%u coroutines alive, %u free frames at least",
+                  static_cast<unsigned>(executor.GetCount()),
+                  static_cast<unsigned>(ESPTools::CoTask::GetMinFreeFrames()));
+    vTaskDelay(pdMS_TO_TICKS(10000));
+  }
+}
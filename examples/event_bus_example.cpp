@@ -0,0 +1,90 @@
+#include <ESPTools/event_bus.h>
+#include <ESPTools/gpio_input.h>
+#include <ESPTools/logger.h>
+#include <ESPTools/task.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+extern "C"
+{
+  void app_main(void);
+}
+
+// Tag used for the logging system
+static constexpr char LOG_TAG[]{"EventBus"};
+
+namespace
+{
+  using Bus = ESPTools::EventBus<>;
+  using ESPTools::EventTopic;
+
+  // Events of both buttons, published from their ISRs
+  Bus bus;
+
+  /**
+   * @brief Task that counts the presses of every button, on its own queue of the bus
+   */
+  class PressCounterTask : public ESPTools::StaticTask<3072>
+  {
+  public:
+    PressCounterTask() : StaticTask("presses", 2), presses_() {}
+
+    ~PressCounterTask() override { Stop(); }
+
+    Bus::Subscriber subscriber;
+
+  protected:
+    void Run() override
+    {
+      while (true)
+      {
+        const Bus::EventRef event{subscriber.Receive()};
+        if (event && event->payload.state == ESPTools::GpioState::High)
+        {
+          ESPTOOLS_LOGV("GPIO %u pressed %" PRIu32 " times", event->payload.pin,
+                        ++presses_[event->payload.pin]);
+        }
+      }
+    }
+
+  private:
+    uint32_t presses_[SOC_GPIO_PIN_COUNT];
+  };
+} // namespace
+
+void app_main()
+{
+  // Set the logging level of this tag to verbose
+  esp_log_level_set(LOG_TAG, ESP_LOG_VERBOSE);
+
+  // Two subscribers of the same events: this task logs them and the counter task counts them
+  static PressCounterTask counter;
+  counter.Start();
+  bus.Subscribe<EventTopic::GpioStateChange>(counter.subscriber, counter.GetHandle());
+  static Bus::Subscriber logger;
+  bus.Subscribe<EventTopic::GpioStateChange>(logger);
+
+  // Active low buttons, both publish on the same topic
+  static ESPTools::GpioInput button_a(GPIO_NUM_9, true, 10000, GPIO_PULLUP_ONLY,
+                                      Bus::PublishGpioInput<EventTopic::GpioStateChange>, &bus);
+  static ESPTools::GpioInput button_b(GPIO_NUM_4, true, 10000, GPIO_PULLUP_ONLY,
+                                      Bus::PublishGpioInput<EventTopic::GpioStateChange>, &bus);
+
+  while (true)
+  {
+    // Every event is received by reference, the payload is not copied again
+    const Bus::EventRef event{logger.Receive()};
+    if (!event)
+    {
+      continue;
+    }
+    ESPTOOLS_LOGV("GPIO %u -> %s at %" PRId64 " us", event->payload.pin,
+                  event->payload.state.ToStr(), event->payload.timestamp_us);
+    if (logger.GetDropped() > 0 || bus.GetDropped() > 0)
+    {
+      ESPTOOLS_LOGW("Dropped events: %" PRIu32 " by the logger, %" PRIu32 " by the bus",
+                    logger.GetDropped(), bus.GetDropped());
+    }
+  }
+}
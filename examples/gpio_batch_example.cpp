@@ -0,0 +1,57 @@
+#include <ESPTools/gpio_batch_config.h>
+#include <ESPTools/gpio_state.h>
+#include <ESPTools/logger.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <driver/gpio.h>
+#include <esp_attr.h>
+#include <esp_intr_alloc.h>
+
+#include <atomic>
+#include <cinttypes>
+
+extern "C"
+{
+  void app_main(void);
+}
+
+// Tag used for the logging system
+static constexpr char LOG_TAG[]{"GPIO Batch"};
+
+namespace
+{
+  // Presses counted by the ISR
+  std::atomic<uint32_t> presses{0};
+
+  void IRAM_ATTR OnButton(void *)
+  {
+    presses.store(presses.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+} // namespace
+
+void app_main()
+{
+  // Set the logging level of this tag to verbose
+  esp_log_level_set(LOG_TAG, ESP_LOG_VERBOSE);
+
+  // Four buttons and four outputs end up in three gpio_config() calls
+  static ESPTools::GpioBatchConfig batch;
+  for (const gpio_num_t pin : {GPIO_NUM_2, GPIO_NUM_3, GPIO_NUM_4, GPIO_NUM_5})
+  {
+    batch.AddInput(pin, GPIO_PULLUP_ONLY, GPIO_INTR_NEGEDGE).AddIsrHandler(pin, OnButton, nullptr);
+  }
+  batch.AddOutput(GPIO_NUM_6, ESPTools::GpioState::High)
+      .AddOutput(GPIO_NUM_7)
+      .AddOutput(GPIO_NUM_10)
+      .AddOutput(GPIO_NUM_18, ESPTools::GpioState::High, true);
+  const ESPTools::GpioBatchStats stats{batch.Apply(ESP_INTR_FLAG_IRAM)};
+  ESPTOOLS_LOGV("%u pins in %" PRIu32 " us", stats.pins, stats.elapsed_us);
+
+  while (true)
+  {
+    ESPTOOLS_LOGV("Presses -> %" PRIu32, presses.load(std::memory_order_relaxed));
+    vTaskDelay(pdMS_TO_TICKS(1000));
+  }
+}
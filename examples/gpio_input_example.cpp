@@ -0,0 +1,51 @@
+#include <ESPTools/logger.h>
+#include <ESPTools/gpio_event.h>
+#include <ESPTools/gpio_input.h>
+#include <ESPTools/ring_buffer.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_attr.h>
+
+extern "C"
+{
+  void app_main(void);
+}
+
+// Task notified from the ISR every time the button changes its state
+static TaskHandle_t button_task{nullptr};
+// Edge events passed from the ISR to the task
+static ESPTools::SpscRingBuffer<ESPTools::GpioEvent, 16> button_events;
+
+static void IRAM_ATTR OnButtonChange(ESPTools::GpioInput &input, ESPTools::GpioState state,
+                                     int64_t timestamp_us, void *)
+{
+  button_events.Push({timestamp_us, static_cast<uint8_t>(input.GetPin()), state});
+  BaseType_t higher_priority_task_woken{pdFALSE};
+  vTaskNotifyGiveFromISR(button_task, &higher_priority_task_woken);
+  portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+void app_main()
+{
+  // Tag used for the logging system
+  static constexpr char LOG_TAG[]{"GPIO Input"};
+  // Set the logging level of this tag to verbose
+  esp_log_level_set(LOG_TAG, ESP_LOG_VERBOSE);
+
+  button_task = xTaskGetCurrentTaskHandle();
+
+  // Active low button on GPIO 9 (BOOT button of the ESP32-C2 DevKitM-1) debounced for 10 ms
+  static ESPTools::GpioInput button(GPIO_NUM_9, true, 10000, GPIO_PULLUP_ONLY, OnButtonChange);
+
+  while (true)
+  {
+    // Block until the ISR reports a transition, no polling involved
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    // Process every event queued since the last wakeup
+    button_events.Drain([](const ESPTools::GpioEvent &event)
+                        { ESPTOOLS_LOGV("GPIO %u -> %s at %" PRId64 " us",
+                                        event.pin, event.state.ToStr(), event.timestamp_us); });
+  }
+}
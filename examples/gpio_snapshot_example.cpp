@@ -0,0 +1,67 @@
+#include <ESPTools/logger.h>
+#include <ESPTools/gpio_snapshot.h>
+#include <ESPTools/gpio_state.h>
+#include <ESPTools/gpio_state_set.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+#include <esp_system.h>
+#include <soc/soc_caps.h>
+
+extern "C"
+{
+  void app_main(void);
+}
+
+// Tag used for the logging system
+static constexpr char LOG_TAG[]{"GPIO Snapshot"};
+
+void app_main()
+{
+  // Relay on GPIO 4 and an active low LED on GPIO 5
+  constexpr ESPTools::GpioStateSet::Mask OUTPUTS{0b110000};
+  constexpr ESPTools::GpioStateSet::Mask INVERSE{0b100000};
+
+  // With ESPTOOLS_GPIO_SNAPSHOT_EARLY_RESTORE this already ran before app_main(), and the
+  // snapshot is only loaded here to resume from the saved states
+  ESPTools::GpioStateSet outputs;
+  ESPTools::GpioStateSet::Mask inverse_mask{INVERSE};
+  const ESPTools::GpioStateSet::Mask restored{ESPTools::GpioSnapshot::Restore()};
+  if (!ESPTools::GpioSnapshot::Load(outputs, inverse_mask))
+  {
+    // First boot, or no snapshot kept through the reset: start with everything off
+    const gpio_config_t config{
+        .pin_bit_mask = OUTPUTS,
+        .mode = GPIO_MODE_OUTPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    ESP_ERROR_CHECK(gpio_config(&config));
+    outputs = ESPTools::GpioStateSet(0, OUTPUTS);
+    outputs.ApplyInverseLogic(inverse_mask).WriteOutputs();
+    // The pads may still be held by a previous run that lost its snapshot
+    ESPTools::GpioSnapshot::Release(OUTPUTS);
+  }
+  ESPTOOLS_LOGI("Restored pins 0x%08" PRIx32 ", relay %s, LED %s",
+                static_cast<uint32_t>(restored), outputs.Get(4).ToStr(), outputs.Get(5).ToStr());
+
+  // Toggle both outputs, and keep them through the reset
+  outputs = ESPTools::GpioStateSet(~outputs.GetLevels(), OUTPUTS);
+  outputs.ApplyInverseLogic(inverse_mask).WriteOutputs();
+  ESPTools::GpioSnapshot::Save(outputs, inverse_mask);
+  ESPTools::GpioSnapshot::Hold();
+
+  vTaskDelay(pdMS_TO_TICKS(5000));
+#if SOC_RTC_SLOW_MEM_SUPPORTED
+  // The snapshot is in RTC memory, which is kept through the deep sleep
+  ESP_ERROR_CHECK(esp_sleep_enable_timer_wakeup(10 * 1000 * 1000));
+  esp_deep_sleep_start();
+#else
+  // Without RTC memory (ESP32-C2) the snapshot is lost in deep sleep, but kept by a software reset
+  esp_restart();
+#endif
+}
@@ -1,9 +1,12 @@
 #include <ESPTools/logger.h>
 #include <ESPTools/gpio_state.h>
+#include <ESPTools/gpio_state_set.h>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
+#include <driver/gpio.h>
+
 extern "C"
 {
   void app_main(void);
@@ -23,10 +26,29 @@ void app_main()
   // GPIO state initialized to ESPTools::GpioState::High
   ESPTools::GpioState state_3(0, true);
 
+  // Pins 2 to 5 sampled at once, pins 4 and 5 are active low
+  constexpr ESPTools::GpioStateSet::Mask pins{0b111100};
+  constexpr ESPTools::GpioStateSet::Mask inverse_pins{0b110000};
+  ESPTools::GpioStateSet previous_set;
+  const gpio_config_t config{
+      .pin_bit_mask = pins,
+      .mode = GPIO_MODE_INPUT,
+      .pull_up_en = GPIO_PULLUP_ENABLE,
+      .pull_down_en = GPIO_PULLDOWN_DISABLE,
+      .intr_type = GPIO_INTR_DISABLE,
+  };
+  ESP_ERROR_CHECK(gpio_config(&config));
+
   while (true)
   {
     ESPTOOLS_LOGV("State 1 -> %s, State 2 -> %s, State 3 -> %s",
                   state_1.ToStr(), state_2.ToStr(), state_3.ToStr());
+
+    const ESPTools::GpioStateSet set{
+        ESPTools::GpioStateSet::ReadInputs(pins).ApplyInverseLogic(inverse_pins)};
+    ESPTOOLS_LOGV("High pins -> %d, changed mask -> 0x%08" PRIx32, set.CountHigh(),
+                  static_cast<uint32_t>(set.Changed(previous_set)));
+    previous_set = set;
     vTaskDelay(pdMS_TO_TICKS(5000));
   }
 }
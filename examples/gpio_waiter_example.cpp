@@ -0,0 +1,46 @@
+#include <ESPTools/gpio_state.h>
+#include <ESPTools/gpio_waiter.h>
+#include <ESPTools/logger.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <driver/gpio.h>
+
+#include <cinttypes>
+
+extern "C"
+{
+  void app_main(void);
+}
+
+// Tag used for the logging system
+static constexpr char LOG_TAG[]{"GPIO Waiter"};
+
+void app_main()
+{
+  // Set the logging level of this tag to verbose
+  esp_log_level_set(LOG_TAG, ESP_LOG_VERBOSE);
+
+  // Three active low buttons with pull-ups
+  static ESPTools::GpioWaiter waiter;
+  const ESPTools::GpioWaiter::PinMask buttons{
+      waiter.AddPin(GPIO_NUM_2, true, GPIO_PULLUP_ONLY) |
+      waiter.AddPin(GPIO_NUM_3, true, GPIO_PULLUP_ONLY) |
+      waiter.AddPin(GPIO_NUM_4, true, GPIO_PULLUP_ONLY)};
+
+  while (true)
+  {
+    // The task sleeps until a button is pressed, there is no polling
+    const ESPTools::GpioWaiter::PinMask pressed{
+        waiter.WaitAny(buttons, ESPTools::GpioState::High)};
+    ESPTOOLS_LOGV("Pressed buttons -> 0x%03" PRIx32, pressed);
+
+    // Wait up to 10 seconds for every button to be released
+    if (waiter.WaitAll(buttons, ESPTools::GpioState::Low, pdMS_TO_TICKS(10000)) != buttons)
+    {
+      ESPTOOLS_LOGV("Some buttons are still pressed -> 0x%03" PRIx32,
+                    waiter.Get(ESPTools::GpioState::High));
+    }
+  }
+}
@@ -0,0 +1,148 @@
+#include <ESPTools/logger.h>
+#include <ESPTools/benchmark.h>
+#include <ESPTools/core.h>
+#include <ESPTools/event_bus.h>
+#include <ESPTools/fast_gpio.h>
+#include <ESPTools/gpio_event.h>
+#include <ESPTools/gpio_state.h>
+#include <ESPTools/gpio_state_set.h>
+#include <ESPTools/object_pool.h>
+#include <ESPTools/ring_buffer.h>
+#include <ESPTools/stats.h>
+
+#include <driver/gpio.h>
+
+#include <cstdint>
+
+extern "C"
+{
+  void app_main(void);
+}
+
+// Micro-benchmarks of the ESPTools primitives built for the host with the HAL shim of host/ (see
+// host/include/host_hal.h). Cycles are host nanoseconds, so the results only compare the fast
+// paths with each other and catch regressions, the target numbers come from benchmark.cpp.
+
+namespace
+{
+
+  using BenchmarkPin = ESPTools::FastGpio<GPIO_NUM_4>;
+
+  // Number of items used by the queue/ring buffer benchmarks
+  constexpr size_t QUEUE_ITEMS{64};
+
+  // Shared harness, reset before every benchmark
+  ESPTools::Benchmark<1024> benchmark;
+
+  // Keeps the results alive, so the measured code is not optimized away
+  volatile uint32_t sink{0};
+
+  template <typename Function>
+  void Run(const char *const name, Function &&function)
+  {
+    benchmark.Reset();
+    benchmark.Measure(function).Report(name);
+  }
+
+  void BenchmarkBitmasks()
+  {
+    volatile uint8_t position{17};
+    Run("CreateBitMaskAt<uint64_t>", [&]
+        { sink = static_cast<uint32_t>(ESPTools::CreateBitMaskAt<uint64_t>(position) >> 1); });
+    volatile int level{1};
+    Run("GpioState(int, inverse)", [&]
+        { sink = ESPTools::GpioState(level, true) == ESPTools::GpioState::Low; });
+    ESPTools::GpioStateSet set;
+    Run("GpioStateSet::Set+Get", [&]
+        {
+          set.Set(position, ESPTools::GpioState::High);
+          sink = set.Get(position) == ESPTools::GpioState::High;
+        });
+    Run("GpioStateSet::Changed", [&]
+        { sink = static_cast<uint32_t>(set.Changed(ESPTools::GpioStateSet())); });
+  }
+
+  void BenchmarkGpio()
+  {
+    // The registers are emulated, this only measures the ESPTools side of the accesses
+    BenchmarkPin::ConfigureOutput();
+    Run("FastGpio::Toggle", []
+        { BenchmarkPin::Toggle(); });
+    ESPTools::GpioStateSet outputs;
+    outputs.Set(BenchmarkPin::NUM, ESPTools::GpioState::High);
+    Run("GpioStateSet::WriteOutputs", [&]
+        { outputs.WriteOutputs(); });
+  }
+
+  void BenchmarkLogger()
+  {
+    // Tag used for the logging system. Disabled at runtime, so only the cost of a filtered
+    // message is measured, not the console output.
+    static constexpr char LOG_TAG[]{"Benchmark Logger"};
+    esp_log_level_set(LOG_TAG, ESP_LOG_NONE);
+    Run("ESPTOOLS_LOGI (filtered)", []
+        { ESPTOOLS_LOGI("Value %d", 1); });
+    Run("ESPTOOLS_LOGW_RL (filtered)", []
+        { ESPTOOLS_LOGW_RL("Value %d", 1); });
+  }
+
+  void BenchmarkQueues()
+  {
+    static ESPTools::SpscRingBuffer<ESPTools::GpioEvent, QUEUE_ITEMS> spsc;
+    static ESPTools::MpscRingBuffer<ESPTools::GpioEvent, QUEUE_ITEMS> mpsc;
+    ESPTools::GpioEvent event{0, BenchmarkPin::NUM, ESPTools::GpioState::High};
+    Run("SpscRingBuffer push+pop", [&]
+        {
+          spsc.Push(event);
+          spsc.Pop(event);
+        });
+    Run("MpscRingBuffer push+pop", [&]
+        {
+          mpsc.Push(event);
+          mpsc.Pop(event);
+        });
+
+    static ESPTools::IsrObjectPool<ESPTools::GpioEvent, QUEUE_ITEMS> pool;
+    Run("ObjectPool acquire+release", [&]
+        { pool.Release(pool.Acquire(event)); });
+
+    static ESPTools::EventBus<> bus;
+    static ESPTools::EventBus<>::Subscriber subscriber;
+    bus.Subscribe<ESPTools::EventTopic::GpioStateChange>(subscriber);
+    Run("EventBus publish+drain", [&]
+        {
+          bus.Publish<ESPTools::EventTopic::GpioStateChange>(event);
+          subscriber.Drain([](const ESPTools::EventBus<>::Event &received)
+                           { sink = received.payload.pin; });
+        });
+  }
+
+  void BenchmarkStats()
+  {
+    static ESPTools::RunningStats<> running;
+    static ESPTools::Ewma<4> ewma;
+    static ESPTools::Log2Histogram<> histogram;
+    volatile uint32_t value{1234};
+    Run("RunningStats::Add", [&]
+        { running.Add(value); });
+    Run("Ewma<4>::Add", [&]
+        { ewma.Add(static_cast<int32_t>(value)); });
+    Run("Log2Histogram::Add", [&]
+        { histogram.Add(value); });
+    sink = running.GetStdDev() + ewma.Get() + histogram.GetPercentile(99);
+  }
+
+} // namespace
+
+void app_main()
+{
+  // Tag used for the logging system
+  static constexpr char LOG_TAG[]{"Host Benchmark"};
+  ESPTOOLS_LOGI("ESPTools host benchmarks, results in host nanoseconds");
+  BenchmarkBitmasks();
+  BenchmarkGpio();
+  BenchmarkLogger();
+  BenchmarkQueues();
+  BenchmarkStats();
+  ESPTOOLS_LOGI("Done");
+}
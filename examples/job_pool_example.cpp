@@ -0,0 +1,81 @@
+#include <ESPTools/logger.h>
+#include <ESPTools/job_pool.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_timer.h>
+
+#include <cstdint>
+
+extern "C"
+{
+  void app_main(void);
+}
+
+// Tag used for the logging system
+static constexpr char LOG_TAG[]{"Job Pool"};
+
+// Number of samples filtered per batch
+static constexpr size_t SAMPLES{4096};
+
+static int16_t input[SAMPLES];
+static int16_t output[SAMPLES];
+
+void app_main()
+{
+  static ESPTools::JobPool pool;
+  pool.Start();
+
+  uint32_t seed{1};
+  for (int16_t &sample : input)
+  {
+    seed = seed * 1664525 + 1013904223;
+    sample = static_cast<int16_t>(seed >> 16);
+  }
+
+  while (true)
+  {
+    // Three-tap moving average, every chunk only reads the input so they are independent
+    const int64_t start{esp_timer_get_time()};
+    pool.ParallelFor(SAMPLES, 0,
+                     [](const size_t begin, const size_t end)
+                     {
+                       for (size_t i{begin}; i < end; ++i)
+                       {
+                         const int32_t previous{input[(i > 0) ? i - 1 : i]};
+                         const int32_t next{input[(i + 1 < SAMPLES) ? i + 1 : i]};
+                         output[i] = static_cast<int16_t>((previous + input[i] + next) / 3);
+                       }
+                     });
+    const int64_t parallel_us{esp_timer_get_time() - start};
+
+    // Checksum of the result, split by hand in four jobs of one group
+    static uint32_t sums[4];
+    ESPTools::JobGroup group;
+    for (size_t part{0}; part < 4; ++part)
+    {
+      pool.Submit(
+          group,
+          [](void *const arg, const size_t, const size_t)
+          {
+            uint32_t &sum{*static_cast<uint32_t *>(arg)};
+            const size_t first{static_cast<size_t>(&sum - sums) * (SAMPLES / 4)};
+            sum = 0;
+            for (size_t i{first}; i < first + SAMPLES / 4; ++i)
+            {
+              sum = (sum << 1 | sum >> 31) ^ static_cast<uint16_t>(output[i]);
+            }
+          },
+          &sums[part]);
+    }
+    pool.Wait(group);
+
+    ESPTOOLS_LOGI("Filtered %u samples in %u us on %u workers, checksums %08" PRIx32
+                  " %08" PRIx32 " %08" PRIx32 " %08" PRIx32,
+                  static_cast<unsigned>(SAMPLES), static_cast<unsigned>(parallel_us),
+                  static_cast<unsigned>(pool.GetWorkerCount()), sums[0], sums[1], sums[2],
+                  sums[3]);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+  }
+}
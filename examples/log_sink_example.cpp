@@ -0,0 +1,41 @@
+#include <ESPTools/logger.h>
+#include <ESPTools/log_sink.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_timer.h>
+
+#include <cinttypes>
+#include <cstdint>
+
+extern "C"
+{
+  void app_main(void);
+}
+
+void app_main()
+{
+  // Tag used for the logging system
+  static constexpr char LOG_TAG[]{"Log Sink"};
+
+  // From here on every log line is buffered and the caller returns without waiting for the UART
+  ESPTools::UartLogSink::Start(ESPTools::UartLogSink::DEFAULT_PORT, 0,
+                               ESPTools::LogSinkPolicy::DropOldest);
+
+  while (true)
+  {
+    // A burst larger than the buffer, the oldest lines are dropped instead of stalling the loop
+    const int64_t start_us{esp_timer_get_time()};
+    for (int i{0}; i < 500; ++i)
+    {
+      ESPTOOLS_LOGI("Burst line %d of 500", i);
+    }
+    const int64_t elapsed_us{esp_timer_get_time() - start_us};
+
+    ESPTools::UartLogSink::Flush(pdMS_TO_TICKS(1000));
+    ESPTOOLS_LOGW("Burst logged in %" PRId64 " us, %" PRIu32 " info lines dropped in total",
+                  elapsed_us, ESPTools::UartLogSink::GetDropCount(ESP_LOG_INFO));
+    vTaskDelay(pdMS_TO_TICKS(5000));
+  }
+}
@@ -0,0 +1,88 @@
+#include <ESPTools/logger.h>
+#include <ESPTools/gpio_event.h>
+#include <ESPTools/gpio_input.h>
+#include <ESPTools/perf_lock.h>
+#include <ESPTools/periodic_scheduler.h>
+#include <ESPTools/ring_buffer.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_attr.h>
+#include <esp_pm.h>
+
+extern "C"
+{
+  void app_main(void);
+}
+
+// Runs the button handling and the periodic jobs at full speed, the rest of the time the CPU
+// stays at the minimum frequency or in automatic light sleep
+static ESPTools::PerfLock cpu_max{ESP_PM_CPU_FREQ_MAX, "cpu_max"};
+// Task notified from the ISR every time the button changes its state
+static TaskHandle_t button_task{nullptr};
+// Edge events passed from the ISR to the task
+static ESPTools::SpscRingBuffer<ESPTools::GpioEvent, 16> button_events;
+
+static void IRAM_ATTR OnButtonChange(ESPTools::GpioInput &input, ESPTools::GpioState state,
+                                     int64_t timestamp_us, void *)
+{
+  // Boost from the edge itself, the task releases the lock once the event is handled
+  cpu_max.Acquire();
+  if (!button_events.Push({timestamp_us, static_cast<uint8_t>(input.GetPin()), state}))
+  {
+    cpu_max.Release();
+  }
+  BaseType_t higher_priority_task_woken{pdFALSE};
+  vTaskNotifyGiveFromISR(button_task, &higher_priority_task_woken);
+  portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+void app_main()
+{
+  // Tag used for the logging system
+  static constexpr char LOG_TAG[]{"Perf Lock"};
+
+  // Dynamic frequency scaling needs CONFIG_PM_ENABLE=y, and the automatic light sleep also
+  // CONFIG_FREERTOS_USE_TICKLESS_IDLE=y (menuconfig or sdkconfig.defaults). Without them the
+  // CPU stays at its default frequency and the locks are only measured.
+#ifdef CONFIG_PM_ENABLE
+  // The minimum frequency is the one of the XTAL (26 MHz on most ESP32-C2 boards)
+  const esp_pm_config_t pm_config{
+      .max_freq_mhz = 120,
+      .min_freq_mhz = CONFIG_XTAL_FREQ,
+#ifdef CONFIG_FREERTOS_USE_TICKLESS_IDLE
+      .light_sleep_enable = true,
+#else
+      .light_sleep_enable = false,
+#endif
+  };
+  ESP_ERROR_CHECK(esp_pm_configure(&pm_config));
+#else
+  ESPTOOLS_LOGW("CONFIG_PM_ENABLE is not set, the CPU frequency is not scaled");
+#endif
+
+  button_task = xTaskGetCurrentTaskHandle();
+  // Active low button on GPIO 9 (BOOT button of the ESP32-C2 DevKitM-1) debounced for 10 ms
+  static ESPTools::GpioInput button(GPIO_NUM_9, true, 10000, GPIO_PULLUP_ONLY, OnButtonChange);
+
+  // Periodic jobs dispatched at full speed, every 10 seconds the lock statistics are logged
+  static ESPTools::PeriodicScheduler<4> scheduler;
+  scheduler.SetPerfLock(&cpu_max);
+  scheduler.Add([](void *)
+                { cpu_max.Report(); },
+                nullptr, 10000000);
+  scheduler.Start();
+
+  while (true)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    button_events.Drain([](const ESPTools::GpioEvent &event)
+                        {
+                          ESPTOOLS_LOGI("GPIO %u -> %s at %" PRId64 " us",
+                                        static_cast<unsigned>(event.pin), event.state.ToStr(),
+                                        event.timestamp_us);
+                          cpu_max.Release();
+                        });
+  }
+}
@@ -0,0 +1,37 @@
+#include <ESPTools/logger.h>
+#include <ESPTools/pulse_capture.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <driver/gpio.h>
+
+#include <cinttypes>
+
+extern "C"
+{
+  void app_main(void);
+}
+
+// Tag used for the logging system
+static constexpr char LOG_TAG[]{"Pulse Capture"};
+
+void app_main()
+{
+  // Set the logging level of this tag to verbose
+  esp_log_level_set(LOG_TAG, ESP_LOG_VERBOSE);
+
+  // Tachometer signal on GPIO 4, measured in batches by RMT (or the GPIO ISR on the ESP32-C2)
+  static ESPTools::PulseCapture tachometer(GPIO_NUM_4);
+  tachometer.Start();
+
+  while (true)
+  {
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    const ESPTools::PulseMeasurement measurement{tachometer.GetMeasurement()};
+    ESPTOOLS_LOGV("%" PRIu32 " pulses, high %" PRIu32 " ns, low %" PRIu32 " ns, %" PRIu32
+                  ".%03" PRIu32 " Hz",
+                  measurement.pulses, measurement.high_ns, measurement.low_ns,
+                  measurement.frequency_millihz / 1000, measurement.frequency_millihz % 1000);
+  }
+}
@@ -0,0 +1,54 @@
+#include <ESPTools/logger.h>
+#include <ESPTools/task.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+extern "C"
+{
+  void app_main(void);
+}
+
+// Tag used for the logging system
+static constexpr char LOG_TAG[]{"Task"};
+
+/**
+ * @brief Task that periodically logs a counter, its stack is part of the object
+ */
+class CounterTask : public ESPTools::StaticTask<3072>
+{
+public:
+  CounterTask(const char *const name, const uint32_t period_ms)
+      : StaticTask(name, 2, ESPTools::CorePolicy::Spread), period_ms_(period_ms), count_(0)
+  {
+  }
+
+  ~CounterTask() override { Stop(); }
+
+protected:
+  void Run() override
+  {
+    while (true)
+    {
+      ESPTOOLS_LOGV("%s -> %" PRIu32 " (core %d)", pcTaskGetName(nullptr), count_++,
+                    xPortGetCoreID());
+      vTaskDelay(pdMS_TO_TICKS(period_ms_));
+    }
+  }
+
+private:
+  const uint32_t period_ms_;
+  uint32_t count_;
+};
+
+void app_main()
+{
+  // Set the logging level of this tag to verbose
+  esp_log_level_set(LOG_TAG, ESP_LOG_VERBOSE);
+
+  // Statically allocated tasks, spread across the available cores
+  static CounterTask fast_task("fast", 1000);
+  static CounterTask slow_task("slow", 5000);
+  fast_task.Start();
+  slow_task.Start();
+}
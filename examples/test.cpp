@@ -1,23 +1,40 @@
 #include <ESPTools/logger.h>
+#include <ESPTools/periodic_scheduler.h>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
+#include <cinttypes>
+#include <cstdint>
+
 extern "C"
 {
   void app_main(void);
 }
 
+// Tag used for the logging system
+static constexpr char LOG_TAG[]{"Test"};
+
 void app_main()
 {
-  // Tag used for the logging system
-  static constexpr char LOG_TAG[]{"Test"};
   // Set the logging level of this tag to verbose
   esp_log_level_set(LOG_TAG, ESP_LOG_VERBOSE);
 
-  while (true)
-  {
-    ESPTOOLS_LOGV("Test message");
-    vTaskDelay(pdMS_TO_TICKS(5000));
-  }
+#ifdef ESPTOOLS_LOG_CAPTURE
+  // Output the lines captured before the last reset, then keep capturing
+  ESPTools::LogCapture::Init();
+  ESPTools::LogCapture::DumpPreviousBoot();
+#endif
+
+  // Both jobs share the stack of the esp_timer task, no dedicated task is needed
+  static ESPTools::PeriodicScheduler<4> scheduler;
+  static uint32_t ticks{0};
+
+  scheduler.Add([](void *)
+                { ESPTOOLS_LOGV("Test message"); },
+                nullptr, 5000 * 1000);
+  scheduler.Add([](void *arg)
+                { ESPTOOLS_LOGV("Tick %" PRIu32, ++*static_cast<uint32_t *>(arg)); },
+                &ticks, 1000 * 1000, 0);
+  scheduler.Start();
 }
@@ -0,0 +1,50 @@
+#include <ESPTools/gpio_state.h>
+#include <ESPTools/logger.h>
+#include <ESPTools/wakeup_manager.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <driver/gpio.h>
+
+extern "C"
+{
+  void app_main(void);
+}
+
+// Tag used for the logging system
+static constexpr char LOG_TAG[]{"Wakeup"};
+
+void app_main()
+{
+  // Set the logging level of this tag to verbose
+  esp_log_level_set(LOG_TAG, ESP_LOG_VERBOSE);
+
+  // Active low button with pull-up and an active high sensor output
+  const gpio_config_t config{
+      .pin_bit_mask = 0b1100,
+      .mode = GPIO_MODE_INPUT,
+      .pull_up_en = GPIO_PULLUP_ENABLE,
+      .pull_down_en = GPIO_PULLDOWN_DISABLE,
+      .intr_type = GPIO_INTR_DISABLE,
+  };
+  ESP_ERROR_CHECK(gpio_config(&config));
+
+  static ESPTools::WakeupManager wakeup_manager;
+  wakeup_manager.AddPin(GPIO_NUM_2, ESPTools::GpioState::High, true);
+  wakeup_manager.AddPin(GPIO_NUM_3, ESPTools::GpioState::High);
+
+  while (true)
+  {
+    // Sleep until a pin fires, or one minute at most
+    const ESPTools::Wakeup wakeup{wakeup_manager.LightSleep(60 * 1000 * 1000)};
+    if (wakeup.pin != GPIO_NUM_NC)
+    {
+      ESPTOOLS_LOGV("Woken up by GPIO %d -> %s", wakeup.pin, wakeup.state.ToStr());
+    }
+    else
+    {
+      ESPTOOLS_LOGV("Woken up by source %d", wakeup.cause);
+    }
+  }
+}
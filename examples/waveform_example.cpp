@@ -0,0 +1,75 @@
+#include <ESPTools/gpio_state.h>
+#include <ESPTools/gpio_state_set.h>
+#include <ESPTools/gpio_waveform.h>
+#include <ESPTools/logger.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <driver/gpio.h>
+
+extern "C"
+{
+  void app_main(void);
+}
+
+// Tag used for the logging system
+static constexpr char LOG_TAG[]{"Waveform"};
+
+namespace
+{
+  constexpr gpio_num_t STEP_PIN{GPIO_NUM_4};
+  constexpr gpio_num_t PHASE_A_PIN{GPIO_NUM_5};
+  constexpr gpio_num_t PHASE_B_PIN{GPIO_NUM_6};
+} // namespace
+
+void app_main()
+{
+  // Set the logging level of this tag to verbose
+  esp_log_level_set(LOG_TAG, ESP_LOG_VERBOSE);
+
+  // Stepper driver pulses: 2 us high, then a low time that ramps the speed up
+  static ESPTools::GpioWaveform step(STEP_PIN);
+  ESPTools::WaveformStep ramp[2 * 50];
+  for (size_t i{0}; i < 50; ++i)
+  {
+    ramp[2 * i] = {2000, ESPTools::GpioState::High};
+    ramp[2 * i + 1] = {static_cast<uint32_t>(1000000 / (i + 1)), ESPTools::GpioState::Low};
+  }
+
+  // Two phase quadrature pattern, both pins change in the same register write
+  const gpio_config_t config{
+      .pin_bit_mask = ESPTools::CreateBitMaskAt<uint64_t>(PHASE_A_PIN) |
+                      ESPTools::CreateBitMaskAt<uint64_t>(PHASE_B_PIN),
+      .mode = GPIO_MODE_OUTPUT,
+      .pull_up_en = GPIO_PULLUP_DISABLE,
+      .pull_down_en = GPIO_PULLDOWN_DISABLE,
+      .intr_type = GPIO_INTR_DISABLE,
+  };
+  ESP_ERROR_CHECK(gpio_config(&config));
+  ESPTools::GpioStateSet idle;
+  idle.Set(PHASE_A_PIN, ESPTools::GpioState::Low);
+  idle.Set(PHASE_B_PIN, ESPTools::GpioState::Low);
+  static ESPTools::GpioPatternPlayer quadrature(idle);
+  ESPTools::WaveformFrame phases[4]{};
+  for (size_t i{0}; i < 4; ++i)
+  {
+    phases[i].levels.Set(PHASE_A_PIN, ESPTools::GpioState(i == 1 || i == 2));
+    phases[i].levels.Set(PHASE_B_PIN, ESPTools::GpioState(i >= 2));
+    phases[i].duration_ns = 250000;
+  }
+
+  while (true)
+  {
+    // Both outputs play on their own, the task only queues the next buffers
+    step.Write(ramp, sizeof(ramp) / sizeof(ramp[0]));
+    for (size_t cycle{0}; cycle < 100; ++cycle)
+    {
+      quadrature.Write(phases, sizeof(phases) / sizeof(phases[0]));
+    }
+    step.WaitDone();
+    quadrature.WaitDone();
+    ESPTOOLS_LOGV("Patterns played");
+    vTaskDelay(pdMS_TO_TICKS(1000));
+  }
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+// Host shim of driver/gpio.h, see host_hal.h. The pins are emulated by the shim: outputs read back
+// their own level, and the level of the inputs is set with `host_gpio_set_input_level()`, which
+// also runs the ISR handlers of the pin.
+
+#include <esp_err.h>
+#include <esp_intr_alloc.h>
+#include <soc/soc_caps.h>
+
+#include <cstdint>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef enum
+  {
+    GPIO_NUM_NC = -1,
+    GPIO_NUM_0,
+    GPIO_NUM_1,
+    GPIO_NUM_2,
+    GPIO_NUM_3,
+    GPIO_NUM_4,
+    GPIO_NUM_5,
+    GPIO_NUM_6,
+    GPIO_NUM_7,
+    GPIO_NUM_8,
+    GPIO_NUM_9,
+    GPIO_NUM_10,
+    GPIO_NUM_11,
+    GPIO_NUM_12,
+    GPIO_NUM_13,
+    GPIO_NUM_14,
+    GPIO_NUM_15,
+    GPIO_NUM_16,
+    GPIO_NUM_17,
+    GPIO_NUM_18,
+    GPIO_NUM_19,
+    GPIO_NUM_20,
+    GPIO_NUM_MAX,
+  } gpio_num_t;
+
+#define GPIO_MODE_DEF_DISABLE (0)
+#define GPIO_MODE_DEF_INPUT (1 << 0)
+#define GPIO_MODE_DEF_OUTPUT (1 << 1)
+#define GPIO_MODE_DEF_OD (1 << 2)
+
+  typedef enum
+  {
+    GPIO_MODE_DISABLE = GPIO_MODE_DEF_DISABLE,
+    GPIO_MODE_INPUT = GPIO_MODE_DEF_INPUT,
+    GPIO_MODE_OUTPUT = GPIO_MODE_DEF_OUTPUT,
+    GPIO_MODE_OUTPUT_OD = GPIO_MODE_DEF_OUTPUT | GPIO_MODE_DEF_OD,
+    GPIO_MODE_INPUT_OUTPUT_OD = GPIO_MODE_DEF_INPUT | GPIO_MODE_DEF_OUTPUT | GPIO_MODE_DEF_OD,
+    GPIO_MODE_INPUT_OUTPUT = GPIO_MODE_DEF_INPUT | GPIO_MODE_DEF_OUTPUT,
+  } gpio_mode_t;
+
+  typedef enum
+  {
+    GPIO_PULLUP_ONLY,
+    GPIO_PULLDOWN_ONLY,
+    GPIO_PULLUP_PULLDOWN,
+    GPIO_FLOATING,
+  } gpio_pull_mode_t;
+
+  typedef enum
+  {
+    GPIO_PULLUP_DISABLE,
+    GPIO_PULLUP_ENABLE,
+  } gpio_pullup_t;
+
+  typedef enum
+  {
+    GPIO_PULLDOWN_DISABLE,
+    GPIO_PULLDOWN_ENABLE,
+  } gpio_pulldown_t;
+
+  typedef enum
+  {
+    GPIO_INTR_DISABLE,
+    GPIO_INTR_POSEDGE,
+    GPIO_INTR_NEGEDGE,
+    GPIO_INTR_ANYEDGE,
+    GPIO_INTR_LOW_LEVEL,
+    GPIO_INTR_HIGH_LEVEL,
+    GPIO_INTR_MAX,
+  } gpio_int_type_t;
+
+  typedef struct
+  {
+    uint64_t pin_bit_mask;
+    gpio_mode_t mode;
+    gpio_pullup_t pull_up_en;
+    gpio_pulldown_t pull_down_en;
+    gpio_int_type_t intr_type;
+  } gpio_config_t;
+
+  typedef void (*gpio_isr_t)(void *arg);
+
+#define GPIO_IS_VALID_GPIO(gpio_num)                                                         \
+  ((gpio_num) >= 0 && (((1ULL << (gpio_num)) & SOC_GPIO_VALID_GPIO_MASK) != 0))
+#define GPIO_IS_VALID_OUTPUT_GPIO(gpio_num)                                                  \
+  ((gpio_num) >= 0 && (((1ULL << (gpio_num)) & SOC_GPIO_VALID_OUTPUT_GPIO_MASK) != 0))
+
+  esp_err_t gpio_config(const gpio_config_t *config);
+  esp_err_t gpio_reset_pin(gpio_num_t gpio_num);
+  esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode);
+  esp_err_t gpio_set_pull_mode(gpio_num_t gpio_num, gpio_pull_mode_t pull);
+  esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level);
+  int gpio_get_level(gpio_num_t gpio_num);
+  esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type);
+  esp_err_t gpio_intr_enable(gpio_num_t gpio_num);
+  esp_err_t gpio_intr_disable(gpio_num_t gpio_num);
+  esp_err_t gpio_install_isr_service(int intr_alloc_flags);
+  void gpio_uninstall_isr_service(void);
+  esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args);
+  esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,13 @@
+#pragma once
+
+// Host shim of esp_attr.h, see host_hal.h. There is a single flat memory, so the placement
+// attributes are empty.
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define RTC_IRAM_ATTR
+#define __NOINIT_ATTR
+#define NOINIT_ATTR
+#define FORCE_INLINE_ATTR static inline __attribute__((always_inline))
@@ -0,0 +1,24 @@
+#pragma once
+
+// Host shim of esp_cpu.h, see host_hal.h
+
+#include <cstdint>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef uint32_t esp_cpu_cycle_count_t;
+
+  /**
+   * @brief Returns a 32 bit counter running at `esp_rom_get_cpu_ticks_per_us()`, derived from the
+   * monotonic clock of the host (1 "cycle" per nanosecond)
+   */
+  esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void);
+
+  inline int esp_cpu_get_core_id(void) { return 0; }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,27 @@
+#pragma once
+
+// Host shim of esp_heap_caps.h, see host_hal.h. The capabilities are ignored.
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define MALLOC_CAP_EXEC (1 << 0)
+#define MALLOC_CAP_32BIT (1 << 1)
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+  void *heap_caps_malloc(size_t size, uint32_t caps);
+  void *heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps);
+  void heap_caps_free(void *ptr);
+
+#ifdef __cplusplus
+}
+#endif
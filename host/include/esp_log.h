@@ -0,0 +1,62 @@
+#pragma once
+
+// Host shim of esp_log.h, see host_hal.h. Messages are written to stdout with the ESP-IDF format,
+// and the runtime level of every tag can be set as on the target.
+
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdint>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef enum
+  {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE,
+  } esp_log_level_t;
+
+  typedef int (*vprintf_like_t)(const char *format, va_list args);
+
+#ifndef LOG_LOCAL_LEVEL
+#define LOG_LOCAL_LEVEL ESP_LOG_INFO
+#endif
+
+  void esp_log_level_set(const char *tag, esp_log_level_t level);
+  esp_log_level_t esp_log_level_get(const char *tag);
+  vprintf_like_t esp_log_set_vprintf(vprintf_like_t func);
+  uint32_t esp_log_timestamp(void);
+  void esp_log_writev(esp_log_level_t level, const char *tag, const char *format, va_list args);
+  void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+      __attribute__((format(printf, 3, 4)));
+
+#define ESP_LOG_LEVEL(level, tag, format, ...)                                              \
+  do                                                                                        \
+  {                                                                                         \
+    if ((level) <= LOG_LOCAL_LEVEL)                                                         \
+    {                                                                                       \
+      esp_log_write(level, tag, "%c (%" PRIu32 ") %s: " format "\n", "NEWIDV"[level],       \
+                    esp_log_timestamp(), tag __VA_OPT__(, ) __VA_ARGS__);                   \
+    }                                                                                       \
+  } while (0)
+
+#define ESP_LOGE(tag, format, ...) \
+  ESP_LOG_LEVEL(ESP_LOG_ERROR, tag, format __VA_OPT__(, ) __VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) \
+  ESP_LOG_LEVEL(ESP_LOG_WARN, tag, format __VA_OPT__(, ) __VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) \
+  ESP_LOG_LEVEL(ESP_LOG_INFO, tag, format __VA_OPT__(, ) __VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) \
+  ESP_LOG_LEVEL(ESP_LOG_DEBUG, tag, format __VA_OPT__(, ) __VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) \
+  ESP_LOG_LEVEL(ESP_LOG_VERBOSE, tag, format __VA_OPT__(, ) __VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,21 @@
+#pragma once
+
+// Host shim of esp_rom_sys.h, see host_hal.h
+
+#include <cstdint>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /**
+   * @brief Returns the rate of `esp_cpu_get_cycle_count()`, 1000 ticks per microsecond
+   */
+  uint32_t esp_rom_get_cpu_ticks_per_us(void);
+
+  void esp_rom_delay_us(uint32_t us);
+
+#ifdef __cplusplus
+}
+#endif
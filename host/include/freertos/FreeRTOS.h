@@ -0,0 +1,65 @@
+#pragma once
+
+// Host shim of the ESP-IDF FreeRTOS port, see host_hal.h
+
+#include <atomic>
+#include <cstdint>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef int BaseType_t;
+  typedef unsigned int UBaseType_t;
+  typedef uint32_t TickType_t;
+  typedef uint8_t StackType_t;
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+
+#define CONFIG_FREERTOS_UNICORE 1
+#define portNUM_PROCESSORS 1
+#define configTICK_RATE_HZ 1000
+#define configMAX_PRIORITIES 25
+#define configMINIMAL_STACK_SIZE 768
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFUL)
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((TickType_t)(ms) * configTICK_RATE_HZ) / 1000U))
+
+  /**
+   * @brief Recursive spinlock of the critical sections. A host thread plays the role of a core.
+   */
+  typedef struct
+  {
+    std::atomic<const void *> owner;
+    uint32_t count;
+  } portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {nullptr, 0}
+
+  void vPortEnterCritical(portMUX_TYPE *mux);
+  void vPortExitCritical(portMUX_TYPE *mux);
+
+  /**
+   * @brief Returns pdTRUE while the shim runs a GPIO ISR handler, see `host_gpio_set_input_level()`
+   */
+  BaseType_t xPortInIsrContext(void);
+
+  inline BaseType_t xPortGetCoreID(void) { return 0; }
+
+#define portENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux) vPortExitCritical(mux)
+#define portENTER_CRITICAL_SAFE(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_SAFE(mux) vPortExitCritical(mux)
+#define portYIELD_FROM_ISR(...) ((void)0)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,27 @@
+#pragma once
+
+// Host shim of the FreeRTOS task API, see host_hal.h. Every host thread is a task, and only the
+// direct-to-task notifications and delays are provided.
+
+#include <freertos/FreeRTOS.h>
+
+#include <cstdint>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef struct tskTaskControlBlock *TaskHandle_t;
+
+  TaskHandle_t xTaskGetCurrentTaskHandle(void);
+  TickType_t xTaskGetTickCount(void);
+  void vTaskDelay(const TickType_t ticks_to_delay);
+
+  uint32_t ulTaskNotifyTake(const BaseType_t clear_count_on_exit, const TickType_t ticks_to_wait);
+  BaseType_t xTaskNotifyGive(TaskHandle_t task);
+  void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *const higher_priority_task_woken);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+
+// HAL shim of the host build (`pio run -e native_Benchmark`). The headers of this directory
+// replace the few ESP-IDF and FreeRTOS headers used by the header-only ESPTools primitives, so
+// they can be compiled, debugged and benchmarked on a workstation:
+//  - GPIO: a register file with the ESP32-C2 layout backs the `gpio_*` functions and REG_*
+//    accesses. Outputs read back their level, inputs follow `host_gpio_set_input_level()`.
+//  - Logging: `esp_log_*` write to stdout with per-tag runtime levels.
+//  - FreeRTOS: every host thread is a task, with critical sections, notifications and delays.
+//  - Time: `esp_timer_get_time()` and the cycle counter follow the monotonic clock, and the
+//    esp_timer callbacks run on a dedicated thread.
+// `app_main()` is called from `main()`, as for the ESP-IDF linux target, except in the unit tests
+// of test/ (`pio test -e native_Test`), which provide their own `main()`.
+
+#include <driver/gpio.h>
+
+#include <cstdint>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /**
+   * @brief Reads an emulated peripheral register
+   */
+  uint32_t host_reg_read(const uintptr_t address);
+
+  /**
+   * @brief Writes an emulated peripheral register, with the set/clear semantics of the GPIO
+   * W1TS/W1TC registers
+   */
+  void host_reg_write(const uintptr_t address, const uint32_t value);
+
+  /**
+   * @brief Drives the external level of a pin, as seen while it is not an output, and runs the
+   * ISR handler of the pin in interrupt context if the change matches its interrupt type
+   */
+  void host_gpio_set_input_level(const gpio_num_t gpio_num, const uint32_t level);
+
+#ifdef __cplusplus
+}
+#endif
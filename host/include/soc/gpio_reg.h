@@ -0,0 +1,14 @@
+#pragma once
+
+// Host shim of soc/gpio_reg.h, see host_hal.h. Same layout as the ESP32-C2.
+
+#include <soc/soc.h>
+
+#define DR_REG_GPIO_BASE 0x60004000
+#define GPIO_OUT_REG (DR_REG_GPIO_BASE + 0x0004)
+#define GPIO_OUT_W1TS_REG (DR_REG_GPIO_BASE + 0x0008)
+#define GPIO_OUT_W1TC_REG (DR_REG_GPIO_BASE + 0x000C)
+#define GPIO_ENABLE_REG (DR_REG_GPIO_BASE + 0x0020)
+#define GPIO_ENABLE_W1TS_REG (DR_REG_GPIO_BASE + 0x0024)
+#define GPIO_ENABLE_W1TC_REG (DR_REG_GPIO_BASE + 0x0028)
+#define GPIO_IN_REG (DR_REG_GPIO_BASE + 0x003C)
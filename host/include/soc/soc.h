@@ -0,0 +1,11 @@
+#pragma once
+
+// Host shim of soc/soc.h, see host_hal.h. The peripheral registers are emulated by the shim.
+
+#include "host_hal.h"
+
+#define REG_READ(reg) host_reg_read((uintptr_t)(reg))
+#define REG_WRITE(reg, value) host_reg_write((uintptr_t)(reg), (uint32_t)(value))
+#define REG_SET_BIT(reg, bit) REG_WRITE(reg, REG_READ(reg) | (bit))
+#define REG_CLR_BIT(reg, bit) REG_WRITE(reg, REG_READ(reg) & ~(uint32_t)(bit))
+#define REG_GET_BIT(reg, bit) (REG_READ(reg) & (bit))
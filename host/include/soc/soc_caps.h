@@ -0,0 +1,8 @@
+#pragma once
+
+// Host shim of soc/soc_caps.h, see host_hal.h. The emulated chip has the GPIOs of an ESP32-C2.
+
+#define SOC_GPIO_PIN_COUNT 21
+#define SOC_GPIO_VALID_GPIO_MASK ((1ULL << SOC_GPIO_PIN_COUNT) - 1)
+#define SOC_GPIO_VALID_OUTPUT_GPIO_MASK SOC_GPIO_VALID_GPIO_MASK
+#define SOC_CPU_CORES_NUM 1
@@ -0,0 +1,747 @@
+#include "host_hal.h"
+
+#include <driver/gpio.h>
+#include <esp_cpu.h>
+#include <esp_err.h>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <esp_rom_sys.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <soc/gpio_reg.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+extern "C" void app_main(void);
+
+/**
+ * @brief Notification state of a host thread, which plays the role of a FreeRTOS task
+ */
+struct tskTaskControlBlock
+{
+  std::mutex mutex;
+  std::condition_variable notified;
+  uint32_t notifications{0};
+};
+
+/**
+ * @brief Emulated esp_timer, fired by the timer thread
+ */
+struct esp_timer
+{
+  esp_timer_cb_t callback;
+  void *arg;
+  bool isr;
+  bool active{false};
+  int64_t deadline_us{0};
+  uint64_t period_us{0};
+};
+
+namespace
+{
+  using Clock = std::chrono::steady_clock;
+
+  // Time origin of esp_timer and of the cycle counter
+  const Clock::time_point start{Clock::now()};
+
+  // Number of 32 bit registers of the emulated GPIO block
+  constexpr size_t GPIO_REGISTER_COUNT{0x100 / sizeof(uint32_t)};
+
+  /**
+   * @brief Configuration of an emulated pin
+   */
+  struct Pin
+  {
+    gpio_int_type_t intr_type{GPIO_INTR_DISABLE};
+    bool intr_enabled{false};
+    gpio_isr_t handler{nullptr};
+    void *arg{nullptr};
+  };
+
+  std::atomic<uint32_t> gpio_registers[GPIO_REGISTER_COUNT]{};
+  // Level applied to the pins from outside, read while a pin is not an output
+  std::atomic<uint32_t> external_levels{0};
+  // Registers outside of the GPIO block, plain memory
+  std::unordered_map<uintptr_t, uint32_t> other_registers;
+  std::mutex other_registers_mutex;
+
+  Pin pins[SOC_GPIO_PIN_COUNT];
+  std::mutex pins_mutex;
+  bool isr_service_installed{false};
+
+  std::map<std::string, esp_log_level_t> log_levels;
+  esp_log_level_t default_log_level{ESP_LOG_INFO};
+  std::mutex log_mutex;
+  vprintf_like_t log_vprintf{vprintf};
+
+  /**
+   * @brief State shared with the timer thread. Never destroyed, as the thread may still wait on
+   * the condition variable when the static objects are destroyed at exit.
+   */
+  struct Timers
+  {
+    std::vector<esp_timer *> list;
+    std::mutex mutex;
+    std::condition_variable changed;
+    // Timer whose callback is running, deleting it waits until the callback returns
+    const esp_timer *running{nullptr};
+    bool thread_started{false};
+  };
+
+  Timers &timers{*new Timers};
+
+  thread_local tskTaskControlBlock current_task;
+  thread_local bool in_isr{false};
+  // Unique per thread, identifies the owner of a critical section
+  thread_local const char critical_owner{0};
+
+  std::atomic<uint32_t> &GpioRegister(const uintptr_t address)
+  {
+    return gpio_registers[(address - DR_REG_GPIO_BASE) / sizeof(uint32_t)];
+  }
+
+  bool IsGpioRegister(const uintptr_t address)
+  {
+    return address >= DR_REG_GPIO_BASE &&
+           address < DR_REG_GPIO_BASE + GPIO_REGISTER_COUNT * sizeof(uint32_t);
+  }
+
+  uint32_t ReadInputs()
+  {
+    const uint32_t enable{GpioRegister(GPIO_ENABLE_REG).load(std::memory_order_relaxed)};
+    return (GpioRegister(GPIO_OUT_REG).load(std::memory_order_relaxed) & enable) |
+           (external_levels.load(std::memory_order_relaxed) & ~enable);
+  }
+
+  void SetBits(const uintptr_t address, const uint32_t bits, const bool set)
+  {
+    if (set)
+    {
+      GpioRegister(address).fetch_or(bits, std::memory_order_relaxed);
+    }
+    else
+    {
+      GpioRegister(address).fetch_and(~bits, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief Returns true if the transition triggers an interrupt of the given type
+   */
+  bool Triggers(const gpio_int_type_t type, const bool before, const bool after)
+  {
+    switch (type)
+    {
+    case GPIO_INTR_POSEDGE:
+      return !before && after;
+    case GPIO_INTR_NEGEDGE:
+      return before && !after;
+    case GPIO_INTR_ANYEDGE:
+      return before != after;
+    case GPIO_INTR_LOW_LEVEL:
+      return !after;
+    case GPIO_INTR_HIGH_LEVEL:
+      return after;
+    default:
+      return false;
+    }
+  }
+
+  /**
+   * @brief Runs the handler of a pin if the level change triggers its interrupt
+   */
+  void DispatchInterrupt(const gpio_num_t gpio_num, const bool before, const bool after)
+  {
+    std::unique_lock<std::mutex> lock(pins_mutex);
+    const Pin pin{pins[gpio_num]};
+    lock.unlock();
+    if (isr_service_installed && pin.handler && pin.intr_enabled &&
+        Triggers(pin.intr_type, before, after))
+    {
+      in_isr = true;
+      pin.handler(pin.arg);
+      in_isr = false;
+    }
+  }
+
+  int64_t ElapsedNs() { return std::chrono::nanoseconds(Clock::now() - start).count(); }
+
+  /**
+   * @brief Fires the timers at their deadlines, one callback at a time like the esp_timer task
+   */
+  void TimerThread()
+  {
+    std::unique_lock<std::mutex> lock(timers.mutex);
+    while (true)
+    {
+      esp_timer *next{nullptr};
+      for (esp_timer *const timer : timers.list)
+      {
+        if (timer->active && (!next || timer->deadline_us < next->deadline_us))
+        {
+          next = timer;
+        }
+      }
+      if (!next)
+      {
+        timers.changed.wait(lock);
+        continue;
+      }
+      if (next->deadline_us > ElapsedNs() / 1000)
+      {
+        timers.changed.wait_until(lock, start + std::chrono::microseconds(next->deadline_us));
+        continue;
+      }
+      if (next->period_us > 0)
+      {
+        // Missed periods are skipped, as with skip_unhandled_events
+        const int64_t now_us{ElapsedNs() / 1000};
+        const int64_t period_us{static_cast<int64_t>(next->period_us)};
+        next->deadline_us += ((now_us - next->deadline_us) / period_us + 1) * period_us;
+      }
+      else
+      {
+        next->active = false;
+      }
+      timers.running = next;
+      lock.unlock();
+      in_isr = next->isr;
+      next->callback(next->arg);
+      in_isr = false;
+      lock.lock();
+      timers.running = nullptr;
+      timers.changed.notify_all();
+    }
+  }
+
+  esp_err_t StartTimer(esp_timer_handle_t timer, const uint64_t timeout_us,
+                       const uint64_t period_us)
+  {
+    const std::lock_guard<std::mutex> lock(timers.mutex);
+    if (timer->active)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = true;
+    timer->deadline_us = ElapsedNs() / 1000 + static_cast<int64_t>(timeout_us);
+    timer->period_us = period_us;
+    timers.changed.notify_all();
+    return ESP_OK;
+  }
+} // namespace
+
+extern "C"
+{
+
+  // Registers
+
+  uint32_t host_reg_read(const uintptr_t address)
+  {
+    if (address == GPIO_IN_REG)
+    {
+      return ReadInputs();
+    }
+    if (IsGpioRegister(address))
+    {
+      return GpioRegister(address).load(std::memory_order_relaxed);
+    }
+    const std::lock_guard<std::mutex> lock(other_registers_mutex);
+    return other_registers[address];
+  }
+
+  void host_reg_write(const uintptr_t address, const uint32_t value)
+  {
+    switch (address)
+    {
+    case GPIO_OUT_W1TS_REG:
+      SetBits(GPIO_OUT_REG, value, true);
+      return;
+    case GPIO_OUT_W1TC_REG:
+      SetBits(GPIO_OUT_REG, value, false);
+      return;
+    case GPIO_ENABLE_W1TS_REG:
+      SetBits(GPIO_ENABLE_REG, value, true);
+      return;
+    case GPIO_ENABLE_W1TC_REG:
+      SetBits(GPIO_ENABLE_REG, value, false);
+      return;
+    case GPIO_IN_REG:
+      return;
+    default:
+      break;
+    }
+    if (IsGpioRegister(address))
+    {
+      GpioRegister(address).store(value, std::memory_order_relaxed);
+      return;
+    }
+    const std::lock_guard<std::mutex> lock(other_registers_mutex);
+    other_registers[address] = value;
+  }
+
+  // GPIO
+
+  void host_gpio_set_input_level(const gpio_num_t gpio_num, const uint32_t level)
+  {
+    if (!GPIO_IS_VALID_GPIO(gpio_num))
+    {
+      return;
+    }
+    const uint32_t mask{uint32_t{1} << gpio_num};
+    const bool before{(ReadInputs() & mask) != 0};
+    if (level)
+    {
+      external_levels.fetch_or(mask, std::memory_order_relaxed);
+    }
+    else
+    {
+      external_levels.fetch_and(~mask, std::memory_order_relaxed);
+    }
+    DispatchInterrupt(gpio_num, before, (ReadInputs() & mask) != 0);
+  }
+
+  esp_err_t gpio_config(const gpio_config_t *config)
+  {
+    if (!config || (config->pin_bit_mask & ~SOC_GPIO_VALID_GPIO_MASK) != 0)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+    for (int pin{0}; pin < SOC_GPIO_PIN_COUNT; ++pin)
+    {
+      if ((config->pin_bit_mask & (1ULL << pin)) == 0)
+      {
+        continue;
+      }
+      const gpio_num_t gpio_num{static_cast<gpio_num_t>(pin)};
+      gpio_set_direction(gpio_num, config->mode);
+      const bool pull_up{config->pull_up_en == GPIO_PULLUP_ENABLE};
+      if (pull_up != (config->pull_down_en == GPIO_PULLDOWN_ENABLE))
+      {
+        gpio_set_pull_mode(gpio_num, pull_up ? GPIO_PULLUP_ONLY : GPIO_PULLDOWN_ONLY);
+      }
+      gpio_set_intr_type(gpio_num, config->intr_type);
+      if (config->intr_type != GPIO_INTR_DISABLE)
+      {
+        gpio_intr_enable(gpio_num);
+      }
+      else
+      {
+        gpio_intr_disable(gpio_num);
+      }
+    }
+    return ESP_OK;
+  }
+
+  esp_err_t gpio_reset_pin(gpio_num_t gpio_num)
+  {
+    if (!GPIO_IS_VALID_GPIO(gpio_num))
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+    gpio_set_direction(gpio_num, GPIO_MODE_DISABLE);
+    gpio_set_pull_mode(gpio_num, GPIO_PULLUP_ONLY);
+    gpio_intr_disable(gpio_num);
+    return gpio_set_intr_type(gpio_num, GPIO_INTR_DISABLE);
+  }
+
+  esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode)
+  {
+    if (!GPIO_IS_VALID_GPIO(gpio_num))
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+    SetBits(GPIO_ENABLE_REG, uint32_t{1} << gpio_num, (mode & GPIO_MODE_DEF_OUTPUT) != 0);
+    return ESP_OK;
+  }
+
+  esp_err_t gpio_set_pull_mode(gpio_num_t gpio_num, gpio_pull_mode_t pull)
+  {
+    if (!GPIO_IS_VALID_GPIO(gpio_num))
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+    // A pull resistor sets the level of an undriven input
+    if (pull == GPIO_PULLUP_ONLY || pull == GPIO_PULLDOWN_ONLY)
+    {
+      host_gpio_set_input_level(gpio_num, pull == GPIO_PULLUP_ONLY);
+    }
+    return ESP_OK;
+  }
+
+  esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+  {
+    if (!GPIO_IS_VALID_OUTPUT_GPIO(gpio_num))
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+    host_reg_write(level ? GPIO_OUT_W1TS_REG : GPIO_OUT_W1TC_REG, uint32_t{1} << gpio_num);
+    return ESP_OK;
+  }
+
+  int gpio_get_level(gpio_num_t gpio_num)
+  {
+    return GPIO_IS_VALID_GPIO(gpio_num) ? (ReadInputs() >> gpio_num) & 1 : 0;
+  }
+
+  esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type)
+  {
+    if (!GPIO_IS_VALID_GPIO(gpio_num) || intr_type >= GPIO_INTR_MAX)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+    const std::lock_guard<std::mutex> lock(pins_mutex);
+    pins[gpio_num].intr_type = intr_type;
+    return ESP_OK;
+  }
+
+  esp_err_t gpio_intr_enable(gpio_num_t gpio_num)
+  {
+    if (!GPIO_IS_VALID_GPIO(gpio_num))
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+    const std::lock_guard<std::mutex> lock(pins_mutex);
+    pins[gpio_num].intr_enabled = true;
+    return ESP_OK;
+  }
+
+  esp_err_t gpio_intr_disable(gpio_num_t gpio_num)
+  {
+    if (!GPIO_IS_VALID_GPIO(gpio_num))
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+    const std::lock_guard<std::mutex> lock(pins_mutex);
+    pins[gpio_num].intr_enabled = false;
+    return ESP_OK;
+  }
+
+  esp_err_t gpio_install_isr_service(int)
+  {
+    const std::lock_guard<std::mutex> lock(pins_mutex);
+    if (isr_service_installed)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+    isr_service_installed = true;
+    return ESP_OK;
+  }
+
+  void gpio_uninstall_isr_service(void)
+  {
+    const std::lock_guard<std::mutex> lock(pins_mutex);
+    isr_service_installed = false;
+  }
+
+  esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args)
+  {
+    if (!GPIO_IS_VALID_GPIO(gpio_num))
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+    const std::lock_guard<std::mutex> lock(pins_mutex);
+    if (!isr_service_installed)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+    pins[gpio_num].handler = isr_handler;
+    pins[gpio_num].arg = args;
+    return ESP_OK;
+  }
+
+  esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num)
+  {
+    return gpio_isr_handler_add(gpio_num, nullptr, nullptr);
+  }
+
+  // Logging
+
+  void esp_log_level_set(const char *tag, esp_log_level_t level)
+  {
+    const std::lock_guard<std::mutex> lock(log_mutex);
+    if (std::string(tag) == "*")
+    {
+      default_log_level = level;
+      log_levels.clear();
+      return;
+    }
+    log_levels[tag] = level;
+  }
+
+  esp_log_level_t esp_log_level_get(const char *tag)
+  {
+    const std::lock_guard<std::mutex> lock(log_mutex);
+    const auto level{log_levels.find(tag)};
+    return (level != log_levels.end()) ? level->second : default_log_level;
+  }
+
+  vprintf_like_t esp_log_set_vprintf(vprintf_like_t func)
+  {
+    const std::lock_guard<std::mutex> lock(log_mutex);
+    const vprintf_like_t previous{log_vprintf};
+    log_vprintf = func;
+    return previous;
+  }
+
+  uint32_t esp_log_timestamp(void) { return static_cast<uint32_t>(ElapsedNs() / 1000000); }
+
+  void esp_log_writev(esp_log_level_t level, const char *tag, const char *format, va_list args)
+  {
+    if (level > esp_log_level_get(tag))
+    {
+      return;
+    }
+    vprintf_like_t output;
+    {
+      const std::lock_guard<std::mutex> lock(log_mutex);
+      output = log_vprintf;
+    }
+    output(format, args);
+  }
+
+  void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+  {
+    va_list args;
+    va_start(args, format);
+    esp_log_writev(level, tag, format, args);
+    va_end(args);
+  }
+
+  // Errors
+
+  const char *esp_err_to_name(const esp_err_t code)
+  {
+    switch (code)
+    {
+    case ESP_OK:
+      return "ESP_OK";
+    case ESP_FAIL:
+      return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:
+      return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:
+      return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:
+      return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:
+      return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:
+      return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED:
+      return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:
+      return "ESP_ERR_TIMEOUT";
+    default:
+      return "UNKNOWN ERROR";
+    }
+  }
+
+  void _esp_error_check_failed(const esp_err_t rc,
+                               const char *file,
+                               const int line,
+                               const char *function,
+                               const char *expression)
+  {
+    fprintf(stderr, "ESP_ERROR_CHECK failed: esp_err_t 0x%x (%s) at %s:%d\n", rc,
+            esp_err_to_name(rc), file, line);
+    fprintf(stderr, "func: %s\nexpression: %s\n", function, expression);
+    abort();
+  }
+
+  // Memory
+
+  void *heap_caps_malloc(size_t size, uint32_t) { return malloc(size); }
+
+  void *heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t)
+  {
+    // aligned_alloc() requires a size multiple of the alignment
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+  }
+
+  void heap_caps_free(void *ptr) { free(ptr); }
+
+  // Time
+
+  int64_t esp_timer_get_time(void) { return ElapsedNs() / 1000; }
+
+  esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args,
+                             esp_timer_handle_t *out_handle)
+  {
+    if (!create_args || !create_args->callback || !out_handle)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+    esp_timer *const timer{new esp_timer{create_args->callback, create_args->arg,
+                                         create_args->dispatch_method == ESP_TIMER_ISR}};
+    const std::lock_guard<std::mutex> lock(timers.mutex);
+    timers.list.push_back(timer);
+    if (!timers.thread_started)
+    {
+      timers.thread_started = true;
+      std::thread(TimerThread).detach();
+    }
+    *out_handle = timer;
+    return ESP_OK;
+  }
+
+  esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+  {
+    return StartTimer(timer, timeout_us, 0);
+  }
+
+  esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+  {
+    return (period > 0) ? StartTimer(timer, period, period) : ESP_ERR_INVALID_ARG;
+  }
+
+  esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+  {
+    const std::lock_guard<std::mutex> lock(timers.mutex);
+    if (!timer->active)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = false;
+    timers.changed.notify_all();
+    return ESP_OK;
+  }
+
+  esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+  {
+    std::unique_lock<std::mutex> lock(timers.mutex);
+    if (timer->active)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+    timers.changed.wait(lock, [timer]() { return timers.running != timer; });
+    timers.list.erase(std::find(timers.list.begin(), timers.list.end(), timer));
+    delete timer;
+    return ESP_OK;
+  }
+
+  bool esp_timer_is_active(esp_timer_handle_t timer)
+  {
+    const std::lock_guard<std::mutex> lock(timers.mutex);
+    return timer->active;
+  }
+
+  esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void)
+  {
+    return static_cast<esp_cpu_cycle_count_t>(ElapsedNs());
+  }
+
+  uint32_t esp_rom_get_cpu_ticks_per_us(void) { return 1000; }
+
+  void esp_rom_delay_us(uint32_t us)
+  {
+    const int64_t end{esp_timer_get_time() + us};
+    while (esp_timer_get_time() < end)
+    {
+    }
+  }
+
+  // FreeRTOS
+
+  void vPortEnterCritical(portMUX_TYPE *mux)
+  {
+    if (mux->owner.load(std::memory_order_relaxed) == &critical_owner)
+    {
+      ++mux->count;
+      return;
+    }
+    const void *expected{nullptr};
+    while (!mux->owner.compare_exchange_weak(expected, &critical_owner, std::memory_order_acquire,
+                                             std::memory_order_relaxed))
+    {
+      expected = nullptr;
+      std::this_thread::yield();
+    }
+    mux->count = 1;
+  }
+
+  void vPortExitCritical(portMUX_TYPE *mux)
+  {
+    if (--mux->count == 0)
+    {
+      mux->owner.store(nullptr, std::memory_order_release);
+    }
+  }
+
+  BaseType_t xPortInIsrContext(void) { return in_isr ? pdTRUE : pdFALSE; }
+
+  TaskHandle_t xTaskGetCurrentTaskHandle(void) { return &current_task; }
+
+  TickType_t xTaskGetTickCount(void)
+  {
+    return static_cast<TickType_t>(ElapsedNs() / (1000000000 / configTICK_RATE_HZ));
+  }
+
+  void vTaskDelay(const TickType_t ticks_to_delay)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks_to_delay * portTICK_PERIOD_MS));
+  }
+
+  uint32_t ulTaskNotifyTake(const BaseType_t clear_count_on_exit, const TickType_t ticks_to_wait)
+  {
+    tskTaskControlBlock &task{current_task};
+    std::unique_lock<std::mutex> lock(task.mutex);
+    const auto notified{[&task]()
+                        { return task.notifications > 0; }};
+    if (ticks_to_wait == portMAX_DELAY)
+    {
+      task.notified.wait(lock, notified);
+    }
+    else
+    {
+      task.notified.wait_for(lock, std::chrono::milliseconds(ticks_to_wait * portTICK_PERIOD_MS),
+                             notified);
+    }
+    const uint32_t value{task.notifications};
+    if (value > 0)
+    {
+      task.notifications = clear_count_on_exit ? 0 : value - 1;
+    }
+    return value;
+  }
+
+  BaseType_t xTaskNotifyGive(TaskHandle_t task)
+  {
+    {
+      const std::lock_guard<std::mutex> lock(task->mutex);
+      ++task->notifications;
+    }
+    task->notified.notify_one();
+    return pdPASS;
+  }
+
+  void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *const higher_priority_task_woken)
+  {
+    xTaskNotifyGive(task);
+    if (higher_priority_task_woken)
+    {
+      *higher_priority_task_woken = pdTRUE;
+    }
+  }
+
+} // extern "C"
+
+// The test suites of test/ have their own Unity main
+#ifndef PIO_UNIT_TESTING
+int main()
+{
+  app_main();
+  return 0;
+}
+#endif
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/logger.h"
+#include "ESPTools/stats.h"
+
+#include <esp_cpu.h>
+#include <esp_rom_sys.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Compile-time log level of the Benchmark module
+#ifndef ESPTOOLS_LOG_LEVEL_BENCHMARK
+#define ESPTOOLS_LOG_LEVEL_BENCHMARK ESPTOOLS_LOG_LEVEL
+#endif
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Statistics of a benchmark, in CPU cycles
+   */
+  struct BenchmarkResult
+  {
+    size_t samples;
+    uint32_t min;
+    uint32_t median;
+    uint32_t p99;
+    uint32_t max;
+    uint32_t mean;
+    uint32_t std_dev;
+  };
+
+  /**
+   * @brief Small benchmark harness based on the CPU cycle counter. Every sample is the cycle
+   * count of a single call, minus the measured overhead of an empty call, so the reported
+   * min/median/p99 are cycle accurate for short operations.
+   *
+   * @details Samples are stored in a fixed array, no memory is allocated, so a single static
+   * instance can be reused for several measurements through `Reset()`. Values measured by other
+   * means (e.g. a latency computed inside an ISR) can be added with `AddSample()`. The array is
+   * only needed for the median and the p99: the count, extremes, mean and deviation come from the
+   * RunningStats shared with the other ESPTools instruments.
+   *
+   * @tparam MAX_SAMPLES Maximum number of samples kept per benchmark
+   */
+  template <size_t MAX_SAMPLES = 256>
+  class Benchmark
+  {
+    static_assert(MAX_SAMPLES > 0, "Benchmark needs room for at least one sample");
+
+  public:
+    constexpr Benchmark() : count_(0), samples_(), stats_() {}
+
+    /**
+     * @brief Calls `function` `iterations` times and records the cycles of each call
+     *
+     * @tparam Function Callable with signature `void()`
+     * @param function Code to measure
+     * @param iterations Number of samples, limited to MAX_SAMPLES
+     * @return This benchmark, to chain a call to `Report()`
+     */
+    template <typename Function>
+    Benchmark &Measure(Function &&function, const size_t iterations = MAX_SAMPLES)
+    {
+      const uint32_t overhead{Overhead()};
+      for (size_t i{0}; i < iterations && count_ < MAX_SAMPLES; ++i)
+      {
+        const uint32_t start{esp_cpu_get_cycle_count()};
+        function();
+        const uint32_t cycles{esp_cpu_get_cycle_count() - start};
+        Record((cycles > overhead) ? (cycles - overhead) : 0);
+      }
+      return *this;
+    }
+
+    /**
+     * @brief Records an externally measured sample
+     *
+     * @param cycles Measured value in CPU cycles
+     * @return False if the sample array is full
+     */
+    bool AddSample(const uint32_t cycles)
+    {
+      if (count_ >= MAX_SAMPLES)
+      {
+        return false;
+      }
+      Record(cycles);
+      return true;
+    }
+
+    /**
+     * @brief Computes the statistics of the recorded samples
+     */
+    BenchmarkResult GetResult()
+    {
+      if (count_ == 0)
+      {
+        return {0, 0, 0, 0, 0, 0, 0};
+      }
+      std::sort(samples_, samples_ + count_);
+      return {count_,
+              stats_.GetMin(),
+              samples_[count_ / 2],
+              samples_[std::min(count_ - 1, (count_ * 99) / 100)],
+              stats_.GetMax(),
+              stats_.GetMean(),
+              stats_.GetStdDev()};
+    }
+
+    /**
+     * @brief Computes and logs the statistics of the recorded samples
+     *
+     * @param name Name of the benchmark printed with the results
+     */
+    BenchmarkResult Report(const char *const name)
+    {
+      const BenchmarkResult result{GetResult()};
+      const uint32_t cycles_per_us{esp_rom_get_cpu_ticks_per_us()};
+      ESPTOOLS_LOGI("%-28s n=%-4u min=%-6" PRIu32 " median=%-6" PRIu32 " p99=%-6" PRIu32
+                    " max=%-6" PRIu32 " cycles (median %" PRIu32 " ns)",
+                    name, static_cast<unsigned>(result.samples), result.min, result.median,
+                    result.p99, result.max, (result.median * 1000) / cycles_per_us);
+      return result;
+    }
+
+    /**
+     * @brief Discards the recorded samples
+     */
+    void Reset()
+    {
+      count_ = 0;
+      stats_.Reset();
+    }
+
+  private:
+    // Tag used for the logging system
+    static constexpr char LOG_TAG[]{ESPTOOLS_LOG_TAG_CREATOR("Benchmark")};
+    // Compile-time log level of the module
+    static constexpr esp_log_level_t LOG_LEVEL{ESPTOOLS_LOG_LEVEL_BENCHMARK};
+
+    /**
+     * @brief Returns the minimum cycles measured around an empty block
+     */
+    static uint32_t Overhead()
+    {
+      RunningStats<uint32_t> overhead;
+      for (int i{0}; i < 16; ++i)
+      {
+        const uint32_t start{esp_cpu_get_cycle_count()};
+        overhead.Add(esp_cpu_get_cycle_count() - start);
+      }
+      return overhead.GetMin();
+    }
+
+    /**
+     * @brief Stores a sample. The caller checks that the array is not full.
+     */
+    void Record(const uint32_t cycles)
+    {
+      samples_[count_++] = cycles;
+      stats_.Add(cycles);
+    }
+
+    size_t count_;
+    uint32_t samples_[MAX_SAMPLES];
+    RunningStats<uint32_t> stats_;
+  };
+
+} // namespace ESPTools
@@ -0,0 +1,216 @@
+#pragma once
+
+#include "ESPTools/core.h"
+
+#include <driver/gpio.h>
+#include <esp_err.h>
+#include <soc/soc_caps.h>
+
+#include <bit>
+#include <cstdint>
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Chips known by ChipTraits
+   */
+  enum class Chip : uint8_t
+  {
+    Esp32,
+    Esp32C2,
+    Esp32S3,
+    // Any other target, only its valid and output capable pins are known
+    Other,
+  };
+
+  // Chip the firmware is built for
+#if CONFIG_IDF_TARGET_ESP32
+  static constexpr Chip CURRENT_CHIP{Chip::Esp32};
+#elif CONFIG_IDF_TARGET_ESP32C2
+  static constexpr Chip CURRENT_CHIP{Chip::Esp32C2};
+#elif CONFIG_IDF_TARGET_ESP32S3
+  static constexpr Chip CURRENT_CHIP{Chip::Esp32S3};
+#else
+  static constexpr Chip CURRENT_CHIP{Chip::Other};
+#endif
+
+  /**
+   * @brief Returns a GPIO mask with the bits from `first` to `last` (both included) set
+   */
+  constexpr uint64_t CreatePinRangeMask(const uint8_t first, const uint8_t last)
+  {
+    return (CreateBitMaskAt<uint64_t>(last) << 1) - CreateBitMaskAt<uint64_t>(first);
+  }
+
+  /**
+   * @brief GPIO capabilities of a chip, as bit masks where bit N corresponds to GPIO N
+   *
+   * @details The tables follow the datasheets of the modules used by the boards of this project
+   * (ESP32-WROOM, ESP8684/ESP32-C2 and ESP32-S3-WROOM). Reserved pins are the ones wired to the
+   * SPI flash; pins wired to PSRAM on some modules (e.g. GPIO16-17 on the ESP32-WROVER and
+   * GPIO33-37 with octal PSRAM on the ESP32-S3) are not included.
+   *
+   * @tparam CHIP Chip described by the traits
+   */
+  template <Chip CHIP>
+  struct ChipTraits
+  {
+    // Pins that exist and can be used as a GPIO
+    static constexpr uint64_t VALID_MASK{SOC_GPIO_VALID_GPIO_MASK};
+    // Pins that can drive an output
+    static constexpr uint64_t OUTPUT_MASK{SOC_GPIO_VALID_OUTPUT_GPIO_MASK};
+    // Pins with internal pull-up and pull-down resistors
+    static constexpr uint64_t PULL_MASK{SOC_GPIO_VALID_GPIO_MASK};
+    // Pins sampled at reset to select the boot mode
+    static constexpr uint64_t STRAPPING_MASK{0};
+    // Pins used by the SPI flash
+    static constexpr uint64_t RESERVED_MASK{0};
+  };
+
+  template <>
+  struct ChipTraits<Chip::Esp32>
+  {
+    static constexpr uint64_t VALID_MASK{CreatePinRangeMask(0, 23) | CreatePinRangeMask(25, 27) |
+                                         CreatePinRangeMask(32, 39)};
+    // GPIO34-39 are input only, and have no pull resistors
+    static constexpr uint64_t OUTPUT_MASK{VALID_MASK & ~CreatePinRangeMask(34, 39)};
+    static constexpr uint64_t PULL_MASK{OUTPUT_MASK};
+    static constexpr uint64_t STRAPPING_MASK{
+        CreateBitMaskAt<uint64_t>(0) | CreateBitMaskAt<uint64_t>(2) |
+        CreateBitMaskAt<uint64_t>(5) | CreateBitMaskAt<uint64_t>(12) |
+        CreateBitMaskAt<uint64_t>(15)};
+    static constexpr uint64_t RESERVED_MASK{CreatePinRangeMask(6, 11)};
+  };
+
+  template <>
+  struct ChipTraits<Chip::Esp32C2>
+  {
+    static constexpr uint64_t VALID_MASK{CreatePinRangeMask(0, 20)};
+    static constexpr uint64_t OUTPUT_MASK{VALID_MASK};
+    static constexpr uint64_t PULL_MASK{VALID_MASK};
+    static constexpr uint64_t STRAPPING_MASK{CreateBitMaskAt<uint64_t>(8) |
+                                             CreateBitMaskAt<uint64_t>(9)};
+    static constexpr uint64_t RESERVED_MASK{CreatePinRangeMask(12, 17)};
+  };
+
+  template <>
+  struct ChipTraits<Chip::Esp32S3>
+  {
+    static constexpr uint64_t VALID_MASK{CreatePinRangeMask(0, 21) | CreatePinRangeMask(26, 48)};
+    static constexpr uint64_t OUTPUT_MASK{VALID_MASK};
+    static constexpr uint64_t PULL_MASK{VALID_MASK};
+    static constexpr uint64_t STRAPPING_MASK{
+        CreateBitMaskAt<uint64_t>(0) | CreateBitMaskAt<uint64_t>(3) |
+        CreateBitMaskAt<uint64_t>(45) | CreateBitMaskAt<uint64_t>(46)};
+    static constexpr uint64_t RESERVED_MASK{CreatePinRangeMask(26, 32)};
+  };
+
+  // The table of the target must agree with ESP-IDF
+  static_assert(ChipTraits<CURRENT_CHIP>::VALID_MASK == SOC_GPIO_VALID_GPIO_MASK,
+                "ChipTraits does not match the GPIOs of the target");
+  static_assert(ChipTraits<CURRENT_CHIP>::OUTPUT_MASK == SOC_GPIO_VALID_OUTPUT_GPIO_MASK,
+                "ChipTraits does not match the output GPIOs of the target");
+
+  /**
+   * @brief Configuration shared by all the pins of a PinGroup. It is a structural type, so it can
+   * be used as a template argument, e.g. `PinGroupOptions{GPIO_MODE_INPUT, true}`.
+   */
+  struct PinGroupOptions
+  {
+    gpio_mode_t mode{GPIO_MODE_INPUT};
+    bool pull_up{false};
+    bool pull_down{false};
+    gpio_int_type_t intr_type{GPIO_INTR_DISABLE};
+    // Whether strapping pins are accepted. They must not be driven or pulled against their boot
+    // value while the chip is reset.
+    bool allow_strapping{false};
+  };
+
+  /**
+   * @brief Pin map of a board for a given chip. Pins are grouped by configuration, and each group
+   * is checked at compile time against the ChipTraits of the chip, so a pin that does not exist,
+   * an output on an input only pin, a pull on a pin without resistors, a pin used by the flash or
+   * a strapping pin fail the build
+   * with a `static_assert` instead of an `ESP_ERROR_CHECK` at runtime.
+   *
+   * @details A board map is usually a struct with a `Group` alias per function, and an
+   * `#if CONFIG_IDF_TARGET_*` block per supported board:
+   * @code
+   * struct Board
+   * {
+   *   using Pins = ESPTools::BoardPins<>;
+   *   using Buttons = Pins::Group<ESPTools::PinGroupOptions{GPIO_MODE_INPUT, true},
+   *                               GPIO_NUM_4, GPIO_NUM_5>;
+   *   using Leds = Pins::Group<ESPTools::PinGroupOptions{GPIO_MODE_OUTPUT}, GPIO_NUM_6>;
+   * };
+   * ESPTools::ConfigurePinGroups<Board::Buttons, Board::Leds>();
+   * @endcode
+   *
+   * @tparam CHIP Chip the board is built with, the target chip by default
+   */
+  template <Chip CHIP = CURRENT_CHIP>
+  struct BoardPins
+  {
+    using Traits = ChipTraits<CHIP>;
+
+    /**
+     * @brief Set of pins sharing the same configuration. The `gpio_config_t` of the whole group
+     * is computed at compile time, so configuring it is a single `gpio_config()` call.
+     *
+     * @tparam OPTIONS Configuration of the pins
+     * @tparam PINS GPIO numbers of the group
+     */
+    template <PinGroupOptions OPTIONS, gpio_num_t... PINS>
+    struct Group
+    {
+      static_assert(sizeof...(PINS) > 0, "A pin group needs at least one pin");
+      static_assert(((PINS >= 0 && PINS < 64) && ...), "Invalid GPIO number");
+
+      // Pins of the group
+      static constexpr uint64_t MASK{(CreateBitMaskAt<uint64_t>(PINS) | ...)};
+
+      static_assert(std::popcount(MASK) == sizeof...(PINS), "Pin listed twice in the group");
+      static_assert((MASK & ~Traits::VALID_MASK) == 0, "GPIO does not exist on this chip");
+      static_assert((MASK & Traits::RESERVED_MASK) == 0, "GPIO is used by the SPI flash");
+      static_assert(!(OPTIONS.mode & GPIO_MODE_DEF_OUTPUT) ||
+                        (MASK & ~Traits::OUTPUT_MASK) == 0,
+                    "Input only GPIO used as an output");
+      static_assert(OPTIONS.allow_strapping || (MASK & Traits::STRAPPING_MASK) == 0,
+                    "Strapping GPIO used without allow_strapping");
+      static_assert(!(OPTIONS.pull_up && OPTIONS.pull_down), "Pull-up and pull-down both set");
+      static_assert(!(OPTIONS.pull_up || OPTIONS.pull_down) || (MASK & ~Traits::PULL_MASK) == 0,
+                    "Pull resistor requested on a GPIO without them");
+
+      // Configuration of the whole group
+      static constexpr gpio_config_t CONFIG{
+          .pin_bit_mask = MASK,
+          .mode = OPTIONS.mode,
+          .pull_up_en = OPTIONS.pull_up ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE,
+          .pull_down_en = OPTIONS.pull_down ? GPIO_PULLDOWN_ENABLE : GPIO_PULLDOWN_DISABLE,
+          .intr_type = OPTIONS.intr_type,
+      };
+
+      /**
+       * @brief Configures every pin of the group with a single `gpio_config()` call
+       */
+      static void Configure() { ESP_ERROR_CHECK(gpio_config(&CONFIG)); }
+    };
+  };
+
+  /**
+   * @brief Configures several pin groups, one `gpio_config()` call per group. Fails to compile
+   * when a pin belongs to more than one group.
+   *
+   * @tparam GROUPS BoardPins::Group types
+   */
+  template <typename... GROUPS>
+  void ConfigurePinGroups()
+  {
+    static_assert(std::popcount((GROUPS::MASK | ... | uint64_t{0})) ==
+                      (std::popcount(GROUPS::MASK) + ... + 0),
+                  "Pin used by more than one group");
+    (GROUPS::Configure(), ...);
+  }
+
+} // namespace ESPTools
@@ -2,33 +2,99 @@
 #include "ESPTools/logger.h"
 
 #include <driver/gpio.h>
+#include <esp_intr_alloc.h>
 
+#include <atomic>
+#include <bit>
 #include <limits>
+#include <mutex>
 
 namespace ESPTools
 {
 
   constexpr UBaseType_t UBASETYPE_MAX{std::numeric_limits<UBaseType_t>::max()};
 
+  namespace
+  {
+    // Guard of the ISR service installation
+    std::once_flag isr_service_once;
+    // Set once the ISR service is installed, by ESPTools or by someone else
+    std::atomic<bool> isr_service_installed{false};
+    // Flags of the installed ISR service
+    std::atomic<int> isr_service_flags{ISR_SERVICE_FLAGS_UNKNOWN};
+  } // namespace
+
   void InstallIsrService(const int intr_alloc_flags)
   {
-    // Flag to track whether ISR service has been installed or not
-    static bool interrupt_initialized{false};
-    // Install ISR service if not installed
-    if (!interrupt_initialized)
-    {
+    // Install ISR service if not installed, concurrent callers wait for the first one
+    std::call_once(isr_service_once, [intr_alloc_flags]()
+                   {
       const esp_err_t ret{gpio_install_isr_service(intr_alloc_flags)};
       switch (ret)
       {
+      case ESP_OK:
+        isr_service_flags.store(intr_alloc_flags, std::memory_order_relaxed);
+        break;
       case ESP_ERR_INVALID_STATE:
         ESPTOOLS_LOGW("Please use only InstallIsrService to install the ISR service");
-        [[fallthrough]];
-      case ESP_OK:
-        interrupt_initialized = true;
         break;
       default:
         ESP_ERROR_CHECK(ret);
       }
+      isr_service_installed.store(true, std::memory_order_release); });
+
+    const int installed_flags{GetIsrServiceFlags()};
+    // Different flags are fine as long as the installed service meets them
+    if (intr_alloc_flags != 0 && !IsrServiceSatisfies(intr_alloc_flags))
+    {
+      ESPTOOLS_LOGW("ISR service requested with flags 0x%x but installed with 0x%x",
+                    intr_alloc_flags, installed_flags);
+    }
+  }
+
+  bool IsIsrServiceInstalled()
+  {
+    return isr_service_installed.load(std::memory_order_acquire);
+  }
+
+  int GetIsrServiceFlags()
+  {
+    return IsIsrServiceInstalled() ? isr_service_flags.load(std::memory_order_relaxed)
+                                   : ISR_SERVICE_FLAGS_UNKNOWN;
+  }
+
+  bool IsrServiceSatisfies(const int required_flags)
+  {
+    const int flags{GetIsrServiceFlags()};
+    if (flags == ISR_SERVICE_FLAGS_UNKNOWN)
+    {
+      return false;
+    }
+    if ((required_flags & ESP_INTR_FLAG_IRAM) && !(flags & ESP_INTR_FLAG_IRAM))
+    {
+      return false;
+    }
+    const unsigned required_levels{
+        static_cast<unsigned>(required_flags & ESP_INTR_FLAG_LEVELMASK)};
+    if (required_levels == 0)
+    {
+      return true;
+    }
+    // Without level flags the interrupt can be allocated at any low or medium level
+    const unsigned levels{static_cast<unsigned>(flags & ESP_INTR_FLAG_LEVELMASK)};
+    const unsigned allowed_levels{levels ? levels : static_cast<unsigned>(ESP_INTR_FLAG_LOWMED)};
+    // The bit position of ESP_INTR_FLAG_LEVELx is x, so the lowest bits are the lowest levels
+    return std::countr_zero(allowed_levels) >= std::countr_zero(required_levels);
+  }
+
+  void RequireIsrServiceFlags(const int required_flags)
+  {
+    InstallIsrService(required_flags);
+    if (!IsrServiceSatisfies(required_flags))
+    {
+      ESPTOOLS_LOGE("ISR service flags 0x%x do not meet the required 0x%x", GetIsrServiceFlags(),
+                    required_flags);
+      ESP_ERROR_CHECK(ESP_ERR_INVALID_STATE);
     }
   }
 
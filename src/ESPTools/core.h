@@ -19,6 +19,8 @@ namespace ESPTools
 #else
   static constexpr BaseType_t APP_CORE_ID{1};
 #endif
+  // Core ID where the protocol stacks (WiFi, BT, lwIP) run
+  static constexpr BaseType_t PROTOCOL_CORE_ID{0};
 
   // Maximum value for UBaseType_t
   extern const UBaseType_t UBASETYPE_MAX;
@@ -26,19 +28,64 @@ namespace ESPTools
   /**
    * @brief Generates a bitmask with bit set at given position.
    *
+   * @tparam T Type of the bitmask. Use `uint64_t` for GPIO masks, as `unsigned long` is only 32
+   * bits wide on the ESP32 chips.
    * @param bitPosition The index of bit to set.
    * @return Bitmask with bit set at 'bitPosition'.
    */
-  constexpr unsigned long CreateBitMaskAt(const uint8_t bitPosition) { return 1UL << bitPosition; }
+  template <typename T = unsigned long>
+  constexpr T CreateBitMaskAt(const uint8_t bitPosition) { return T{1} << bitPosition; }
+
+  // Value returned by GetIsrServiceFlags() when the flags of the ISR service are not known
+  static constexpr int ISR_SERVICE_FLAGS_UNKNOWN{-1};
 
   /**
    * @brief Wrapper around `gpio_install_isr_service` to keep track of ISR service installation
    * status, as ESP-IDF doesn't provide a way to determine whether the ISR service has been
    * installed or not. Please, use this function and not `gpio_install_isr_service`.
    *
+   * @details Thread safe: the service is installed exactly once, by the first caller, even when
+   * several tasks call this function at the same time. The flags of that first call are recorded
+   * and a warning is logged when a later call requests flags the installed service does not meet
+   * (see `IsrServiceSatisfies()`), as they cannot be applied anymore. Components that depend on
+   * the flags should use `RequireIsrServiceFlags()`.
+   *
    * @param intr_alloc_flags Flags used to allocate the interrupt. One or multiple (ORred)
-   * ESP_INTR_FLAG_* values. See esp_intr_alloc.h for more info.
+   * ESP_INTR_FLAG_* values. See esp_intr_alloc.h for more info. 0 means no preference.
    */
   void InstallIsrService(const int intr_alloc_flags);
 
+  /**
+   * @brief Returns whether the ISR service has been installed
+   */
+  bool IsIsrServiceInstalled();
+
+  /**
+   * @brief Returns the flags the ISR service was installed with
+   *
+   * @return ESP_INTR_FLAG_* flags, or ISR_SERVICE_FLAGS_UNKNOWN if the service is not installed
+   * or was installed without `InstallIsrService`
+   */
+  int GetIsrServiceFlags();
+
+  /**
+   * @brief Checks whether the installed ISR service meets the given requirements: the
+   * ESP_INTR_FLAG_IRAM flag, if required, and an interrupt level not lower than the lowest
+   * required ESP_INTR_FLAG_LEVELx. Other flags are ignored.
+   *
+   * @param required_flags ESP_INTR_FLAG_* flags the service must meet
+   * @return False if the service is not installed or its flags are unknown
+   */
+  bool IsrServiceSatisfies(const int required_flags);
+
+  /**
+   * @brief Installs the ISR service with the given flags if it is not installed yet, and aborts
+   * if the installed service does not meet them (see `IsrServiceSatisfies()`). Meant for latency
+   * sensitive components, which should rather fail loudly than silently run from flash or at a
+   * low interrupt level.
+   *
+   * @param required_flags ESP_INTR_FLAG_* flags the service must meet
+   */
+  void RequireIsrServiceFlags(const int required_flags);
+
 } // namespace ESPTools
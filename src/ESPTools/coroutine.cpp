@@ -0,0 +1,263 @@
+#include "ESPTools/logger.h"
+#include "ESPTools/coroutine.h"
+#include "ESPTools/object_pool.h"
+
+#include <driver/gpio.h>
+#include <esp_attr.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <cstddef>
+#include <cstdlib>
+
+namespace ESPTools
+{
+
+  namespace
+  {
+    static_assert((ESPTOOLS_CO_MAX_FRAMES & (ESPTOOLS_CO_MAX_FRAMES - 1)) == 0,
+                  "ESPTOOLS_CO_MAX_FRAMES must be a power of two");
+
+    /**
+     * @brief Storage of a coroutine frame
+     */
+    struct CoFrame
+    {
+      alignas(std::max_align_t) unsigned char storage[ESPTOOLS_CO_FRAME_SIZE];
+    };
+
+    // Frames of all the coroutines, allocated and freed from the tasks only
+    ObjectPool<CoFrame, ESPTOOLS_CO_MAX_FRAMES> frames;
+
+    /**
+     * @brief Returns true if the deadline `a` comes before `b`, across tick count overflows
+     */
+    bool Before(const TickType_t a, const TickType_t b)
+    {
+      return static_cast<int32_t>(a - b) < 0;
+    }
+  } // namespace
+
+  void *CoTask::promise_type::operator new(const size_t size) noexcept
+  {
+    if (size > sizeof(CoFrame))
+    {
+      ESPTOOLS_LOGE("Coroutine frame of %u bytes, larger than ESPTOOLS_CO_FRAME_SIZE (%u)",
+                    static_cast<unsigned>(size), static_cast<unsigned>(sizeof(CoFrame)));
+      return nullptr;
+    }
+    CoFrame *const frame{frames.Acquire()};
+    if (!frame)
+    {
+      ESPTOOLS_LOGE("No free coroutine frames, increase ESPTOOLS_CO_MAX_FRAMES");
+      return nullptr;
+    }
+    return frame->storage;
+  }
+
+  void CoTask::promise_type::operator delete(void *const frame) noexcept
+  {
+    frames.Release(static_cast<CoFrame *>(frame));
+  }
+
+  void CoTask::promise_type::unhandled_exception()
+  {
+    // Exceptions are disabled in the default ESP-IDF configuration
+    abort();
+  }
+
+  CoTask::~CoTask()
+  {
+    if (handle_)
+    {
+      handle_.destroy();
+    }
+  }
+
+  size_t CoTask::GetMinFreeFrames() { return frames.GetMinAvailable(); }
+
+  void Delay::await_suspend(const CoTask::Handle handle)
+  {
+    handle_ = handle;
+    deadline_ = xTaskGetTickCount() + ticks_;
+    handle.promise().executor->AddTimer(*this);
+  }
+
+  void PinEdge::await_suspend(const CoTask::Handle handle)
+  {
+    executor_ = handle.promise().executor;
+    waiting_.store(handle.address(), std::memory_order_relaxed);
+    // Edge of the physical level that corresponds to the awaited logical state
+    const bool rising{state_ == GpioState(1, inverse_logic_)};
+    InstallIsrService(0);
+    ESP_ERROR_CHECK(gpio_set_intr_type(pin_, rising ? GPIO_INTR_POSEDGE : GPIO_INTR_NEGEDGE));
+    ESP_ERROR_CHECK(gpio_isr_handler_add(pin_, IsrHandler, this));
+    ESP_ERROR_CHECK(gpio_intr_enable(pin_));
+  }
+
+  int64_t PinEdge::await_resume()
+  {
+    ESP_ERROR_CHECK(gpio_intr_disable(pin_));
+    ESP_ERROR_CHECK(gpio_isr_handler_remove(pin_));
+    return timestamp_us_;
+  }
+
+  void IRAM_ATTR PinEdge::IsrHandler(void *arg)
+  {
+    PinEdge &edge{*static_cast<PinEdge *>(arg)};
+    // Only the first edge resumes the coroutine, until the handler is removed
+    void *const waiting{edge.waiting_.exchange(nullptr, std::memory_order_acq_rel)};
+    if (waiting)
+    {
+      edge.timestamp_us_ = esp_timer_get_time();
+      edge.executor_->Schedule(std::coroutine_handle<>::from_address(waiting));
+    }
+  }
+
+  bool AsyncEvent::Awaiter::await_suspend(const CoTask::Handle handle)
+  {
+    portENTER_CRITICAL(&event_.lock_);
+    if (event_.set_)
+    {
+      // Consume the event and continue without suspending
+      event_.set_ = false;
+      portEXIT_CRITICAL(&event_.lock_);
+      return false;
+    }
+    executor_ = handle.promise().executor;
+    handle_ = handle;
+    next_ = event_.waiters_;
+    event_.waiters_ = this;
+    portEXIT_CRITICAL(&event_.lock_);
+    return true;
+  }
+
+  void IRAM_ATTR AsyncEvent::Set()
+  {
+    portENTER_CRITICAL_SAFE(&lock_);
+    Awaiter *waiter{waiters_};
+    waiters_ = nullptr;
+    if (!waiter)
+    {
+      set_ = true;
+    }
+    portEXIT_CRITICAL_SAFE(&lock_);
+    while (waiter)
+    {
+      // Read before scheduling, the awaiter is destroyed once its coroutine resumes
+      Awaiter *const next{waiter->next_};
+      waiter->executor_->Schedule(waiter->handle_);
+      waiter = next;
+    }
+  }
+
+  CoExecutor::CoExecutor(const char *const name,
+                         const UBaseType_t priority,
+                         const CorePolicy core_policy)
+      : StaticTask(name, priority, core_policy), ready_(), timers_(nullptr), count_(0)
+  {
+  }
+
+  CoExecutor::~CoExecutor() { Stop(); }
+
+  bool CoExecutor::Spawn(CoTask &&task)
+  {
+    if (!task)
+    {
+      return false;
+    }
+    task.handle_.promise().executor = this;
+    count_.fetch_add(1, std::memory_order_relaxed);
+    Schedule(std::exchange(task.handle_, nullptr));
+    return true;
+  }
+
+  void IRAM_ATTR CoExecutor::Schedule(const std::coroutine_handle<> handle)
+  {
+    // Never full, see the class description
+    ready_.Push(handle);
+    const TaskHandle_t task{GetHandle()};
+    if (!task)
+    {
+      // Not started yet, the queue is drained when it starts
+      return;
+    }
+    if (xPortInIsrContext())
+    {
+      BaseType_t higher_priority_task_woken{pdFALSE};
+      vTaskNotifyGiveFromISR(task, &higher_priority_task_woken);
+      portYIELD_FROM_ISR(higher_priority_task_woken);
+    }
+    else
+    {
+      xTaskNotifyGive(task);
+    }
+  }
+
+  void CoExecutor::Run()
+  {
+    ESPTOOLS_LOGD("Executor started with %u coroutines", static_cast<unsigned>(GetCount()));
+    while (true)
+    {
+      std::coroutine_handle<> handle;
+      while (ready_.Pop(handle))
+      {
+        Resume(handle);
+      }
+      // Unlink the expired timers first, so the ones added while resuming wait for the next
+      // iteration instead of starving the ready queue
+      const TickType_t now{xTaskGetTickCount()};
+      Delay *expired{nullptr};
+      if (timers_ && !Before(now, timers_->deadline_))
+      {
+        expired = timers_;
+        Delay **link{&timers_->next_};
+        while (*link && !Before(now, (*link)->deadline_))
+        {
+          link = &(*link)->next_;
+        }
+        timers_ = *link;
+        *link = nullptr;
+      }
+      while (expired)
+      {
+        // Read before resuming, the awaiter is destroyed once its coroutine resumes
+        Delay &delay{*expired};
+        expired = delay.next_;
+        Resume(delay.handle_);
+      }
+      // Coroutines scheduled meanwhile, even by the executor itself, have notified the task
+      TickType_t timeout{portMAX_DELAY};
+      if (timers_)
+      {
+        const TickType_t current{xTaskGetTickCount()};
+        timeout = Before(current, timers_->deadline_) ? timers_->deadline_ - current : 0;
+      }
+      ulTaskNotifyTake(pdTRUE, timeout);
+    }
+  }
+
+  void CoExecutor::AddTimer(Delay &delay)
+  {
+    // Equal deadlines keep their order, so the coroutines delayed by 0 ticks take turns
+    Delay **link{&timers_};
+    while (*link && !Before(delay.deadline_, (*link)->deadline_))
+    {
+      link = &(*link)->next_;
+    }
+    delay.next_ = *link;
+    *link = &delay;
+  }
+
+  void CoExecutor::Resume(const std::coroutine_handle<> handle)
+  {
+    handle.resume();
+    if (handle.done())
+    {
+      handle.destroy();
+      count_.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+
+} // namespace ESPTools
@@ -0,0 +1,327 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/gpio_state.h"
+#include "ESPTools/logger.h"
+#include "ESPTools/ring_buffer.h"
+#include "ESPTools/task.h"
+
+#include <driver/gpio.h>
+#include <esp_attr.h>
+#include <freertos/FreeRTOS.h>
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Size in bytes of a coroutine frame. Coroutines with a larger frame fail to spawn.
+#ifndef ESPTOOLS_CO_FRAME_SIZE
+#define ESPTOOLS_CO_FRAME_SIZE 256
+#endif
+
+// Maximum number of coroutines alive at once, shared by all the executors. Must be a power of
+// two.
+#ifndef ESPTOOLS_CO_MAX_FRAMES
+#define ESPTOOLS_CO_MAX_FRAMES 32
+#endif
+
+// Stack size in bytes of an executor task
+#ifndef ESPTOOLS_CO_STACK_SIZE
+#define ESPTOOLS_CO_STACK_SIZE 4096
+#endif
+
+// Compile-time log level of the coroutine module
+#ifndef ESPTOOLS_LOG_LEVEL_COROUTINE
+#define ESPTOOLS_LOG_LEVEL_COROUTINE ESPTOOLS_LOG_LEVEL
+#endif
+
+namespace ESPTools
+{
+
+  class CoExecutor;
+
+  /**
+   * @brief Return type of a coroutine run by a CoExecutor. The coroutine does not start until it
+   * is given to `CoExecutor::Spawn()`, and its frame is destroyed when it returns.
+   *
+   * @details Frames are allocated from a static pool of ESPTOOLS_CO_MAX_FRAMES slots of
+   * ESPTOOLS_CO_FRAME_SIZE bytes instead of the heap. The frame holds the variables that live
+   * across a `co_await`, which is all the memory a suspended coroutine uses, so hundreds of them
+   * can wait on a single executor stack. A coroutine whose frame does not fit, or created while
+   * the pool is exhausted, yields an empty CoTask that `Spawn()` rejects.
+   *
+   * @code
+   * ESPTools::CoTask Blink(const gpio_num_t pin)
+   * {
+   *   while (true)
+   *   {
+   *     gpio_set_level(pin, 1);
+   *     co_await ESPTools::Delay(100);
+   *     gpio_set_level(pin, 0);
+   *     co_await ESPTools::Delay(900);
+   *   }
+   * }
+   * @endcode
+   */
+  class CoTask
+  {
+  public:
+    struct promise_type
+    {
+      static void *operator new(const size_t size) noexcept;
+      static void operator delete(void *const frame) noexcept;
+      static CoTask get_return_object_on_allocation_failure() { return CoTask(); }
+
+      CoTask get_return_object()
+      {
+        return CoTask(std::coroutine_handle<promise_type>::from_promise(*this));
+      }
+      std::suspend_always initial_suspend() noexcept { return {}; }
+      std::suspend_always final_suspend() noexcept { return {}; }
+      void return_void() {}
+      void unhandled_exception();
+
+      // Executor that resumes the coroutine, set by `Spawn()`
+      CoExecutor *executor{nullptr};
+    };
+
+    // Handle of a coroutine returning a CoTask
+    using Handle = std::coroutine_handle<promise_type>;
+
+    constexpr CoTask() : handle_(nullptr) {}
+    CoTask(CoTask &&other) : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    /**
+     * @brief Destroys the coroutine if it was never spawned
+     */
+    ~CoTask();
+
+    CoTask(const CoTask &) = delete;
+    CoTask &operator=(const CoTask &) = delete;
+    CoTask &operator=(CoTask &&) = delete;
+
+    /**
+     * @brief Returns false if the frame could not be allocated
+     */
+    explicit operator bool() const { return static_cast<bool>(handle_); }
+
+    /**
+     * @brief Returns the lowest number of free frames seen. Useful to size ESPTOOLS_CO_MAX_FRAMES.
+     */
+    static size_t GetMinFreeFrames();
+
+  private:
+    friend class CoExecutor;
+
+    // Tag used for the logging system
+    static constexpr char LOG_TAG[]{ESPTOOLS_LOG_TAG_CREATOR("CoTask")};
+    // Compile-time log level of the module
+    static constexpr esp_log_level_t LOG_LEVEL{ESPTOOLS_LOG_LEVEL_COROUTINE};
+
+    explicit CoTask(const Handle handle) : handle_(handle) {}
+
+    Handle handle_;
+  };
+
+  /**
+   * @brief Awaitable that suspends the coroutine for a number of milliseconds, rounded to RTOS
+   * ticks. `co_await Delay(0)` lets the other ready coroutines run.
+   *
+   * @details The executor keeps the delayed coroutines in a list sorted by deadline, linked
+   * through the awaiters stored in their frames, and blocks its task until the earliest one.
+   * Delays must be shorter than 2^31 ticks.
+   */
+  class Delay
+  {
+  public:
+    explicit Delay(const uint32_t ms)
+        : ticks_(pdMS_TO_TICKS(ms)), deadline_(0), handle_(nullptr), next_(nullptr)
+    {
+    }
+
+    bool await_ready() const { return false; }
+    void await_suspend(const CoTask::Handle handle);
+    void await_resume() const {}
+
+  private:
+    friend class CoExecutor;
+
+    const TickType_t ticks_;
+    TickType_t deadline_;
+    std::coroutine_handle<> handle_;
+    Delay *next_;
+  };
+
+  /**
+   * @brief Awaitable that suspends the coroutine until the pin changes to a state. Returns the
+   * time of the edge as given by `esp_timer_get_time()`.
+   *
+   * @details The pin must already be configured as an input. While the coroutine waits, the pin
+   * has its own ISR handler (installed through `InstallIsrService`), so it must not be used by a
+   * GpioInput, a GpioWaiter or another PinEdge at the same time. The edge is armed when the
+   * coroutine suspends, so a pin that is already in the state waits for the next edge; there is
+   * no debouncing.
+   */
+  class PinEdge
+  {
+  public:
+    /**
+     * @param pin GPIO number of the input
+     * @param state State to wait for, High or Low
+     * @param inverse_logic If set to true, the logic of the pin is inverted (active low input)
+     */
+    PinEdge(const gpio_num_t pin, const GpioState state, const bool inverse_logic = false)
+        : pin_(pin), state_(state), inverse_logic_(inverse_logic), executor_(nullptr),
+          waiting_(nullptr), timestamp_us_(0)
+    {
+    }
+
+    bool await_ready() const { return false; }
+    void await_suspend(const CoTask::Handle handle);
+    int64_t await_resume();
+
+  private:
+    /**
+     * @brief ISR attached to the pin while the coroutine waits
+     *
+     * @param arg Pointer to the PinEdge awaiter
+     */
+    static void IsrHandler(void *arg);
+
+    const gpio_num_t pin_;
+    const GpioState state_;
+    const bool inverse_logic_;
+    CoExecutor *executor_;
+    // Address of the waiting coroutine, taken by the first edge
+    std::atomic<void *> waiting_;
+    int64_t timestamp_us_;
+  };
+
+  /**
+   * @brief Auto-reset event coroutines can `co_await`. `Set()` resumes every waiting coroutine or,
+   * if none is waiting, lets the next `co_await` through without suspending.
+   *
+   * @details Can be set from any task or ISR. The waiting coroutines are linked through the
+   * awaiters stored in their frames, so the event needs no storage per waiter.
+   */
+  class AsyncEvent
+  {
+  public:
+    class Awaiter
+    {
+    public:
+      explicit Awaiter(AsyncEvent &event)
+          : event_(event), executor_(nullptr), handle_(nullptr), next_(nullptr)
+      {
+      }
+
+      bool await_ready() const { return false; }
+      bool await_suspend(const CoTask::Handle handle);
+      void await_resume() const {}
+
+    private:
+      friend class AsyncEvent;
+
+      AsyncEvent &event_;
+      CoExecutor *executor_;
+      std::coroutine_handle<> handle_;
+      Awaiter *next_;
+    };
+
+    constexpr AsyncEvent() : waiters_(nullptr), set_(false) {}
+
+    AsyncEvent(const AsyncEvent &) = delete;
+    AsyncEvent &operator=(const AsyncEvent &) = delete;
+
+    /**
+     * @brief Resumes the waiting coroutines, or sets the event if none is waiting
+     */
+    void Set();
+
+    /**
+     * @brief Returns whether the event is set and not yet consumed
+     */
+    bool IsSet() const { return set_; }
+
+    Awaiter operator co_await() { return Awaiter(*this); }
+
+  private:
+    Awaiter *waiters_;
+    volatile bool set_;
+    portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+  };
+
+  /**
+   * @brief Task that runs CoTask coroutines. Every coroutine runs on the stack of the executor
+   * until its next `co_await`, and is resumed by the executor when the awaited Delay expires, the
+   * PinEdge fires or the AsyncEvent is set, so many behaviors written as sequential code share a
+   * single task and stack instead of blocking one task each on `vTaskDelay()`.
+   *
+   * @details Coroutines woken up from other tasks or ISRs are pushed into a lock-free ready queue
+   * and the executor is woken up with a direct-to-task notification. As every live coroutine is
+   * at most once in the queue, ESPTOOLS_CO_MAX_FRAMES entries never overflow. Coroutines must not
+   * block the executor (e.g. with `vTaskDelay()`), as it would delay all of them.
+   */
+  class CoExecutor : public StaticTask<ESPTOOLS_CO_STACK_SIZE>
+  {
+  public:
+    /**
+     * @brief Initializes the executor without creating its task
+     *
+     * @param name Name of the task, must have static storage duration
+     * @param priority Priority of the task
+     * @param core_policy Policy used to choose the core the task is pinned to
+     */
+    CoExecutor(const char *const name = "esptools_co",
+               const UBaseType_t priority = 1,
+               const CorePolicy core_policy = CorePolicy::App);
+
+    ~CoExecutor() override;
+
+    /**
+     * @brief Hands a coroutine to the executor, which starts it at its next iteration. Can be
+     * called before `Start()`.
+     *
+     * @param task Coroutine to run
+     * @return False if the coroutine frame could not be allocated
+     */
+    bool Spawn(CoTask &&task);
+
+    /**
+     * @brief Queues a suspended coroutine to be resumed by the executor. Can be called from any
+     * task or ISR, and is used by the awaitables.
+     *
+     * @param handle Coroutine waiting on an awaitable of this executor
+     */
+    void Schedule(const std::coroutine_handle<> handle);
+
+    /**
+     * @brief Returns the number of coroutines alive on this executor
+     */
+    size_t GetCount() const { return count_.load(std::memory_order_relaxed); }
+
+  protected:
+    void Run() override;
+
+  private:
+    friend class Delay;
+
+    /**
+     * @brief Inserts a Delay in the list of timers, sorted by deadline. Called from the executor.
+     */
+    void AddTimer(Delay &delay);
+
+    /**
+     * @brief Resumes a coroutine, and destroys it if it has returned
+     */
+    void Resume(const std::coroutine_handle<> handle);
+
+    MpscRingBuffer<std::coroutine_handle<>, ESPTOOLS_CO_MAX_FRAMES> ready_;
+    // Delayed coroutines, earliest deadline first. Only accessed by the executor task.
+    Delay *timers_;
+    std::atomic<size_t> count_;
+  };
+
+} // namespace ESPTools
@@ -0,0 +1,363 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/gpio_event.h"
+#include "ESPTools/gpio_input.h"
+#include "ESPTools/gpio_state.h"
+#include "ESPTools/object_pool.h"
+#include "ESPTools/ring_buffer.h"
+
+#include <esp_attr.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Default topics of an EventBus
+   */
+  enum class EventTopic : uint8_t
+  {
+    // Debounced state change of a GpioInput, with a GpioEvent payload
+    GpioStateChange,
+  };
+
+  /**
+   * @brief Publish/subscribe bus that delivers events from any task or ISR to the tasks that
+   * subscribed to their topic. Every event is published once into a slot of an IsrObjectPool and
+   * the subscribers receive a reference to it through their own lock-free queue, so the payload
+   * is never copied after publishing, and no event loop task sits between the publisher and the
+   * subscribers as with `esp_event_post()`.
+   *
+   * @details An event is reference counted: the publisher holds one reference while it pushes a
+   * pointer to the event into the MpscRingBuffer of every matching subscriber, each queued
+   * pointer holds another one, and the slot returns to the pool when the last subscriber releases
+   * it. A subscriber whose queue is full misses the event, which is counted in its dropped
+   * events, and an event published while the pool is exhausted is counted in the bus dropped
+   * events. The subscribed task is woken up with a direct-to-task notification (index 0), so it
+   * must not use that notification for something else.
+   *
+   * Topics are resolved at compile time: each one is a bit of the subscription masks, so a
+   * publisher only tests one bit per subscriber. Subscribers are registered once and stay for
+   * the lifetime of the bus, which must be placed in internal memory (e.g. statically allocated)
+   * when events are published from ISRs.
+   *
+   * @tparam Topic Enumeration of the topics, with values from 0 to 31
+   * @tparam Payload Type of the data of the events. Must be trivially copyable, use a union for
+   * topics with different payloads.
+   * @tparam POOL_SIZE Maximum number of events in flight
+   * @tparam MAX_SUBSCRIBERS Maximum number of subscribers
+   * @tparam QUEUE_SIZE Number of events each subscriber can hold. Must be a power of two.
+   */
+  template <typename Topic = EventTopic,
+            typename Payload = GpioEvent,
+            size_t POOL_SIZE = 16,
+            size_t MAX_SUBSCRIBERS = 8,
+            size_t QUEUE_SIZE = 16>
+  class EventBus
+  {
+    static_assert(std::is_enum_v<Topic>, "EventBus topics must be an enumeration");
+    static_assert(std::is_trivially_copyable_v<Payload>,
+                  "EventBus payloads must be trivially copyable");
+    static_assert(MAX_SUBSCRIBERS > 0, "EventBus needs room for at least one subscriber");
+
+  public:
+    // Bitmask of topics, bit N is the topic of value N
+    using TopicMask = uint32_t;
+
+    /**
+     * @brief Event as stored in the pool and seen by the subscribers
+     */
+    struct Event
+    {
+      Event(const Topic event_topic, const Payload &event_payload)
+          : topic(event_topic), payload(event_payload), references_(1)
+      {
+      }
+
+      const Topic topic;
+      const Payload payload;
+
+    private:
+      friend class EventBus;
+
+      std::atomic<uint32_t> references_;
+    };
+
+    /**
+     * @brief Reference to a received event, releases it when destroyed
+     */
+    class EventRef
+    {
+    public:
+      EventRef() : bus_(nullptr), event_(nullptr) {}
+      EventRef(EventRef &&other) : bus_(other.bus_), event_(std::exchange(other.event_, nullptr))
+      {
+      }
+      ~EventRef() { Reset(); }
+
+      EventRef(const EventRef &) = delete;
+      EventRef &operator=(const EventRef &) = delete;
+
+      EventRef &operator=(EventRef &&other)
+      {
+        if (this != &other)
+        {
+          Reset();
+          bus_ = other.bus_;
+          event_ = std::exchange(other.event_, nullptr);
+        }
+        return *this;
+      }
+
+      /**
+       * @brief Releases the event before the reference is destroyed
+       */
+      void Reset()
+      {
+        if (event_)
+        {
+          bus_->Release(std::exchange(event_, nullptr));
+        }
+      }
+
+      explicit operator bool() const { return event_ != nullptr; }
+      const Event &operator*() const { return *event_; }
+      const Event *operator->() const { return event_; }
+
+    private:
+      friend class EventBus;
+
+      EventRef(EventBus *const bus, Event *const event) : bus_(bus), event_(event) {}
+
+      EventBus *bus_;
+      Event *event_;
+    };
+
+    /**
+     * @brief Queue of the events received by a task. Registered with `Subscribe()`, and must live
+     * as long as the bus.
+     */
+    class Subscriber
+    {
+    public:
+      constexpr Subscriber() : bus_(nullptr), task_(nullptr), topics_(0), dropped_(0), queue_() {}
+
+      Subscriber(const Subscriber &) = delete;
+      Subscriber &operator=(const Subscriber &) = delete;
+
+      /**
+       * @brief Returns the oldest queued event, waiting for one if the queue is empty. Must only
+       * be called from the subscribed task.
+       *
+       * @details A notification does not always come with an event: the events of earlier
+       * notifications may already have been taken by a previous `Receive()` or `Drain()`. The
+       * wait is therefore retried until an event arrives or the timeout really expires.
+       *
+       * @param timeout Maximum time to wait for an event
+       * @return Reference to the event, empty on timeout
+       */
+      EventRef Receive(const TickType_t timeout = portMAX_DELAY)
+      {
+        const TickType_t start{xTaskGetTickCount()};
+        Event *event{nullptr};
+        while (!queue_.Pop(event))
+        {
+          TickType_t remaining{portMAX_DELAY};
+          if (timeout != portMAX_DELAY)
+          {
+            const TickType_t elapsed{xTaskGetTickCount() - start};
+            if (elapsed >= timeout)
+            {
+              return EventRef();
+            }
+            remaining = timeout - elapsed;
+          }
+          ulTaskNotifyTake(pdTRUE, remaining);
+        }
+        return EventRef(bus_, event);
+      }
+
+      /**
+       * @brief Calls `handler` for every queued event and releases them, without waiting. Must
+       * only be called from the subscribed task.
+       *
+       * @tparam Handler Callable with signature `void(const Event &)`
+       * @param handler Function invoked for each event, from the oldest to the newest
+       * @return Number of processed events
+       */
+      template <typename Handler>
+      size_t Drain(Handler &&handler)
+      {
+        return queue_.Drain(
+            [this, &handler](Event *const &event)
+            {
+              handler(static_cast<const Event &>(*event));
+              bus_->Release(event);
+            });
+      }
+
+      /**
+       * @brief Returns the number of events missed because the queue was full
+       */
+      uint32_t GetDropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    private:
+      friend class EventBus;
+
+      EventBus *bus_;
+      TaskHandle_t task_;
+      TopicMask topics_;
+      std::atomic<uint32_t> dropped_;
+      MpscRingBuffer<Event *, QUEUE_SIZE> queue_;
+    };
+
+    constexpr EventBus() : subscribers_(), subscriber_count_(0), dropped_(0), pool_() {}
+
+    EventBus(const EventBus &) = delete;
+    EventBus &operator=(const EventBus &) = delete;
+
+    /**
+     * @brief Returns the mask of a set of topics, checked at compile time
+     */
+    template <Topic... TOPICS>
+    static constexpr TopicMask MaskOf()
+    {
+      static_assert(((static_cast<uint32_t>(TOPICS) < 32) && ...),
+                    "EventBus topics must have values from 0 to 31");
+      return (TopicMask{0} | ... | CreateBitMaskAt<TopicMask>(static_cast<uint8_t>(TOPICS)));
+    }
+
+    /**
+     * @brief Registers a subscriber to a set of topics
+     *
+     * @tparam TOPICS Topics delivered to the subscriber
+     * @param subscriber Queue that receives the events, must not be subscribed yet
+     * @param task Task notified when an event is queued, nullptr for the calling task
+     * @return False if MAX_SUBSCRIBERS are already registered
+     */
+    template <Topic... TOPICS>
+    bool Subscribe(Subscriber &subscriber, const TaskHandle_t task = nullptr)
+    {
+      subscriber.bus_ = this;
+      subscriber.task_ = task ? task : xTaskGetCurrentTaskHandle();
+      subscriber.topics_ = MaskOf<TOPICS...>();
+      portENTER_CRITICAL(&lock_);
+      const size_t count{subscriber_count_.load(std::memory_order_relaxed)};
+      if (count < MAX_SUBSCRIBERS)
+      {
+        subscribers_[count] = &subscriber;
+        subscriber_count_.store(count + 1, std::memory_order_release);
+      }
+      portEXIT_CRITICAL(&lock_);
+      return count < MAX_SUBSCRIBERS;
+    }
+
+    /**
+     * @brief Publishes an event to the subscribers of its topic. Can be called from any task or
+     * ISR.
+     *
+     * @tparam TOPIC Topic of the event
+     * @param payload Data of the event, copied once into the pool
+     * @return False if the pool was exhausted and the event was dropped
+     */
+    template <Topic TOPIC>
+    IRAM_ATTR bool Publish(const Payload &payload)
+    {
+      static constexpr TopicMask MASK{MaskOf<TOPIC>()};
+      Event *const event{pool_.Acquire(TOPIC, payload)};
+      if (!event)
+      {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+
+      const bool in_isr{static_cast<bool>(xPortInIsrContext())};
+      BaseType_t higher_priority_task_woken{pdFALSE};
+      const size_t count{subscriber_count_.load(std::memory_order_acquire)};
+      for (size_t i{0}; i < count; ++i)
+      {
+        Subscriber &subscriber{*subscribers_[i]};
+        if ((subscriber.topics_ & MASK) == 0)
+        {
+          continue;
+        }
+        event->references_.fetch_add(1, std::memory_order_relaxed);
+        if (!subscriber.queue_.Push(event))
+        {
+          event->references_.fetch_sub(1, std::memory_order_relaxed);
+          subscriber.dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (in_isr)
+        {
+          vTaskNotifyGiveFromISR(subscriber.task_, &higher_priority_task_woken);
+        }
+        else
+        {
+          xTaskNotifyGive(subscriber.task_);
+        }
+      }
+      Release(event);
+      if (in_isr)
+      {
+        portYIELD_FROM_ISR(higher_priority_task_woken);
+      }
+      return true;
+    }
+
+    /**
+     * @brief GpioInput callback that publishes its state changes on a topic. The bus is passed
+     * as the callback argument.
+     *
+     * @tparam TOPIC Topic of the events
+     */
+    template <Topic TOPIC>
+    IRAM_ATTR static void PublishGpioInput(GpioInput &input,
+                                           const GpioState state,
+                                           const int64_t timestamp_us,
+                                           void *const bus)
+    {
+      static_assert(std::is_convertible_v<GpioEvent, Payload>,
+                    "The payload must be constructible from a GpioEvent");
+      static_cast<EventBus *>(bus)->template Publish<TOPIC>(
+          GpioEvent{timestamp_us, static_cast<uint8_t>(input.GetPin()), state});
+    }
+
+    /**
+     * @brief Returns the number of events dropped because the pool was exhausted
+     */
+    uint32_t GetDropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Returns the lowest number of free event slots seen. Useful to size POOL_SIZE.
+     */
+    size_t GetMinAvailable() const { return pool_.GetMinAvailable(); }
+
+  private:
+    /**
+     * @brief Drops a reference of an event, and frees it with the last one
+     */
+    IRAM_ATTR void Release(Event *const event)
+    {
+      if (event->references_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      {
+        pool_.Release(event);
+      }
+    }
+
+    Subscriber *subscribers_[MAX_SUBSCRIBERS];
+    std::atomic<size_t> subscriber_count_;
+    std::atomic<uint32_t> dropped_;
+    IsrObjectPool<Event, POOL_SIZE> pool_;
+    // Serializes the subscriptions
+    portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+  };
+
+} // namespace ESPTools
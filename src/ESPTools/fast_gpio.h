@@ -0,0 +1,141 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/gpio_state.h"
+
+#include <driver/gpio.h>
+#include <esp_attr.h>
+#include <soc/gpio_reg.h>
+#include <soc/soc.h>
+#include <soc/soc_caps.h>
+
+#include <cstdint>
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Direct register access to a GPIO whose number is known at compile time. The register
+   * addresses and the bitmask are resolved by the compiler, so every access is a single register
+   * read or write, instead of the argument checks and lookups done by `gpio_get_level()` and
+   * `gpio_set_level()`. Meant for bit-banging and tight sampling loops, including ISRs.
+   *
+   * @details The class is stateless, every method is static. The pin must be configured first,
+   * either with `ConfigureInput()`/`ConfigureOutput()` or with `gpio_config()`.
+   *
+   * @tparam PIN GPIO number
+   * @tparam INVERSE_LOGIC If set to true, the logic of the pin is inverted in both directions
+   * (active low pin), as done by the `inverse_logic` parameter of GpioState
+   */
+  template <gpio_num_t PIN, bool INVERSE_LOGIC = false>
+  class FastGpio
+  {
+    static_assert(GPIO_IS_VALID_GPIO(PIN), "Invalid GPIO number");
+
+  public:
+    // GPIO number of the pin
+    static constexpr gpio_num_t NUM{PIN};
+    // Bitmask of the pin inside its 32-bit registers
+    static constexpr uint32_t MASK{CreateBitMaskAt<uint32_t>(PIN % 32)};
+
+    /**
+     * @brief Configures the pin as an input
+     *
+     * @param pull_mode Pull resistor configuration of the pin
+     */
+    static void ConfigureInput(const gpio_pull_mode_t pull_mode = GPIO_FLOATING)
+    {
+      ESP_ERROR_CHECK(gpio_reset_pin(PIN));
+      ESP_ERROR_CHECK(gpio_set_direction(PIN, GPIO_MODE_INPUT));
+      ESP_ERROR_CHECK(gpio_set_pull_mode(PIN, pull_mode));
+    }
+
+    /**
+     * @brief Configures the pin as an output
+     *
+     * @param initial_state Logical state driven before enabling the output
+     * @param open_drain If set to true, the output is configured as open drain
+     */
+    static void ConfigureOutput(const GpioState initial_state = GpioState::Low,
+                                const bool open_drain = false)
+    {
+      static_assert(GPIO_IS_VALID_OUTPUT_GPIO(PIN), "GPIO cannot be used as an output");
+      ESP_ERROR_CHECK(gpio_reset_pin(PIN));
+      Write(initial_state);
+      // The input stays enabled so Toggle() and Read() keep working on the driven level
+      ESP_ERROR_CHECK(gpio_set_direction(PIN, open_drain ? GPIO_MODE_INPUT_OUTPUT_OD
+                                                         : GPIO_MODE_INPUT_OUTPUT));
+    }
+
+    /**
+     * @brief Reads the level of the pin with a single register access
+     *
+     * @return Logical state of the pin
+     */
+    IRAM_ATTR static GpioState Read()
+    {
+      return GpioState((REG_READ(IN_REG) & MASK) != 0, INVERSE_LOGIC);
+    }
+
+    /**
+     * @brief Drives the pin to the logical High state
+     */
+    IRAM_ATTR static void Set()
+    {
+      REG_WRITE(INVERSE_LOGIC ? OUT_W1TC_REG : OUT_W1TS_REG, MASK);
+    }
+
+    /**
+     * @brief Drives the pin to the logical Low state
+     */
+    IRAM_ATTR static void Clear()
+    {
+      REG_WRITE(INVERSE_LOGIC ? OUT_W1TS_REG : OUT_W1TC_REG, MASK);
+    }
+
+    /**
+     * @brief Drives the pin to the given state. "Undefined" leaves the pin untouched.
+     *
+     * @param state Logical state to drive
+     */
+    IRAM_ATTR static void Write(const GpioState state)
+    {
+      switch (state)
+      {
+      case GpioState::High:
+        Set();
+        break;
+      case GpioState::Low:
+        Clear();
+        break;
+      default:
+        break;
+      }
+    }
+
+    /**
+     * @brief Inverts the driven level. The output latch is read and the opposite level is written
+     * through the W1TS/W1TC registers, so other pins of the bank are never rewritten.
+     */
+    IRAM_ATTR static void Toggle()
+    {
+      REG_WRITE((REG_READ(OUT_REG) & MASK) ? OUT_W1TC_REG : OUT_W1TS_REG, MASK);
+    }
+
+  private:
+    static_assert(SOC_GPIO_PIN_COUNT <= 64, "Unsupported number of GPIOs");
+
+#if SOC_GPIO_PIN_COUNT > 32
+    static constexpr uintptr_t IN_REG{(PIN < 32) ? GPIO_IN_REG : GPIO_IN1_REG};
+    static constexpr uintptr_t OUT_REG{(PIN < 32) ? GPIO_OUT_REG : GPIO_OUT1_REG};
+    static constexpr uintptr_t OUT_W1TS_REG{(PIN < 32) ? GPIO_OUT_W1TS_REG : GPIO_OUT1_W1TS_REG};
+    static constexpr uintptr_t OUT_W1TC_REG{(PIN < 32) ? GPIO_OUT_W1TC_REG : GPIO_OUT1_W1TC_REG};
+#else
+    static constexpr uintptr_t IN_REG{GPIO_IN_REG};
+    static constexpr uintptr_t OUT_REG{GPIO_OUT_REG};
+    static constexpr uintptr_t OUT_W1TS_REG{GPIO_OUT_W1TS_REG};
+    static constexpr uintptr_t OUT_W1TC_REG{GPIO_OUT_W1TC_REG};
+#endif
+  };
+
+} // namespace ESPTools
@@ -0,0 +1,121 @@
+#include "ESPTools/gpio_batch_config.h"
+#include "ESPTools/logger.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include <bit>
+
+namespace ESPTools
+{
+
+  GpioBatchConfig &GpioBatchConfig::Add(const gpio_num_t pin,
+                                        const gpio_mode_t mode,
+                                        const gpio_pull_mode_t pull_mode,
+                                        const gpio_int_type_t intr_type)
+  {
+    ESP_ERROR_CHECK(GPIO_IS_VALID_GPIO(pin) ? ESP_OK : ESP_ERR_INVALID_ARG);
+    const gpio_config_t config{
+        .pin_bit_mask = CreateBitMaskAt<uint64_t>(pin),
+        .mode = mode,
+        .pull_up_en = (pull_mode == GPIO_PULLUP_ONLY || pull_mode == GPIO_PULLUP_PULLDOWN)
+                          ? GPIO_PULLUP_ENABLE
+                          : GPIO_PULLUP_DISABLE,
+        .pull_down_en = (pull_mode == GPIO_PULLDOWN_ONLY || pull_mode == GPIO_PULLUP_PULLDOWN)
+                            ? GPIO_PULLDOWN_ENABLE
+                            : GPIO_PULLDOWN_DISABLE,
+        .intr_type = intr_type,
+    };
+    return Add(config);
+  }
+
+  GpioBatchConfig &GpioBatchConfig::AddOutput(const gpio_num_t pin,
+                                              const GpioState initial_state,
+                                              const bool open_drain)
+  {
+    ESP_ERROR_CHECK(GPIO_IS_VALID_OUTPUT_GPIO(pin) ? ESP_OK : ESP_ERR_INVALID_ARG);
+    outputs_.Set(pin, initial_state);
+    return Add(pin, open_drain ? GPIO_MODE_OUTPUT_OD : GPIO_MODE_OUTPUT);
+  }
+
+  GpioBatchConfig &GpioBatchConfig::Add(const gpio_config_t &config)
+  {
+    const GpioStateSet::Mask mask{config.pin_bit_mask};
+    if ((mask & ~static_cast<GpioStateSet::Mask>(SOC_GPIO_VALID_GPIO_MASK)) || (mask & pins_))
+    {
+      ESPTOOLS_LOGE("Invalid or already added pins 0x%08" PRIx32 "%08" PRIx32,
+                    static_cast<uint32_t>(mask >> 32), static_cast<uint32_t>(mask));
+      ESP_ERROR_CHECK(ESP_ERR_INVALID_ARG);
+    }
+
+    // Merge the pins into the group with the same settings, if there is one
+    for (size_t i{0}; i < group_count_; ++i)
+    {
+      gpio_config_t &group{groups_[i]};
+      if (group.mode == config.mode && group.pull_up_en == config.pull_up_en &&
+          group.pull_down_en == config.pull_down_en && group.intr_type == config.intr_type)
+      {
+        group.pin_bit_mask |= mask;
+        pins_ |= mask;
+        return *this;
+      }
+    }
+    if (group_count_ == ESPTOOLS_GPIO_BATCH_MAX_GROUPS)
+    {
+      ESPTOOLS_LOGE("More than %u pin configurations, increase ESPTOOLS_GPIO_BATCH_MAX_GROUPS",
+                    static_cast<unsigned>(ESPTOOLS_GPIO_BATCH_MAX_GROUPS));
+      ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+    }
+    groups_[group_count_++] = config;
+    pins_ |= mask;
+    return *this;
+  }
+
+  GpioBatchConfig &GpioBatchConfig::AddIsrHandler(const gpio_num_t pin,
+                                                  const gpio_isr_t handler,
+                                                  void *const arg)
+  {
+    ESP_ERROR_CHECK(GPIO_IS_VALID_GPIO(pin) && handler ? ESP_OK : ESP_ERR_INVALID_ARG);
+    isr_pins_ |= CreateBitMaskAt<GpioStateSet::Mask>(pin);
+    handlers_[pin] = handler;
+    args_[pin] = arg;
+    return *this;
+  }
+
+  GpioBatchStats GpioBatchConfig::Apply(const int intr_alloc_flags) const
+  {
+    const int64_t start_us{esp_timer_get_time()};
+
+    // Without this, ESP-IDF prints a line per pin
+    const esp_log_level_t gpio_log_level{esp_log_level_get("gpio")};
+    esp_log_level_set("gpio", ESP_LOG_WARN);
+
+    // Outputs start at their initial level as soon as they are enabled
+    outputs_.WriteOutputs();
+    for (size_t i{0}; i < group_count_; ++i)
+    {
+      ESP_ERROR_CHECK(gpio_config(&groups_[i]));
+    }
+    if (isr_pins_)
+    {
+      InstallIsrService(intr_alloc_flags);
+      for (GpioStateSet::Mask pins{isr_pins_}; pins; pins &= pins - 1)
+      {
+        const int pin{std::countr_zero(pins)};
+        ESP_ERROR_CHECK(gpio_isr_handler_add(static_cast<gpio_num_t>(pin), handlers_[pin],
+                                             args_[pin]));
+      }
+    }
+
+    esp_log_level_set("gpio", gpio_log_level);
+
+    const GpioBatchStats stats{static_cast<uint8_t>(std::popcount(pins_)),
+                               static_cast<uint8_t>(group_count_),
+                               static_cast<uint8_t>(std::popcount(isr_pins_)),
+                               static_cast<uint32_t>(esp_timer_get_time() - start_us)};
+    ESPTOOLS_LOGI("%u pins configured with %u calls, %u ISR handlers, in %" PRIu32 " us",
+                  stats.pins, stats.groups, stats.handlers, stats.elapsed_us);
+    return stats;
+  }
+
+} // namespace ESPTools
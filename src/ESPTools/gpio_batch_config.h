@@ -0,0 +1,173 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/gpio_state.h"
+#include "ESPTools/gpio_state_set.h"
+#include "ESPTools/logger.h"
+
+#include <driver/gpio.h>
+#include <soc/soc_caps.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Compile-time log level of the GpioBatchConfig module
+#ifndef ESPTOOLS_LOG_LEVEL_GPIO_BATCH_CONFIG
+#define ESPTOOLS_LOG_LEVEL_GPIO_BATCH_CONFIG ESPTOOLS_LOG_LEVEL
+#endif
+
+// Maximum number of distinct pin configurations of a GpioBatchConfig
+#ifndef ESPTOOLS_GPIO_BATCH_MAX_GROUPS
+#define ESPTOOLS_GPIO_BATCH_MAX_GROUPS 8
+#endif
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Summary of a `GpioBatchConfig::Apply()` call
+   */
+  struct GpioBatchStats
+  {
+    // Number of configured pins
+    uint8_t pins;
+    // Number of `gpio_config()` calls
+    uint8_t groups;
+    // Number of registered ISR handlers
+    uint8_t handlers;
+    // Time spent applying the configuration
+    uint32_t elapsed_us;
+  };
+
+  /**
+   * @brief Builder for the configuration of many pins at boot. The pins are merged into groups
+   * with the same mode, pulls and interrupt type, and each group is applied with a single
+   * `gpio_config()` call on its 64-bit mask, instead of one call (or three) per pin. The ISR
+   * handlers are registered in one pass, after a single `InstallIsrService()` call.
+   *
+   * @details `Apply()` works in this order: the initial levels of all the outputs are written at
+   * once through GpioStateSet, so no output glitches when it is enabled, then the groups are
+   * configured, and finally the handlers are added. The "gpio" tag of ESP-IDF, which logs a line
+   * per configured pin, is lowered to warnings during the call, as printing those lines takes
+   * longer than the configuration itself.
+   *
+   * Pins are validated when they are added: an invalid pin, a pin added twice or too many groups
+   * abort through `ESP_ERROR_CHECK`, like the configuration errors of ESP-IDF. The BoardPins
+   * groups (see board_pins.h), which are validated at compile time, can be added as a whole.
+   *
+   * @code
+   * ESPTools::GpioBatchConfig batch;
+   * batch.AddInput(GPIO_NUM_2, GPIO_PULLUP_ONLY, GPIO_INTR_NEGEDGE)
+   *     .AddIsrHandler(GPIO_NUM_2, OnButton, nullptr)
+   *     .AddOutput(GPIO_NUM_5, ESPTools::GpioState::High);
+   * batch.Apply(ESP_INTR_FLAG_IRAM);
+   * @endcode
+   */
+  class GpioBatchConfig
+  {
+  public:
+    constexpr GpioBatchConfig()
+        : groups_(), group_count_(0), pins_(0), outputs_(), isr_pins_(0), handlers_(), args_()
+    {
+    }
+
+    /**
+     * @brief Adds a pin
+     *
+     * @param pin GPIO number
+     * @param mode Mode of the pin
+     * @param pull_mode Pull resistor configuration of the pin
+     * @param intr_type Interrupt type of the pin
+     */
+    GpioBatchConfig &Add(const gpio_num_t pin,
+                         const gpio_mode_t mode,
+                         const gpio_pull_mode_t pull_mode = GPIO_FLOATING,
+                         const gpio_int_type_t intr_type = GPIO_INTR_DISABLE);
+
+    /**
+     * @brief Adds an input pin
+     *
+     * @param pin GPIO number
+     * @param pull_mode Pull resistor configuration of the pin
+     * @param intr_type Interrupt type of the pin
+     */
+    GpioBatchConfig &AddInput(const gpio_num_t pin,
+                              const gpio_pull_mode_t pull_mode = GPIO_FLOATING,
+                              const gpio_int_type_t intr_type = GPIO_INTR_DISABLE)
+    {
+      return Add(pin, GPIO_MODE_INPUT, pull_mode, intr_type);
+    }
+
+    /**
+     * @brief Adds an output pin, driven to its initial level before the output is enabled
+     *
+     * @param pin GPIO number
+     * @param initial_state Physical level driven at startup
+     * @param open_drain If set to true, the output is configured as open drain
+     */
+    GpioBatchConfig &AddOutput(const gpio_num_t pin,
+                               const GpioState initial_state = GpioState::Low,
+                               const bool open_drain = false);
+
+    /**
+     * @brief Adds a set of pins sharing the same configuration
+     *
+     * @param config Configuration of the pins, `pin_bit_mask` selects the pins
+     */
+    GpioBatchConfig &Add(const gpio_config_t &config);
+
+    /**
+     * @brief Adds a BoardPins group, whose pins have been validated at compile time
+     *
+     * @tparam GROUP BoardPins::Group type
+     */
+    template <typename GROUP>
+    GpioBatchConfig &Add() { return Add(GROUP::CONFIG); }
+
+    /**
+     * @brief Registers an ISR handler for a pin, added with `gpio_isr_handler_add()` by `Apply()`
+     *
+     * @param pin GPIO number, which must also be added with an interrupt type
+     * @param handler ISR handler
+     * @param arg Argument of the handler
+     */
+    GpioBatchConfig &AddIsrHandler(const gpio_num_t pin, const gpio_isr_t handler, void *const arg);
+
+    /**
+     * @brief Configures all the pins and registers the ISR handlers
+     *
+     * @param intr_alloc_flags Flags forwarded to `InstallIsrService` if there are ISR handlers
+     * @return Summary with the time spent
+     */
+    GpioBatchStats Apply(const int intr_alloc_flags = 0) const;
+
+    /**
+     * @brief Returns the mask of the added pins
+     */
+    constexpr GpioStateSet::Mask GetPins() const { return pins_; }
+
+    /**
+     * @brief Returns the number of `gpio_config()` calls done by `Apply()`
+     */
+    constexpr size_t GetGroupCount() const { return group_count_; }
+
+  private:
+    // Tag used for the logging system
+    static constexpr char LOG_TAG[]{ESPTOOLS_LOG_TAG_CREATOR("GpioBatchConfig")};
+    // Compile-time log level of the module
+    static constexpr esp_log_level_t LOG_LEVEL{ESPTOOLS_LOG_LEVEL_GPIO_BATCH_CONFIG};
+
+    // Configuration of each group, with the pins of the group in `pin_bit_mask`
+    gpio_config_t groups_[ESPTOOLS_GPIO_BATCH_MAX_GROUPS];
+    size_t group_count_;
+    // Pins added to any group
+    GpioStateSet::Mask pins_;
+    // Initial levels of the outputs
+    GpioStateSet outputs_;
+    // Pins with an ISR handler
+    GpioStateSet::Mask isr_pins_;
+    gpio_isr_t handlers_[SOC_GPIO_PIN_COUNT];
+    void *args_[SOC_GPIO_PIN_COUNT];
+  };
+
+} // namespace ESPTools
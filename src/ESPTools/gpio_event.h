@@ -0,0 +1,25 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/gpio_state.h"
+
+#include <cstdint>
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Edge event of a GPIO, as produced from a pin ISR. Kept small and trivially copyable
+   * so it can be passed through an `SpscRingBuffer` without any allocation.
+   */
+  struct GpioEvent
+  {
+    // Time of the edge as returned by `esp_timer_get_time()`
+    int64_t timestamp_us;
+    // GPIO number of the pin
+    uint8_t pin;
+    // State of the pin after the edge
+    GpioState state;
+  };
+
+} // namespace ESPTools
@@ -0,0 +1,121 @@
+#include "ESPTools/gpio_input.h"
+#include "ESPTools/logger.h"
+
+#include <esp_attr.h>
+#include <esp_timer.h>
+
+namespace ESPTools
+{
+
+  GpioInput::GpioInput(const gpio_num_t pin,
+                       const bool inverse_logic,
+                       const uint32_t debounce_us,
+                       const gpio_pull_mode_t pull_mode,
+                       const Callback callback,
+                       void *const callback_arg,
+                       const int intr_alloc_flags)
+      : pin_(pin),
+        inverse_logic_(inverse_logic),
+        debounce_us_(debounce_us),
+        callback_(callback),
+        callback_arg_(callback_arg),
+        state_(),
+        transitions_(0),
+        last_change_us_(0),
+        settle_timer_(nullptr)
+  {
+    // Configure the pin as an input generating interrupts on both edges
+    const gpio_config_t config{
+        .pin_bit_mask = CreateBitMaskAt<uint64_t>(pin_),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = (pull_mode == GPIO_PULLUP_ONLY || pull_mode == GPIO_PULLUP_PULLDOWN)
+                          ? GPIO_PULLUP_ENABLE
+                          : GPIO_PULLUP_DISABLE,
+        .pull_down_en = (pull_mode == GPIO_PULLDOWN_ONLY || pull_mode == GPIO_PULLUP_PULLDOWN)
+                            ? GPIO_PULLDOWN_ENABLE
+                            : GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_ANYEDGE,
+    };
+    ESP_ERROR_CHECK(gpio_config(&config));
+
+    // Read the initial state before enabling the ISR so the first edge is compared against it
+    state_.store(GpioState(gpio_get_level(pin_), inverse_logic_), std::memory_order_relaxed);
+    // The window starts elapsed, so the first edge is accepted at once
+    last_change_us_ = esp_timer_get_time() - debounce_us_;
+
+    if (debounce_us_ > 0)
+    {
+      const esp_timer_create_args_t args{
+          .callback = SettleHandler,
+          .arg = this,
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+          .dispatch_method = ESP_TIMER_ISR,
+#else
+          .dispatch_method = ESP_TIMER_TASK,
+#endif
+          .name = "esptools_debounce",
+          .skip_unhandled_events = true,
+      };
+      ESP_ERROR_CHECK(esp_timer_create(&args, &settle_timer_));
+    }
+
+    InstallIsrService(intr_alloc_flags);
+    ESP_ERROR_CHECK(gpio_isr_handler_add(pin_, IsrHandler, this));
+
+    ESPTOOLS_LOGD("GPIO %d configured as input (initial state %s, debounce %" PRIu32 " us)",
+                  pin_, GetState().ToStr(), debounce_us);
+  }
+
+  GpioInput::~GpioInput()
+  {
+    ESP_ERROR_CHECK(gpio_intr_disable(pin_));
+    ESP_ERROR_CHECK(gpio_isr_handler_remove(pin_));
+    if (settle_timer_)
+    {
+      // Fails harmlessly if the timer is not armed
+      esp_timer_stop(settle_timer_);
+      ESP_ERROR_CHECK(esp_timer_delete(settle_timer_));
+    }
+  }
+
+  void IRAM_ATTR GpioInput::IsrHandler(void *arg) { static_cast<GpioInput *>(arg)->Sample(false); }
+
+  void IRAM_ATTR GpioInput::SettleHandler(void *arg)
+  {
+    static_cast<GpioInput *>(arg)->Sample(true);
+  }
+
+  void IRAM_ATTR GpioInput::Sample(const bool settled)
+  {
+    portENTER_CRITICAL_SAFE(&lock_);
+    const int64_t now_us{esp_timer_get_time()};
+    const GpioState state(gpio_get_level(pin_), inverse_logic_);
+
+    // Discard edges that do not change the state or that fall within the debounce window
+    if (state == state_.load(std::memory_order_relaxed) ||
+        (!settled && now_us - last_change_us_ < debounce_us_))
+    {
+      portEXIT_CRITICAL_SAFE(&lock_);
+      return;
+    }
+
+    last_change_us_ = now_us;
+    state_.store(state, std::memory_order_relaxed);
+    // Sample() is the only writer, so a load/store pair avoids an atomic read-modify-write
+    transitions_.store(transitions_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    portEXIT_CRITICAL_SAFE(&lock_);
+
+    if (settle_timer_)
+    {
+      // Restart the window, the timer may still be armed if it has not fired yet
+      esp_timer_stop(settle_timer_);
+      esp_timer_start_once(settle_timer_, static_cast<uint64_t>(debounce_us_));
+    }
+
+    if (callback_)
+    {
+      callback_(*this, state, now_us, callback_arg_);
+    }
+  }
+
+} // namespace ESPTools
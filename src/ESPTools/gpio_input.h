@@ -0,0 +1,146 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/gpio_state.h"
+#include "ESPTools/logger.h"
+
+#include <driver/gpio.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+
+#include <atomic>
+#include <cstdint>
+
+// Compile-time log level of the GpioInput module
+#ifndef ESPTOOLS_LOG_LEVEL_GPIO_INPUT
+#define ESPTOOLS_LOG_LEVEL_GPIO_INPUT ESPTOOLS_LOG_LEVEL
+#endif
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Interrupt driven and debounced GPIO input. The pin is sampled inside its own ISR
+   * (registered through `InstallIsrService`) on every edge, and the bouncing is filtered out by
+   * comparing `esp_timer` timestamps instead of polling the pin with `vTaskDelay`. No heap
+   * memory is used, so the object can be statically allocated.
+   *
+   * @details An edge is accepted when the level read in the ISR differs from the current state
+   * and at least `debounce_us` microseconds have elapsed since the last accepted transition.
+   * Every accepted transition also arms a one-shot esp_timer for the debounce window, which
+   * samples the pin again when the window ends: a real change whose edge was discarded inside the
+   * window (e.g. a release shortly after a press) is then accepted, with the time of the
+   * re-sample as its timestamp, instead of being lost until the next edge.
+   * The object registers `this` as the ISR argument, so it can be neither copied nor moved.
+   */
+  class GpioInput
+  {
+  public:
+    /**
+     * @brief Callback invoked from the ISR every time the debounced state changes. As it runs in
+     * interrupt context it must be short and must not block. If the ISR service has been
+     * installed with `ESP_INTR_FLAG_IRAM` the callback must be placed in IRAM (`IRAM_ATTR`).
+     * Transitions found by the re-sample at the end of the debounce window are reported from the
+     * esp_timer ISR with CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD, and from the esp_timer
+     * task otherwise.
+     *
+     * @param input GpioInput object whose state has changed
+     * @param state New debounced state of the input
+     * @param timestamp_us Time of the transition as returned by `esp_timer_get_time()`
+     * @param arg User argument provided when constructing the GpioInput
+     */
+    using Callback = void (*)(GpioInput &input, GpioState state, int64_t timestamp_us, void *arg);
+
+    // Default debounce window for mechanical contacts
+    static constexpr uint32_t DEFAULT_DEBOUNCE_US{5000};
+
+    /**
+     * @brief Configures the pin as an input, reads its initial state and registers the ISR
+     *
+     * @param pin GPIO number of the input
+     * @param inverse_logic If set to true, the read level will be inverted (active low input)
+     * @param debounce_us Minimum time in microseconds between two accepted transitions. Use 0 to
+     * disable debouncing
+     * @param pull_mode Pull resistor configuration of the pin
+     * @param callback Optional function called from the ISR on every debounced transition
+     * @param callback_arg User argument forwarded to the callback
+     * @param intr_alloc_flags Flags forwarded to `InstallIsrService` in case it has not been
+     * installed yet
+     */
+    GpioInput(const gpio_num_t pin,
+              const bool inverse_logic = false,
+              const uint32_t debounce_us = DEFAULT_DEBOUNCE_US,
+              const gpio_pull_mode_t pull_mode = GPIO_FLOATING,
+              const Callback callback = nullptr,
+              void *const callback_arg = nullptr,
+              const int intr_alloc_flags = 0);
+
+    /**
+     * @brief Disables the interrupt of the pin, removes its ISR handler and deletes the debounce
+     * timer
+     */
+    ~GpioInput();
+
+    GpioInput(const GpioInput &) = delete;
+    GpioInput &operator=(const GpioInput &) = delete;
+
+    /**
+     * @brief Returns the GPIO number of the input
+     */
+    gpio_num_t GetPin() const { return pin_; }
+
+    /**
+     * @brief Returns the last debounced state of the input. It does not access the hardware.
+     */
+    GpioState GetState() const { return state_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Returns the number of debounced transitions since the object was created
+     */
+    uint32_t GetTransitionCount() const { return transitions_.load(std::memory_order_relaxed); }
+
+  private:
+    // Tag used for the logging system
+    static constexpr char LOG_TAG[]{ESPTOOLS_LOG_TAG_CREATOR("GpioInput")};
+    // Compile-time log level of the module
+    static constexpr esp_log_level_t LOG_LEVEL{ESPTOOLS_LOG_LEVEL_GPIO_INPUT};
+
+    /**
+     * @brief ISR attached to the pin. Samples and debounces the input.
+     *
+     * @param arg Pointer to the GpioInput object owning the pin
+     */
+    static void IsrHandler(void *arg);
+
+    /**
+     * @brief Callback of the debounce timer. Samples the input again at the end of the window.
+     *
+     * @param arg Pointer to the GpioInput object owning the pin
+     */
+    static void SettleHandler(void *arg);
+
+    /**
+     * @brief Samples the pin and accepts the new state if it changed
+     *
+     * @param settled True when called at the end of the debounce window, which accepts the change
+     * without checking the window again
+     */
+    void Sample(const bool settled);
+
+    const gpio_num_t pin_;
+    const bool inverse_logic_;
+    const int64_t debounce_us_;
+    const Callback callback_;
+    void *const callback_arg_;
+
+    std::atomic<GpioState> state_;
+    std::atomic<uint32_t> transitions_;
+    // Only accessed by Sample(), the timestamps are forwarded through the callback
+    int64_t last_change_us_;
+    // One-shot timer ending the debounce window, nullptr if debouncing is disabled
+    esp_timer_handle_t settle_timer_;
+    // Serializes the edge ISR and the timer callback, which may run on different cores
+    portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+  };
+
+} // namespace ESPTools
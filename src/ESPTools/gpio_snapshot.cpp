@@ -0,0 +1,150 @@
+#include "ESPTools/gpio_snapshot.h"
+
+#include <driver/gpio.h>
+#include <esp_attr.h>
+#include <esp_rom_gpio.h>
+#include <soc/gpio_reg.h>
+#include <soc/gpio_sig_map.h>
+#include <soc/soc.h>
+#include <soc/soc_caps.h>
+
+#include <bit>
+#include <cstdint>
+
+#if SOC_RTC_SLOW_MEM_SUPPORTED
+#define ESPTOOLS_GPIO_SNAPSHOT_ATTR RTC_NOINIT_ATTR
+#else
+#define ESPTOOLS_GPIO_SNAPSHOT_ATTR __NOINIT_ATTR
+#endif
+
+namespace ESPTools
+{
+
+  namespace
+  {
+    // Marks a snapshot that holds valid data
+    constexpr uint32_t MAGIC{0x4750534e};
+
+    /**
+     * @brief Content kept across resets
+     */
+    struct Snapshot
+    {
+      uint32_t magic;
+      // Detects a snapshot corrupted or never written after a power-on
+      uint32_t check;
+      // Logical levels and defined pins of the saved GpioStateSet
+      GpioStateSet::Mask levels;
+      GpioStateSet::Mask defined;
+      GpioStateSet::Mask inverse;
+    };
+
+    ESPTOOLS_GPIO_SNAPSHOT_ATTR Snapshot snapshot;
+
+    uint32_t Fold(const GpioStateSet::Mask mask)
+    {
+      return static_cast<uint32_t>(mask) ^ static_cast<uint32_t>(mask >> 32);
+    }
+
+    uint32_t ComputeCheck()
+    {
+      return ~(Fold(snapshot.levels) ^ std::rotl(Fold(snapshot.defined), 11) ^
+               std::rotl(Fold(snapshot.inverse), 22));
+    }
+
+    bool IsValid() { return snapshot.magic == MAGIC && snapshot.check == ComputeCheck(); }
+
+    /**
+     * @brief Returns the saved pins that can be driven by this chip
+     */
+    GpioStateSet::Mask GetOutputPins()
+    {
+      return snapshot.defined & SOC_GPIO_VALID_OUTPUT_GPIO_MASK;
+    }
+  } // namespace
+
+  void GpioSnapshot::Save(const GpioStateSet &outputs, const GpioStateSet::Mask inverse_mask)
+  {
+    snapshot.levels = outputs.GetLevels();
+    snapshot.defined = outputs.GetDefined();
+    snapshot.inverse = inverse_mask & outputs.GetDefined();
+    snapshot.check = ComputeCheck();
+    snapshot.magic = MAGIC;
+  }
+
+  void GpioSnapshot::Hold()
+  {
+    if (!IsValid())
+    {
+      return;
+    }
+    for (GpioStateSet::Mask pins{GetOutputPins()}; pins != 0; pins &= pins - 1)
+    {
+      ESP_ERROR_CHECK(gpio_hold_en(static_cast<gpio_num_t>(std::countr_zero(pins))));
+    }
+    gpio_deep_sleep_hold_en();
+  }
+
+  GpioStateSet::Mask GpioSnapshot::Restore()
+  {
+    if (!IsValid())
+    {
+      return 0;
+    }
+    const GpioStateSet::Mask pins{GetOutputPins()};
+    // Levels first, so the outputs are enabled with their final value
+    GpioStateSet(snapshot.levels, pins).ApplyInverseLogic(snapshot.inverse).WriteOutputs();
+    for (GpioStateSet::Mask remaining{pins}; remaining != 0; remaining &= remaining - 1)
+    {
+      const uint32_t pin{static_cast<uint32_t>(std::countr_zero(remaining))};
+      esp_rom_gpio_pad_select_gpio(pin);
+      esp_rom_gpio_connect_out_signal(pin, SIG_GPIO_OUT_IDX, false, false);
+    }
+    REG_WRITE(GPIO_ENABLE_W1TS_REG, static_cast<uint32_t>(pins));
+#if SOC_GPIO_PIN_COUNT > 32
+    if (pins >> 32)
+    {
+      REG_WRITE(GPIO_ENABLE1_W1TS_REG, static_cast<uint32_t>(pins >> 32));
+    }
+#endif
+
+    // The pads now output the registers, which match the held levels
+    Release(pins);
+    return pins;
+  }
+
+  void GpioSnapshot::Release(const GpioStateSet::Mask pins)
+  {
+    gpio_deep_sleep_hold_dis();
+    for (GpioStateSet::Mask remaining{pins & SOC_GPIO_VALID_OUTPUT_GPIO_MASK}; remaining != 0;
+         remaining &= remaining - 1)
+    {
+      gpio_hold_dis(static_cast<gpio_num_t>(std::countr_zero(remaining)));
+    }
+  }
+
+  bool GpioSnapshot::Load(GpioStateSet &outputs, GpioStateSet::Mask &inverse_mask)
+  {
+    if (!IsValid())
+    {
+      return false;
+    }
+    outputs = GpioStateSet(snapshot.levels, snapshot.defined);
+    inverse_mask = snapshot.inverse;
+    return true;
+  }
+
+  void GpioSnapshot::Clear() { snapshot.magic = 0; }
+
+#ifdef ESPTOOLS_GPIO_SNAPSHOT_EARLY_RESTORE
+  namespace
+  {
+    /**
+     * @brief Restores the outputs before the C++ constructors of default priority and the
+     * scheduler start
+     */
+    [[gnu::constructor(101)]] void RestoreAtBoot() { GpioSnapshot::Restore(); }
+  } // namespace
+#endif
+
+} // namespace ESPTools
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/gpio_state_set.h"
+
+#include <cstdint>
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Output states kept across resets and deep sleep, so they can be driven again at boot
+   * without a glitch. `Save()` stores the logical states of a GpioStateSet of outputs and their
+   * inverse logic mask in memory that is not initialized at boot, `Hold()` latches the pads with
+   * `gpio_hold_en()`, and `Restore()` writes the saved levels back and releases the pads.
+   *
+   * @details `Restore()` only writes registers: it routes the pins to the GPIO matrix with two ROM
+   * calls per pin, drives all the levels at once through the W1TS/W1TC registers, enables the
+   * outputs and then releases the holds, so the pads never leave their held level. Defining
+   * `ESPTOOLS_GPIO_SNAPSHOT_EARLY_RESTORE` makes it run from a static constructor, before the
+   * scheduler starts and before `app_main()`. Drive strength, open drain and pull resistors are
+   * not saved, and keep their reset configuration until the pins are configured again.
+   *
+   * The snapshot is placed in the RTC slow memory on the chips that have it, which keeps it across
+   * deep sleep, and in the `.noinit` section of the internal RAM otherwise, which only keeps it
+   * across software, panic and watchdog resets. On the chips without RTC memory (ESP32-C2) the
+   * pads still stay held through deep sleep, but `Restore()` finds no snapshot after it: the pins
+   * must then be configured and driven by the application, and released with `Release()`.
+   */
+  class GpioSnapshot
+  {
+  public:
+    /**
+     * @brief Stores the states of a set of outputs, replacing the previous snapshot
+     *
+     * @param outputs Logical states of the outputs, the undefined pins are not saved
+     * @param inverse_mask Bitmask of the pins with inverse logic
+     */
+    static void Save(const GpioStateSet &outputs, const GpioStateSet::Mask inverse_mask = 0);
+
+    /**
+     * @brief Holds the pads of the saved outputs at their current level, also during deep sleep
+     */
+    static void Hold();
+
+    /**
+     * @brief Drives the saved outputs again and releases their holds. Does nothing if there is no
+     * valid snapshot.
+     *
+     * @return Bitmask of the restored pins, 0 if there is no valid snapshot
+     */
+    static GpioStateSet::Mask Restore();
+
+    /**
+     * @brief Releases the holds of pads, after the pins have been configured and driven without
+     * the snapshot. Also disables the hold of the pads during deep sleep, for every pin.
+     *
+     * @param pins Bitmask of the pins to release
+     */
+    static void Release(const GpioStateSet::Mask pins);
+
+    /**
+     * @brief Returns the saved snapshot
+     *
+     * @param outputs Logical states of the saved outputs
+     * @param inverse_mask Bitmask of the saved pins with inverse logic
+     * @return False if there is no valid snapshot
+     */
+    static bool Load(GpioStateSet &outputs, GpioStateSet::Mask &inverse_mask);
+
+    /**
+     * @brief Invalidates the snapshot. The holds of the pads are not released.
+     */
+    static void Clear();
+  };
+
+} // namespace ESPTools
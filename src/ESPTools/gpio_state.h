@@ -23,6 +23,12 @@ namespace ESPTools
      */
     constexpr GpioState() : value_(Value::Undefined) {}
 
+    /**
+     * @brief Initializes the state from one of its values, so "Undefined" is kept instead of
+     * being read as a true level by the constructor below
+     */
+    constexpr GpioState(const Value value) : value_(value) {}
+
     /**
      * @brief Allows direct initialization from functions such as `gpio_get_level()`
      *
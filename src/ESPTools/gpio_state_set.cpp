@@ -0,0 +1,40 @@
+#include "ESPTools/gpio_state_set.h"
+
+#include <esp_attr.h>
+#include <soc/gpio_reg.h>
+#include <soc/soc.h>
+#include <soc/soc_caps.h>
+
+namespace ESPTools
+{
+
+  GpioStateSet IRAM_ATTR GpioStateSet::ReadInputs(const Mask pins)
+  {
+    const Mask valid_pins{pins & SOC_GPIO_VALID_GPIO_MASK};
+    Mask levels{REG_READ(GPIO_IN_REG)};
+#if SOC_GPIO_PIN_COUNT > 32
+    // Upper pins are only read when requested
+    if (valid_pins >> 32)
+    {
+      levels |= static_cast<Mask>(REG_READ(GPIO_IN1_REG)) << 32;
+    }
+#endif
+    return GpioStateSet(levels, valid_pins);
+  }
+
+  void IRAM_ATTR GpioStateSet::WriteOutputs() const
+  {
+    const Mask high{GetHigh() & SOC_GPIO_VALID_OUTPUT_GPIO_MASK};
+    const Mask low{GetLow() & SOC_GPIO_VALID_OUTPUT_GPIO_MASK};
+    REG_WRITE(GPIO_OUT_W1TS_REG, static_cast<uint32_t>(high));
+    REG_WRITE(GPIO_OUT_W1TC_REG, static_cast<uint32_t>(low));
+#if SOC_GPIO_PIN_COUNT > 32
+    if ((high | low) >> 32)
+    {
+      REG_WRITE(GPIO_OUT1_W1TS_REG, static_cast<uint32_t>(high >> 32));
+      REG_WRITE(GPIO_OUT1_W1TC_REG, static_cast<uint32_t>(low >> 32));
+    }
+#endif
+  }
+
+} // namespace ESPTools
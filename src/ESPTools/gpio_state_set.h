@@ -0,0 +1,168 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/gpio_state.h"
+
+#include <bit>
+#include <cstdint>
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Packed set of GpioState values, one per GPIO. The levels and the "defined" flags are
+   * kept as two parallel bitmasks (bit N corresponds to GPIO N), so operations on the whole set
+   * are a handful of bitwise instructions instead of a loop over the pins.
+   *
+   * @details The levels of the undefined pins are always kept cleared, which allows comparing
+   * and counting sets without masking them first.
+   */
+  class GpioStateSet
+  {
+  public:
+    using Mask = uint64_t;
+
+    /**
+     * @brief Initializes every pin to "Undefined"
+     */
+    constexpr GpioStateSet() : levels_(0), defined_(0) {}
+
+    /**
+     * @brief Initializes the set from raw bitmasks
+     *
+     * @param levels Bitmask with the level of each pin (1 High, 0 Low)
+     * @param defined Bitmask of the pins whose state is defined. The rest are "Undefined".
+     */
+    constexpr GpioStateSet(const Mask levels, const Mask defined)
+        : levels_(levels & defined), defined_(defined)
+    {
+    }
+
+    /**
+     * @brief Reads the input level of the whole bank with a single register access per 32 pins
+     * (one on the ESP32-C2), instead of one `gpio_get_level()` call per pin. Can be called from
+     * an ISR.
+     *
+     * @param pins Bitmask of the pins to read. Invalid pins of the chip are ignored and left
+     * "Undefined".
+     * @return Set with the read pins defined
+     */
+    static GpioStateSet ReadInputs(const Mask pins = ~Mask{0});
+
+    /**
+     * @brief Drives the defined pins of the set through the W1TS/W1TC output registers, so all of
+     * them change at the same time. Undefined pins are left untouched. Pins must already be
+     * configured as outputs. Can be called from an ISR.
+     */
+    void WriteOutputs() const;
+
+    /**
+     * @brief Returns the state of a single pin
+     *
+     * @param pin GPIO number
+     */
+    constexpr GpioState Get(const uint8_t pin) const
+    {
+      const Mask mask{CreateBitMaskAt<Mask>(pin)};
+      return (defined_ & mask) ? GpioState((levels_ & mask) != 0) : GpioState();
+    }
+
+    /**
+     * @brief Sets the state of a single pin
+     *
+     * @param pin GPIO number
+     * @param state New state of the pin
+     */
+    constexpr void Set(const uint8_t pin, const GpioState state)
+    {
+      const Mask mask{CreateBitMaskAt<Mask>(pin)};
+      switch (state)
+      {
+      case GpioState::High:
+        levels_ |= mask;
+        defined_ |= mask;
+        break;
+      case GpioState::Low:
+        levels_ &= ~mask;
+        defined_ |= mask;
+        break;
+      default:
+        levels_ &= ~mask;
+        defined_ &= ~mask;
+        break;
+      }
+    }
+
+    /**
+     * @brief Returns the raw level bitmask. Undefined pins read as 0.
+     */
+    constexpr Mask GetLevels() const { return levels_; }
+
+    /**
+     * @brief Returns the bitmask of the pins whose state is defined
+     */
+    constexpr Mask GetDefined() const { return defined_; }
+
+    /**
+     * @brief Returns the bitmask of the pins that are High
+     */
+    constexpr Mask GetHigh() const { return levels_; }
+
+    /**
+     * @brief Returns the bitmask of the pins that are Low
+     */
+    constexpr Mask GetLow() const { return defined_ & ~levels_; }
+
+    /**
+     * @brief Returns the number of pins that are High
+     */
+    constexpr int CountHigh() const { return std::popcount(levels_); }
+
+    /**
+     * @brief Returns the number of pins that are Low
+     */
+    constexpr int CountLow() const { return std::popcount(GetLow()); }
+
+    /**
+     * @brief Returns the bitmask of the pins whose state differs between both sets. A pin going
+     * from or to "Undefined" is also reported. When both sets define the same pins this is a
+     * single XOR of the levels.
+     *
+     * @param other Set to compare with
+     */
+    constexpr Mask Changed(const GpioStateSet &other) const
+    {
+      return (levels_ ^ other.levels_) | (defined_ ^ other.defined_);
+    }
+
+    /**
+     * @brief Inverts the logic of several pins at once, the same way the `inverse_logic`
+     * parameter of the GpioState constructor does for a single pin. Undefined pins remain
+     * "Undefined".
+     *
+     * @param inverse_mask Bitmask of the pins with inverse logic
+     * @return A new set with the selected pins inverted
+     */
+    constexpr GpioStateSet ApplyInverseLogic(const Mask inverse_mask) const
+    {
+      return GpioStateSet(levels_ ^ inverse_mask, defined_);
+    }
+
+    /**
+     * @brief Returns a subset with only the selected pins defined
+     *
+     * @param pins Bitmask of the pins to keep
+     */
+    constexpr GpioStateSet Select(const Mask pins) const
+    {
+      return GpioStateSet(levels_, defined_ & pins);
+    }
+
+    constexpr bool operator==(const GpioStateSet &other) const = default;
+
+  private:
+    Mask levels_;
+    Mask defined_;
+  };
+
+} // namespace ESPTools
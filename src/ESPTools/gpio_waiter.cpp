@@ -0,0 +1,206 @@
+#include "ESPTools/gpio_waiter.h"
+#include "ESPTools/logger.h"
+
+#include <esp_attr.h>
+#include <freertos/timers.h>
+
+namespace ESPTools
+{
+
+  GpioWaiter::GpioWaiter()
+      : event_group_buffer_(),
+        event_group_(xEventGroupCreateStatic(&event_group_buffer_)),
+        pins_(),
+        pin_count_(0),
+        resync_timer_(nullptr),
+        dropped_updates_(0)
+  {
+    const esp_timer_create_args_t args{
+        .callback = ResyncTimerHandler,
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "esptools_waiter",
+        .skip_unhandled_events = true,
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&args, &resync_timer_));
+  }
+
+  GpioWaiter::~GpioWaiter()
+  {
+    const size_t pin_count{pin_count_.load(std::memory_order_relaxed)};
+    for (size_t i{0}; i < pin_count; ++i)
+    {
+      ESP_ERROR_CHECK(gpio_intr_disable(pins_[i].num));
+      ESP_ERROR_CHECK(gpio_isr_handler_remove(pins_[i].num));
+    }
+    // Fails harmlessly if the timer is not armed
+    esp_timer_stop(resync_timer_);
+    ESP_ERROR_CHECK(esp_timer_delete(resync_timer_));
+    vEventGroupDelete(event_group_);
+  }
+
+  GpioWaiter::PinMask GpioWaiter::AddPin(const gpio_num_t pin,
+                                         const bool inverse_logic,
+                                         const gpio_pull_mode_t pull_mode,
+                                         const int intr_alloc_flags)
+  {
+    const size_t pin_count{pin_count_.load(std::memory_order_relaxed)};
+    if (pin_count >= MAX_PINS)
+    {
+      ESPTOOLS_LOGE("Cannot add GPIO %d, the waiter already has %u pins", pin,
+                    static_cast<unsigned>(MAX_PINS));
+      return 0;
+    }
+    Pin &entry{pins_[pin_count]};
+    entry = {this, pin, inverse_logic, static_cast<uint8_t>(pin_count)};
+    const PinMask mask{CreateBitMaskAt<PinMask>(entry.index)};
+
+    // The interrupt is only enabled once the bits of the pin are seeded
+    const gpio_config_t config{
+        .pin_bit_mask = CreateBitMaskAt<uint64_t>(pin),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = (pull_mode == GPIO_PULLUP_ONLY || pull_mode == GPIO_PULLUP_PULLDOWN)
+                          ? GPIO_PULLUP_ENABLE
+                          : GPIO_PULLUP_DISABLE,
+        .pull_down_en = (pull_mode == GPIO_PULLDOWN_ONLY || pull_mode == GPIO_PULLUP_PULLDOWN)
+                            ? GPIO_PULLDOWN_ENABLE
+                            : GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    ESP_ERROR_CHECK(gpio_config(&config));
+
+    const GpioState state(gpio_get_level(pin), inverse_logic);
+    xEventGroupClearBits(event_group_, ToBits(mask, !state));
+    xEventGroupSetBits(event_group_, ToBits(mask, state));
+    pin_count_.store(pin_count + 1, std::memory_order_release);
+
+    InstallIsrService(intr_alloc_flags);
+    ESP_ERROR_CHECK(gpio_isr_handler_add(pin, IsrHandler, &entry));
+    ESP_ERROR_CHECK(gpio_set_intr_type(pin, GPIO_INTR_ANYEDGE));
+    ESP_ERROR_CHECK(gpio_intr_enable(pin));
+    // An edge between the seed and the interrupt enable has no ISR update, the resync queued
+    // behind the ones of later edges catches it without overwriting them
+    RequestResync();
+
+    ESPTOOLS_LOGD("GPIO %d registered with mask 0x%03" PRIx32 " (initial state %s)", pin, mask,
+                  state.ToStr());
+    return mask;
+  }
+
+  GpioWaiter::PinMask GpioWaiter::WaitAny(const PinMask pins, const GpioState state,
+                                          const TickType_t timeout) const
+  {
+    return Wait(pins, state, timeout, false);
+  }
+
+  GpioWaiter::PinMask GpioWaiter::WaitAll(const PinMask pins, const GpioState state,
+                                          const TickType_t timeout) const
+  {
+    return Wait(pins, state, timeout, true);
+  }
+
+  GpioWaiter::PinMask GpioWaiter::Get(const GpioState state) const
+  {
+    return ToPins(xEventGroupGetBits(event_group_), state);
+  }
+
+  EventBits_t IRAM_ATTR GpioWaiter::ToBits(const PinMask pins, const GpioState state)
+  {
+    const EventBits_t bits{pins & (CreateBitMaskAt<PinMask>(MAX_PINS) - 1)};
+    switch (state)
+    {
+    case GpioState::High:
+      return bits;
+    case GpioState::Low:
+      return bits << MAX_PINS;
+    default:
+      return 0;
+    }
+  }
+
+  GpioWaiter::PinMask GpioWaiter::ToPins(const EventBits_t bits, const GpioState state)
+  {
+    const PinMask pins_mask{CreateBitMaskAt<PinMask>(MAX_PINS) - 1};
+    switch (state)
+    {
+    case GpioState::High:
+      return bits & pins_mask;
+    case GpioState::Low:
+      return (bits >> MAX_PINS) & pins_mask;
+    default:
+      return 0;
+    }
+  }
+
+  GpioWaiter::PinMask GpioWaiter::Wait(const PinMask pins, const GpioState state,
+                                       const TickType_t timeout, const bool wait_all) const
+  {
+    const EventBits_t bits{ToBits(pins, state)};
+    if (bits == 0)
+    {
+      return 0;
+    }
+    // Bits are never cleared on exit, they always mirror the current levels
+    const EventBits_t result{xEventGroupWaitBits(event_group_, bits, pdFALSE,
+                                                 wait_all ? pdTRUE : pdFALSE, timeout)};
+    return ToPins(result & bits, state);
+  }
+
+  void IRAM_ATTR GpioWaiter::IsrHandler(void *arg)
+  {
+    const Pin &pin{*static_cast<const Pin *>(arg)};
+    GpioWaiter &waiter{*pin.waiter};
+    const GpioState state(gpio_get_level(pin.num), pin.inverse_logic);
+    const PinMask mask{CreateBitMaskAt<PinMask>(pin.index)};
+
+    // Clear the opposite state first, so both bits of a pin are never set at the same time
+    BaseType_t higher_priority_task_woken{pdFALSE};
+    const BaseType_t cleared{
+        xEventGroupClearBitsFromISR(waiter.event_group_, ToBits(mask, !state))};
+    const BaseType_t set{xEventGroupSetBitsFromISR(waiter.event_group_, ToBits(mask, state),
+                                                   &higher_priority_task_woken)};
+    if (cleared != pdPASS || set != pdPASS)
+    {
+      // The timer service queue is full, the bits no longer mirror the pin
+      waiter.dropped_updates_.store(waiter.dropped_updates_.load(std::memory_order_relaxed) + 1,
+                                    std::memory_order_relaxed);
+      // Fails harmlessly if a resync is already pending
+      esp_timer_start_once(waiter.resync_timer_, 0);
+    }
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+  }
+
+  void GpioWaiter::ResyncTimerHandler(void *arg)
+  {
+    static_cast<GpioWaiter *>(arg)->RequestResync();
+  }
+
+  void GpioWaiter::Resync(void *arg, uint32_t)
+  {
+    GpioWaiter &waiter{*static_cast<GpioWaiter *>(arg)};
+    EventBits_t set_bits{0};
+    EventBits_t clear_bits{0};
+    const size_t pin_count{waiter.pin_count_.load(std::memory_order_acquire)};
+    for (size_t i{0}; i < pin_count; ++i)
+    {
+      const Pin &pin{waiter.pins_[i]};
+      const PinMask mask{CreateBitMaskAt<PinMask>(pin.index)};
+      const GpioState state(gpio_get_level(pin.num), pin.inverse_logic);
+      set_bits |= ToBits(mask, state);
+      clear_bits |= ToBits(mask, !state);
+    }
+    xEventGroupClearBits(waiter.event_group_, clear_bits);
+    xEventGroupSetBits(waiter.event_group_, set_bits);
+  }
+
+  void GpioWaiter::RequestResync()
+  {
+    // Retry period while the timer service queue stays full
+    constexpr uint64_t RETRY_US{1000};
+    if (xTimerPendFunctionCall(Resync, this, 0, 0) != pdPASS)
+    {
+      esp_timer_start_once(resync_timer_, RETRY_US);
+    }
+  }
+
+} // namespace ESPTools
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/gpio_state.h"
+#include "ESPTools/logger.h"
+
+#include <driver/gpio.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Compile-time log level of the GpioWaiter module
+#ifndef ESPTOOLS_LOG_LEVEL_GPIO_WAITER
+#define ESPTOOLS_LOG_LEVEL_GPIO_WAITER ESPTOOLS_LOG_LEVEL
+#endif
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Blocks tasks until any or all of a group of pins reach a given state, without polling.
+   * Every registered pin has an ISR (installed through `InstallIsrService`) that mirrors its level
+   * into a FreeRTOS event group, and the waiting tasks block on `xEventGroupWaitBits()`.
+   *
+   * @details Each pin gets two event bits, selected with `CreateBitMaskAt()` from its
+   * registration index: one set while the pin is High and one set while it is Low, so both
+   * "wait for High" and "wait for Low" are plain waits for set bits. The bits mirror the levels,
+   * so a wait returns immediately when the condition already holds and an edge that happened
+   * before the call is never missed. Since a FreeRTOS event group holds 24 bits, up to 12 pins
+   * can be registered per waiter.
+   *
+   * FreeRTOS defers the event group updates made from an ISR to the timer service task, so the
+   * waiting tasks are woken up with the latency of that task (configUSE_TIMERS, enabled by
+   * default in ESP-IDF). The registration indices are returned as a PinMask, and several of them
+   * can be ORed to wait on a group of pins.
+   *
+   * When the queue of the timer service task is full the update of an edge is lost. The ISR then
+   * counts it (`GetDroppedUpdates()`) and arms a one-shot esp_timer that queues a resync of all
+   * the bits from the levels of the pins, retrying until the queue accepts it. The resync runs in
+   * the timer service task itself, after the updates queued before it, so it never publishes a
+   * level older than theirs.
+   */
+  class GpioWaiter
+  {
+  public:
+    // Bitmask of registered pins, bit N is the pin registered with index N
+    using PinMask = uint32_t;
+
+    // Maximum number of pins per waiter
+    static constexpr size_t MAX_PINS{12};
+
+    /**
+     * @brief Creates the event group. No memory is allocated.
+     */
+    GpioWaiter();
+
+    /**
+     * @brief Removes the ISRs of the registered pins and deletes the event group and the resync
+     * timer
+     */
+    ~GpioWaiter();
+
+    GpioWaiter(const GpioWaiter &) = delete;
+    GpioWaiter &operator=(const GpioWaiter &) = delete;
+
+    /**
+     * @brief Configures a pin as an input and starts mirroring its state
+     *
+     * @param pin GPIO number of the input
+     * @param inverse_logic If set to true, the read level will be inverted (active low input)
+     * @param pull_mode Pull resistor configuration of the pin
+     * @param intr_alloc_flags Flags forwarded to `InstallIsrService` in case it has not been
+     * installed yet
+     * @return Mask of the pin to use with `WaitAny()`/`WaitAll()`, 0 if MAX_PINS are already
+     * registered
+     */
+    PinMask AddPin(const gpio_num_t pin,
+                   const bool inverse_logic = false,
+                   const gpio_pull_mode_t pull_mode = GPIO_FLOATING,
+                   const int intr_alloc_flags = 0);
+
+    /**
+     * @brief Blocks until at least one of the pins is in the given state
+     *
+     * @param pins Mask of the pins to wait on, as returned by `AddPin()`
+     * @param state State to wait for, either High or Low
+     * @param timeout Maximum time to wait in ticks
+     * @return Mask of the pins in the given state, 0 on timeout
+     */
+    PinMask WaitAny(const PinMask pins, const GpioState state,
+                    const TickType_t timeout = portMAX_DELAY) const;
+
+    /**
+     * @brief Blocks until all the pins are in the given state at the same time
+     *
+     * @param pins Mask of the pins to wait on, as returned by `AddPin()`
+     * @param state State to wait for, either High or Low
+     * @param timeout Maximum time to wait in ticks
+     * @return Mask of the pins in the given state. Equal to `pins` on success.
+     */
+    PinMask WaitAll(const PinMask pins, const GpioState state,
+                    const TickType_t timeout = portMAX_DELAY) const;
+
+    /**
+     * @brief Returns the mask of the registered pins that are in the given state, without
+     * blocking
+     *
+     * @param state State to look for, either High or Low
+     */
+    PinMask Get(const GpioState state) const;
+
+    /**
+     * @brief Returns the number of edges whose update could not be queued from the ISR, each of
+     * them triggered a resync of the bits
+     */
+    uint32_t GetDroppedUpdates() const { return dropped_updates_.load(std::memory_order_relaxed); }
+
+  private:
+    // Tag used for the logging system
+    static constexpr char LOG_TAG[]{ESPTOOLS_LOG_TAG_CREATOR("GpioWaiter")};
+    // Compile-time log level of the module
+    static constexpr esp_log_level_t LOG_LEVEL{ESPTOOLS_LOG_LEVEL_GPIO_WAITER};
+
+    /**
+     * @brief Registered pin, its address is the argument of the ISR
+     */
+    struct Pin
+    {
+      GpioWaiter *waiter;
+      gpio_num_t num;
+      bool inverse_logic;
+      uint8_t index;
+    };
+
+    /**
+     * @brief Converts a mask of pins to the event bits representing the given state
+     *
+     * @return 0 if the state is "Undefined"
+     */
+    static EventBits_t ToBits(const PinMask pins, const GpioState state);
+
+    /**
+     * @brief Converts event bits of the given state back to a mask of pins
+     */
+    static PinMask ToPins(const EventBits_t bits, const GpioState state);
+
+    /**
+     * @brief Waits for the event bits of the pins
+     */
+    PinMask Wait(const PinMask pins, const GpioState state, const TickType_t timeout,
+                 const bool wait_all) const;
+
+    /**
+     * @brief ISR attached to every registered pin, updates the bits of the pin
+     *
+     * @param arg Pointer to the Pin entry
+     */
+    static void IsrHandler(void *arg);
+
+    /**
+     * @brief Callback of the resync timer, queues `Resync()` to the timer service task
+     *
+     * @param arg Pointer to the GpioWaiter
+     */
+    static void ResyncTimerHandler(void *arg);
+
+    /**
+     * @brief Sets the bits of all the registered pins from their current levels. Runs in the timer
+     * service task, through `xTimerPendFunctionCall()`.
+     *
+     * @param arg Pointer to the GpioWaiter
+     */
+    static void Resync(void *arg, uint32_t);
+
+    /**
+     * @brief Queues `Resync()`, or arms the resync timer to retry later if the queue is full
+     */
+    void RequestResync();
+
+    StaticEventGroup_t event_group_buffer_;
+    EventGroupHandle_t event_group_;
+    Pin pins_[MAX_PINS];
+    // Only incremented before the ISR of the pin is attached, read by Resync()
+    std::atomic<size_t> pin_count_;
+    // Retries the resync when the timer service queue is full
+    esp_timer_handle_t resync_timer_;
+    // Only written by the ISRs, which all run on the core that installed the ISR service
+    std::atomic<uint32_t> dropped_updates_;
+  };
+
+} // namespace ESPTools
@@ -0,0 +1,382 @@
+#include "ESPTools/gpio_waveform.h"
+#include "ESPTools/logger.h"
+
+#include <esp_attr.h>
+
+#include <algorithm>
+
+namespace ESPTools
+{
+
+  namespace
+  {
+    /**
+     * @brief Returns the factor that converts nanoseconds to ticks, in 32.32 fixed point
+     */
+    constexpr uint64_t TicksPerNs(const uint32_t resolution_hz)
+    {
+      return (static_cast<uint64_t>(resolution_hz) << 32) / 1000000000;
+    }
+
+    /**
+     * @brief Converts nanoseconds to ticks, rounding to the nearest tick. A multiplication
+     * instead of a 64-bit division per step.
+     */
+    constexpr uint32_t NsToTicks(const uint32_t duration_ns, const uint64_t ticks_per_ns)
+    {
+      return static_cast<uint32_t>((duration_ns * ticks_per_ns + (uint64_t{1} << 31)) >> 32);
+    }
+
+#if !SOC_RMT_SUPPORTED
+    /**
+     * @brief Returns a set with only the physical level of a pin defined
+     */
+    constexpr GpioStateSet PinLevel(const gpio_num_t pin,
+                                    const GpioState state,
+                                    const bool inverse_logic)
+    {
+      const GpioStateSet::Mask mask{CreateBitMaskAt<GpioStateSet::Mask>(pin)};
+      const GpioState level(state == GpioState::High, inverse_logic);
+      return GpioStateSet(level == GpioState::High ? mask : 0, mask);
+    }
+#endif
+  } // namespace
+
+  GpioPatternPlayer::GpioPatternPlayer(const GpioStateSet &idle, const uint32_t resolution_hz)
+      : idle_(idle),
+        ticks_per_ns_(TicksPerNs(resolution_hz)),
+        timer_(nullptr),
+        buffers_(),
+        counts_(),
+        active_(0),
+        position_(0),
+        write_index_(0),
+        running_(false),
+        free_buffers_(nullptr),
+        free_buffers_buffer_()
+  {
+    free_buffers_ = xSemaphoreCreateCountingStatic(2, 2, &free_buffers_buffer_);
+    idle_.WriteOutputs();
+
+    const gptimer_config_t config{
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = resolution_hz,
+        .flags = {.intr_shared = false},
+    };
+    ESP_ERROR_CHECK(gptimer_new_timer(&config, &timer_));
+    const gptimer_event_callbacks_t callbacks{.on_alarm = AlarmHandler};
+    ESP_ERROR_CHECK(gptimer_register_event_callbacks(timer_, &callbacks, this));
+    ESP_ERROR_CHECK(gptimer_enable(timer_));
+    ESPTOOLS_LOGD("Pattern player ready at %" PRIu32 " Hz", resolution_hz);
+  }
+
+  GpioPatternPlayer::~GpioPatternPlayer()
+  {
+    portENTER_CRITICAL(&lock_);
+    if (running_)
+    {
+      ESP_ERROR_CHECK(gptimer_stop(timer_));
+      running_ = false;
+    }
+    portEXIT_CRITICAL(&lock_);
+    ESP_ERROR_CHECK(gptimer_disable(timer_));
+    ESP_ERROR_CHECK(gptimer_del_timer(timer_));
+    vSemaphoreDelete(free_buffers_);
+  }
+
+  bool GpioPatternPlayer::Write(const WaveformFrame *const frames,
+                                const size_t count,
+                                const TickType_t timeout)
+  {
+    for (size_t done{0}; done < count;)
+    {
+      if (xSemaphoreTake(free_buffers_, timeout) != pdTRUE)
+      {
+        return false;
+      }
+      const size_t chunk{std::min(count - done, BUFFER_SIZE)};
+      Frame *const buffer{buffers_[write_index_]};
+      for (size_t i{0}; i < chunk; ++i)
+      {
+        const WaveformFrame &frame{frames[done + i]};
+        buffer[i] = {frame.levels, NsToTicks(frame.duration_ns, ticks_per_ns_)};
+      }
+      done += chunk;
+
+      portENTER_CRITICAL(&lock_);
+      counts_[write_index_] = chunk;
+      if (!running_)
+      {
+        // The first alarm fires right away and drives the first frame
+        active_ = write_index_;
+        position_ = 0;
+        running_ = true;
+        const gptimer_alarm_config_t alarm{
+            .alarm_count = 1, .reload_count = 0, .flags = {.auto_reload_on_alarm = false}};
+        ESP_ERROR_CHECK(gptimer_set_raw_count(timer_, 0));
+        ESP_ERROR_CHECK(gptimer_set_alarm_action(timer_, &alarm));
+        ESP_ERROR_CHECK(gptimer_start(timer_));
+      }
+      portEXIT_CRITICAL(&lock_);
+      write_index_ ^= 1;
+    }
+    return true;
+  }
+
+  bool GpioPatternPlayer::WaitDone(const TickType_t timeout)
+  {
+    // Both buffers are free once everything has been played
+    if (xSemaphoreTake(free_buffers_, timeout) != pdTRUE)
+    {
+      return false;
+    }
+    const bool done{xSemaphoreTake(free_buffers_, timeout) == pdTRUE};
+    xSemaphoreGive(free_buffers_);
+    if (done)
+    {
+      xSemaphoreGive(free_buffers_);
+    }
+    return done;
+  }
+
+  bool IRAM_ATTR GpioPatternPlayer::AlarmHandler(gptimer_handle_t timer,
+                                                 const gptimer_alarm_event_data_t *data,
+                                                 void *arg)
+  {
+    GpioPatternPlayer &player{*static_cast<GpioPatternPlayer *>(arg)};
+    BaseType_t task_woken{pdFALSE};
+
+    portENTER_CRITICAL_ISR(&player.lock_);
+    if (player.position_ == player.counts_[player.active_])
+    {
+      // The last frame of the buffer has elapsed, free it and continue with the other one
+      player.counts_[player.active_] = 0;
+      xSemaphoreGiveFromISR(player.free_buffers_, &task_woken);
+      player.active_ ^= 1;
+      player.position_ = 0;
+      if (player.counts_[player.active_] == 0)
+      {
+        player.idle_.WriteOutputs();
+        gptimer_stop(timer);
+        player.running_ = false;
+        portEXIT_CRITICAL_ISR(&player.lock_);
+        return task_woken == pdTRUE;
+      }
+    }
+    const Frame &frame{player.buffers_[player.active_][player.position_++]};
+    portEXIT_CRITICAL_ISR(&player.lock_);
+
+    frame.levels.WriteOutputs();
+    // Scheduled on the absolute timeline, so the latency of this ISR does not accumulate
+    const gptimer_alarm_config_t alarm{.alarm_count = data->alarm_value + frame.ticks,
+                                       .reload_count = 0,
+                                       .flags = {.auto_reload_on_alarm = false}};
+    gptimer_set_alarm_action(timer, &alarm);
+    return task_woken == pdTRUE;
+  }
+
+  GpioWaveform::GpioWaveform(const gpio_num_t pin,
+                             const bool inverse_logic,
+                             const GpioState idle_state,
+                             const uint32_t resolution_hz)
+      : pin_(pin),
+        inverse_logic_(inverse_logic),
+        idle_state_(idle_state)
+#if SOC_RMT_SUPPORTED
+        ,
+        ticks_per_ns_(TicksPerNs(resolution_hz)),
+        channel_(nullptr),
+        encoder_(nullptr),
+        symbols_(),
+        write_index_(0),
+        free_buffers_(nullptr),
+        free_buffers_buffer_()
+#else
+        ,
+        player_(PinLevel(pin, idle_state, inverse_logic), resolution_hz)
+#endif
+  {
+#if SOC_RMT_SUPPORTED
+    free_buffers_ = xSemaphoreCreateCountingStatic(2, 2, &free_buffers_buffer_);
+    // The output is inverted by the GPIO matrix, the symbols keep the logical levels
+    const rmt_tx_channel_config_t config{
+        .gpio_num = pin_,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = resolution_hz,
+#if SOC_RMT_SUPPORT_DMA
+        .mem_block_symbols = BUFFER_SYMBOLS,
+        .trans_queue_depth = 2,
+        .flags = {.invert_out = inverse_logic_, .with_dma = true, .io_loop_back = false,
+                  .io_od_mode = false},
+#else
+        .mem_block_symbols = SOC_RMT_MEM_WORDS_PER_CHANNEL,
+        .trans_queue_depth = 2,
+        .flags = {.invert_out = inverse_logic_, .with_dma = false, .io_loop_back = false,
+                  .io_od_mode = false},
+#endif
+    };
+    ESP_ERROR_CHECK(rmt_new_tx_channel(&config, &channel_));
+    const rmt_copy_encoder_config_t encoder_config{};
+    ESP_ERROR_CHECK(rmt_new_copy_encoder(&encoder_config, &encoder_));
+    const rmt_tx_event_callbacks_t callbacks{.on_trans_done = RmtDoneHandler};
+    ESP_ERROR_CHECK(rmt_tx_register_event_callbacks(channel_, &callbacks, this));
+    ESP_ERROR_CHECK(rmt_enable(channel_));
+    ESPTOOLS_LOGD("GPIO %d driven by RMT at %" PRIu32 " Hz", pin_, resolution_hz);
+#else
+    const gpio_config_t config{
+        .pin_bit_mask = CreateBitMaskAt<uint64_t>(pin_),
+        .mode = GPIO_MODE_OUTPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    ESP_ERROR_CHECK(gpio_config(&config));
+    ESPTOOLS_LOGD("GPIO %d driven by a timer ISR (no RMT on this chip)", pin_);
+#endif
+  }
+
+  GpioWaveform::~GpioWaveform()
+  {
+#if SOC_RMT_SUPPORTED
+    ESP_ERROR_CHECK(rmt_disable(channel_));
+    ESP_ERROR_CHECK(rmt_del_encoder(encoder_));
+    ESP_ERROR_CHECK(rmt_del_channel(channel_));
+    vSemaphoreDelete(free_buffers_);
+#endif
+  }
+
+#if SOC_RMT_SUPPORTED
+  bool GpioWaveform::Write(const WaveformStep *const steps,
+                           const size_t count,
+                           const TickType_t timeout)
+  {
+    static constexpr uint32_t MAX_TICKS{32767};
+    rmt_symbol_word_t *buffer{nullptr};
+    size_t symbol_count{0};
+    // Whether the current symbol only has its first half
+    bool half{false};
+
+    for (size_t i{0}; i < count; ++i)
+    {
+      const GpioState state{steps[i].state == GpioState::Undefined ? idle_state_ : steps[i].state};
+      const uint16_t level{state == GpioState::High};
+      for (uint32_t ticks{NsToTicks(steps[i].duration_ns, ticks_per_ns_)}; ticks > 0;)
+      {
+        const uint16_t part{static_cast<uint16_t>(std::min(ticks, MAX_TICKS))};
+        ticks -= part;
+        if (half)
+        {
+          buffer[symbol_count].duration1 = part;
+          buffer[symbol_count].level1 = level;
+          ++symbol_count;
+          half = false;
+          continue;
+        }
+        if (symbol_count == BUFFER_SYMBOLS)
+        {
+          SubmitBuffer(symbol_count);
+          buffer = nullptr;
+          symbol_count = 0;
+        }
+        if (!buffer && !(buffer = AcquireBuffer(timeout)))
+        {
+          return false;
+        }
+        buffer[symbol_count].duration0 = part;
+        buffer[symbol_count].level0 = level;
+        half = true;
+      }
+    }
+
+    if (half)
+    {
+      // A zero duration ends the transmission, so the last half is split in two
+      rmt_symbol_word_t &symbol{buffer[symbol_count++]};
+      const uint16_t duration{std::max<uint16_t>(symbol.duration0, 2)};
+      symbol.duration0 = duration / 2;
+      symbol.duration1 = duration - duration / 2;
+      symbol.level1 = symbol.level0;
+    }
+    if (symbol_count > 0)
+    {
+      SubmitBuffer(symbol_count);
+    }
+    return true;
+  }
+
+  bool GpioWaveform::WaitDone(const TickType_t timeout)
+  {
+    // Both buffers are free once everything has been transmitted
+    if (xSemaphoreTake(free_buffers_, timeout) != pdTRUE)
+    {
+      return false;
+    }
+    const bool done{xSemaphoreTake(free_buffers_, timeout) == pdTRUE};
+    xSemaphoreGive(free_buffers_);
+    if (done)
+    {
+      xSemaphoreGive(free_buffers_);
+    }
+    return done;
+  }
+
+  rmt_symbol_word_t *GpioWaveform::AcquireBuffer(const TickType_t timeout)
+  {
+    if (xSemaphoreTake(free_buffers_, timeout) != pdTRUE)
+    {
+      return nullptr;
+    }
+    return symbols_[write_index_];
+  }
+
+  void GpioWaveform::SubmitBuffer(const size_t symbol_count)
+  {
+    const rmt_transmit_config_t config{
+        .loop_count = 0,
+        .flags = {.eot_level = idle_state_ == GpioState::High},
+    };
+    ESP_ERROR_CHECK(rmt_transmit(channel_, encoder_, symbols_[write_index_],
+                                 symbol_count * sizeof(rmt_symbol_word_t), &config));
+    write_index_ ^= 1;
+  }
+
+  bool IRAM_ATTR GpioWaveform::RmtDoneHandler(rmt_channel_handle_t,
+                                              const rmt_tx_done_event_data_t *,
+                                              void *arg)
+  {
+    GpioWaveform &waveform{*static_cast<GpioWaveform *>(arg)};
+    BaseType_t task_woken{pdFALSE};
+    xSemaphoreGiveFromISR(waveform.free_buffers_, &task_woken);
+    return task_woken == pdTRUE;
+  }
+#else
+  bool GpioWaveform::Write(const WaveformStep *const steps,
+                           const size_t count,
+                           const TickType_t timeout)
+  {
+    // Converted in small chunks, the player copies them into its own buffers
+    static constexpr size_t CHUNK_SIZE{16};
+    WaveformFrame frames[CHUNK_SIZE];
+    for (size_t done{0}; done < count;)
+    {
+      const size_t chunk{std::min(count - done, CHUNK_SIZE)};
+      for (size_t i{0}; i < chunk; ++i)
+      {
+        const WaveformStep &step{steps[done + i]};
+        const GpioState state{step.state == GpioState::Undefined ? idle_state_ : step.state};
+        frames[i] = {PinLevel(pin_, state, inverse_logic_), step.duration_ns};
+      }
+      if (!player_.Write(frames, chunk, timeout))
+      {
+        return false;
+      }
+      done += chunk;
+    }
+    return true;
+  }
+
+  bool GpioWaveform::WaitDone(const TickType_t timeout) { return player_.WaitDone(timeout); }
+#endif
+
+} // namespace ESPTools
@@ -0,0 +1,279 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/gpio_state.h"
+#include "ESPTools/gpio_state_set.h"
+#include "ESPTools/logger.h"
+
+#include <driver/gpio.h>
+#include <driver/gptimer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <soc/soc_caps.h>
+
+#if SOC_RMT_SUPPORTED
+#include <driver/rmt_tx.h>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+
+// Compile-time log level of the GpioWaveform module
+#ifndef ESPTOOLS_LOG_LEVEL_GPIO_WAVEFORM
+#define ESPTOOLS_LOG_LEVEL_GPIO_WAVEFORM ESPTOOLS_LOG_LEVEL
+#endif
+
+// Number of entries of each of the two playback buffers: RMT symbols (two steps each) for
+// GpioWaveform, frames for GpioPatternPlayer
+#ifndef ESPTOOLS_WAVEFORM_BUFFER_SIZE
+#define ESPTOOLS_WAVEFORM_BUFFER_SIZE 64
+#endif
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Level of a single pin held for a given time
+   */
+  struct WaveformStep
+  {
+    uint32_t duration_ns;
+    GpioState state;
+  };
+
+  /**
+   * @brief Levels of several pins held for a given time. Only the defined pins of `levels` are
+   * driven, the rest keep their current level.
+   */
+  struct WaveformFrame
+  {
+    GpioStateSet levels;
+    uint32_t duration_ns;
+  };
+
+  /**
+   * @brief Plays multi-pin patterns on any set of output pins. A general purpose timer raises an
+   * alarm at the start of every frame, and its ISR drives all the pins of the frame at once
+   * through `GpioStateSet::WriteOutputs()`. The next alarm is set on the absolute timeline of the
+   * timer, so the latency of an interrupt does not accumulate.
+   *
+   * @details Frames are copied into two buffers that are played in turns: `Write()` fills one
+   * while the ISR plays the other, so a stream of frames plays without gaps as long as the writer
+   * keeps up. When the ISR runs out of frames it drives the idle levels and stops the timer.
+   *
+   * There is one interrupt per frame, so frames shorter than the interrupt latency (a few
+   * microseconds) are stretched, and later frames are delayed until the timeline is caught up.
+   * With `CONFIG_GPTIMER_ISR_IRAM_SAFE` the pattern keeps playing while the flash cache is
+   * disabled, which also requires `CONFIG_GPTIMER_CTRL_FUNC_IN_IRAM`.
+   *
+   * The pins must already be configured as outputs.
+   */
+  class GpioPatternPlayer
+  {
+  public:
+    // Frames per buffer
+    static constexpr size_t BUFFER_SIZE{ESPTOOLS_WAVEFORM_BUFFER_SIZE};
+    // Default timer frequency, 1 us resolution
+    static constexpr uint32_t DEFAULT_RESOLUTION_HZ{1000 * 1000};
+
+    /**
+     * @brief Allocates the timer and drives the idle levels
+     *
+     * @param idle Levels driven before the first frame and whenever the player runs out of frames
+     * @param resolution_hz Tick frequency of the timer
+     */
+    explicit GpioPatternPlayer(const GpioStateSet &idle,
+                               const uint32_t resolution_hz = DEFAULT_RESOLUTION_HZ);
+
+    /**
+     * @brief Stops the playback and releases the timer
+     */
+    ~GpioPatternPlayer();
+
+    GpioPatternPlayer(const GpioPatternPlayer &) = delete;
+    GpioPatternPlayer &operator=(const GpioPatternPlayer &) = delete;
+
+    /**
+     * @brief Queues frames for playback, and starts it if the player is idle. The frames are
+     * copied, so the array can be reused once the function returns.
+     *
+     * @param frames Frames to play
+     * @param count Number of frames
+     * @param timeout Maximum time to wait for a free buffer
+     * @return False if no buffer was freed in time. The frames copied before are still played.
+     */
+    bool Write(const WaveformFrame *const frames,
+               const size_t count,
+               const TickType_t timeout = portMAX_DELAY);
+
+    /**
+     * @brief Waits until every queued frame has been played
+     *
+     * @param timeout Maximum time to wait for each of the two buffers
+     * @return False on timeout
+     */
+    bool WaitDone(const TickType_t timeout = portMAX_DELAY);
+
+  private:
+    // Tag used for the logging system
+    static constexpr char LOG_TAG[]{ESPTOOLS_LOG_TAG_CREATOR("GpioPatternPlayer")};
+    // Compile-time log level of the module
+    static constexpr esp_log_level_t LOG_LEVEL{ESPTOOLS_LOG_LEVEL_GPIO_WAVEFORM};
+
+    /**
+     * @brief Frame converted to timer ticks
+     */
+    struct Frame
+    {
+      GpioStateSet levels;
+      uint32_t ticks;
+    };
+
+    /**
+     * @brief Timer alarm callback, drives the next frame and schedules the one after it
+     */
+    static bool AlarmHandler(gptimer_handle_t timer,
+                             const gptimer_alarm_event_data_t *data,
+                             void *arg);
+
+    const GpioStateSet idle_;
+    // Conversion factor from nanoseconds to ticks, in 32.32 fixed point
+    const uint64_t ticks_per_ns_;
+    gptimer_handle_t timer_;
+    Frame buffers_[2][BUFFER_SIZE];
+    // Number of frames queued in each buffer, 0 when the buffer is free
+    size_t counts_[2];
+    // Buffer and frame played by the ISR
+    size_t active_;
+    size_t position_;
+    // Buffer filled by the next Write()
+    size_t write_index_;
+    bool running_;
+    // One token per free buffer
+    SemaphoreHandle_t free_buffers_;
+    StaticSemaphore_t free_buffers_buffer_;
+    portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+  };
+
+  /**
+   * @brief Plays waveforms of `(GpioState, duration)` steps on a single pin, for LED strips,
+   * stepper pulses or custom serial protocols, without toggling the pin from a task.
+   *
+   * @details On the chips with an RMT peripheral the steps are converted to RMT symbols and sent
+   * by the RMT transmitter (through the copy encoder), using DMA when the chip supports it
+   * (ESP32-S3), so the timing does not depend on the CPU at all. Steps longer than the maximum
+   * RMT duration (32767 ticks) are split. Two symbol buffers are used in turns: while one is
+   * transmitted, `Write()` converts the next steps into the other one. The RMT driver restarts
+   * the transmitter between two buffers, so the line stays at the idle level for a few
+   * microseconds there; protocols that do not tolerate it must fit a frame in one `Write()`.
+   * The object must be placed in internal memory (e.g. statically allocated).
+   *
+   * On the chips without RMT (ESP32-C2) the steps are played by a GpioPatternPlayer, with its
+   * limits on short steps.
+   *
+   * I2S or LCD parallel DMA output is not used: the RMT covers the single pin case on every chip
+   * that has those peripherals, and GpioPatternPlayer covers the multi-pin case.
+   */
+  class GpioWaveform
+  {
+  public:
+#if SOC_RMT_SUPPORTED
+    // Default RMT tick frequency, 0.1 us resolution and steps of up to 3.2 ms per symbol half
+    static constexpr uint32_t DEFAULT_RESOLUTION_HZ{10 * 1000 * 1000};
+#else
+    static constexpr uint32_t DEFAULT_RESOLUTION_HZ{GpioPatternPlayer::DEFAULT_RESOLUTION_HZ};
+#endif
+
+    /**
+     * @brief Configures the pin as an output at its idle state
+     *
+     * @param pin GPIO number of the output
+     * @param inverse_logic If set to true, the logic of the pin is inverted (active low output)
+     * @param idle_state Logical state of the pin while no waveform is played
+     * @param resolution_hz Tick frequency of the RMT transmitter, or of the timer without RMT
+     */
+    GpioWaveform(const gpio_num_t pin,
+                 const bool inverse_logic = false,
+                 const GpioState idle_state = GpioState::Low,
+                 const uint32_t resolution_hz = DEFAULT_RESOLUTION_HZ);
+
+    /**
+     * @brief Stops the playback and releases the peripheral
+     */
+    ~GpioWaveform();
+
+    GpioWaveform(const GpioWaveform &) = delete;
+    GpioWaveform &operator=(const GpioWaveform &) = delete;
+
+    /**
+     * @brief Queues steps for playback. The steps are converted, so the array can be reused once
+     * the function returns. Undefined steps are played at the idle state.
+     *
+     * @param steps Steps to play
+     * @param count Number of steps
+     * @param timeout Maximum time to wait for a free buffer
+     * @return False if no buffer was freed in time. The steps converted before are still played.
+     */
+    bool Write(const WaveformStep *const steps,
+               const size_t count,
+               const TickType_t timeout = portMAX_DELAY);
+
+    /**
+     * @brief Waits until every queued step has been played
+     *
+     * @param timeout Maximum time to wait for each of the two buffers
+     * @return False on timeout
+     */
+    bool WaitDone(const TickType_t timeout = portMAX_DELAY);
+
+    /**
+     * @brief Returns the GPIO number of the output
+     */
+    gpio_num_t GetPin() const { return pin_; }
+
+  private:
+    // Tag used for the logging system
+    static constexpr char LOG_TAG[]{ESPTOOLS_LOG_TAG_CREATOR("GpioWaveform")};
+    // Compile-time log level of the module
+    static constexpr esp_log_level_t LOG_LEVEL{ESPTOOLS_LOG_LEVEL_GPIO_WAVEFORM};
+
+    const gpio_num_t pin_;
+    const bool inverse_logic_;
+    const GpioState idle_state_;
+#if SOC_RMT_SUPPORTED
+    /**
+     * @brief Waits for a free symbol buffer
+     *
+     * @return Buffer to fill, nullptr on timeout
+     */
+    rmt_symbol_word_t *AcquireBuffer(const TickType_t timeout);
+
+    /**
+     * @brief Transmits the buffer returned by the last `AcquireBuffer()`
+     */
+    void SubmitBuffer(const size_t symbol_count);
+
+    /**
+     * @brief RMT transmit done callback, frees the buffer
+     */
+    static bool RmtDoneHandler(rmt_channel_handle_t channel,
+                               const rmt_tx_done_event_data_t *data,
+                               void *arg);
+
+    static constexpr size_t BUFFER_SYMBOLS{ESPTOOLS_WAVEFORM_BUFFER_SIZE};
+
+    // Conversion factor from nanoseconds to ticks, in 32.32 fixed point
+    const uint64_t ticks_per_ns_;
+    rmt_channel_handle_t channel_;
+    rmt_encoder_handle_t encoder_;
+    rmt_symbol_word_t symbols_[2][BUFFER_SYMBOLS];
+    size_t write_index_;
+    // One token per free buffer
+    SemaphoreHandle_t free_buffers_;
+    StaticSemaphore_t free_buffers_buffer_;
+#else
+    GpioPatternPlayer player_;
+#endif
+  };
+
+} // namespace ESPTools
@@ -0,0 +1,126 @@
+#include "ESPTools/isr_dispatch.h"
+#include "ESPTools/logger.h"
+
+#include <esp_attr.h>
+#include <esp_cpu.h>
+
+namespace ESPTools
+{
+
+  namespace
+  {
+    /**
+     * @brief Entry of the dispatch table
+     */
+    struct Entry
+    {
+      IsrDispatchTable::Handler handler;
+      void *arg;
+      bool track_stats;
+      // Set by MarkTrigger() and consumed by the next interrupt
+      volatile bool trigger_pending;
+      volatile uint32_t trigger_cycles;
+      // Set by the tasks to clear the stats, which are only written by the ISR
+      volatile bool reset_pending;
+      SeqLocked<IsrHandlerStats> stats;
+    };
+
+    // Accessed from the ISRs, so it must not be placed in flash
+    DRAM_ATTR Entry entries[IsrDispatchTable::SIZE]{};
+  } // namespace
+
+  void IsrDispatchTable::Register(const gpio_num_t pin,
+                                  const Handler handler,
+                                  void *const arg,
+                                  const bool track_stats,
+                                  const int intr_alloc_flags)
+  {
+    ESP_ERROR_CHECK(GPIO_IS_VALID_GPIO(pin) && handler ? ESP_OK : ESP_ERR_INVALID_ARG);
+    if (intr_alloc_flags != 0)
+    {
+      RequireIsrServiceFlags(intr_alloc_flags);
+    }
+    else
+    {
+      InstallIsrService(intr_alloc_flags);
+    }
+
+    Entry &entry{entries[pin]};
+    entry.handler = handler;
+    entry.arg = arg;
+    entry.track_stats = track_stats;
+    entry.trigger_pending = false;
+    entry.reset_pending = true;
+    ESP_ERROR_CHECK(gpio_isr_handler_add(pin, Trampoline, &entry));
+    ESPTOOLS_LOGD("Handler registered on GPIO %d", pin);
+  }
+
+  void IsrDispatchTable::Unregister(const gpio_num_t pin)
+  {
+    ESP_ERROR_CHECK(gpio_isr_handler_remove(pin));
+    entries[pin].handler = nullptr;
+  }
+
+  void IRAM_ATTR IsrDispatchTable::MarkTrigger(const gpio_num_t pin)
+  {
+    Entry &entry{entries[pin]};
+    entry.trigger_cycles = esp_cpu_get_cycle_count();
+    entry.trigger_pending = true;
+  }
+
+  IsrHandlerStats IsrDispatchTable::GetStats(const gpio_num_t pin)
+  {
+    const Entry &entry{entries[pin]};
+    // The ISR clears the stats on the next interrupt
+    return entry.reset_pending ? IsrHandlerStats{} : entry.stats.Read();
+  }
+
+  void IsrDispatchTable::ResetStats(const gpio_num_t pin) { entries[pin].reset_pending = true; }
+
+  void IsrDispatchTable::Report()
+  {
+    for (size_t pin{0}; pin < SIZE; ++pin)
+    {
+      if (!entries[pin].handler || !entries[pin].track_stats)
+      {
+        continue;
+      }
+      const IsrHandlerStats stats{GetStats(static_cast<gpio_num_t>(pin))};
+      ESPTOOLS_LOGI("GPIO %u: %" PRIu32 " calls, duration min/mean/max %" PRIu32 "/%" PRIu32
+                    "/%" PRIu32 " cycles",
+                    static_cast<unsigned>(pin), stats.duration.GetCount(),
+                    stats.duration.GetMin(), stats.duration.GetMean(), stats.duration.GetMax());
+      ESPTOOLS_LOGI("GPIO %u: latency min/mean/max %" PRIu32 "/%" PRIu32 "/%" PRIu32
+                    " cycles (%" PRIu32 " samples)",
+                    static_cast<unsigned>(pin), stats.latency.GetMin(), stats.latency.GetMean(),
+                    stats.latency.GetMax(), stats.latency.GetCount());
+    }
+  }
+
+  void IRAM_ATTR IsrDispatchTable::Trampoline(void *arg)
+  {
+    const uint32_t entry_cycles{esp_cpu_get_cycle_count()};
+    Entry &entry{*static_cast<Entry *>(arg)};
+    entry.handler(entry.arg);
+    if (!entry.track_stats)
+    {
+      return;
+    }
+    const uint32_t exit_cycles{esp_cpu_get_cycle_count()};
+
+    IsrHandlerStats &stats{entry.stats.BeginWrite()};
+    if (entry.reset_pending)
+    {
+      entry.reset_pending = false;
+      stats = {};
+    }
+    stats.duration.Add(exit_cycles - entry_cycles);
+    if (entry.trigger_pending)
+    {
+      entry.trigger_pending = false;
+      stats.latency.Add(entry_cycles - entry.trigger_cycles);
+    }
+    entry.stats.EndWrite();
+  }
+
+} // namespace ESPTools
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/logger.h"
+#include "ESPTools/stats.h"
+
+#include <driver/gpio.h>
+#include <soc/soc_caps.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Compile-time log level of the IsrDispatchTable module
+#ifndef ESPTOOLS_LOG_LEVEL_ISR_DISPATCH
+#define ESPTOOLS_LOG_LEVEL_ISR_DISPATCH ESPTOOLS_LOG_LEVEL
+#endif
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Number of samples, minimum, maximum, mean and deviation of a value measured in CPU
+   * cycles
+   */
+  using CycleStats = RunningStats<uint32_t>;
+
+  /**
+   * @brief Timing statistics of a GPIO ISR handler
+   */
+  struct IsrHandlerStats
+  {
+    // Cycles from the trigger stamped with `IsrDispatchTable::MarkTrigger()` to the handler
+    CycleStats latency;
+    // Cycles spent inside the handler
+    CycleStats duration;
+  };
+
+  /**
+   * @brief ESPTools owned table of GPIO interrupt handlers with per-handler timing. Every
+   * registered pin gets the same IRAM trampoline on the ISR service, which calls the user handler
+   * stored in a table placed in DRAM and indexed directly by the GPIO number, and optionally
+   * measures it with the CPU cycle counter, so interrupt latency budgets can be checked in
+   * production.
+   *
+   * @details The table is stacked on top of the IDF ISR service instead of replacing it: the
+   * GPIO interrupt has a single source per core, and owning it would break the other modules that
+   * use `InstallIsrService()` (GpioInput, GpioWaiter, PinEdge...). An interrupt therefore goes
+   * through the IDF per-pin dispatcher and then the trampoline, which adds a few cycles to the
+   * entry latency. The measured latency includes both levels, so it is the one the handlers see.
+   *
+   * The handler duration is always known. The entry latency can only be measured when the time of
+   * the trigger is known, so it is recorded for the interrupts whose trigger was stamped
+   * beforehand with `MarkTrigger()`, e.g. by the code that drives an output wired to the pin, or
+   * by a loopback test using the pin itself. The cycle counter is per core, so `MarkTrigger()`
+   * must run on the core that serves the GPIO interrupt (the one that installed the ISR service).
+   *
+   * The statistics are updated inside the ISR without locks and read from tasks through a
+   * sequence lock, so a single handler's statistics are always consistent. The template overloads
+   * take the pin as a template argument, which is checked at compile time against the GPIOs of
+   * the chip.
+   */
+  class IsrDispatchTable
+  {
+  public:
+    /**
+     * @brief Handler of a GPIO interrupt. It runs in interrupt context, and must be placed in IRAM
+     * (`IRAM_ATTR`) when the ISR service is installed with `ESP_INTR_FLAG_IRAM`.
+     *
+     * @param arg User argument provided when registering the handler
+     */
+    using Handler = void (*)(void *arg);
+
+    // Number of entries of the table, one per GPIO of the chip
+    static constexpr size_t SIZE{SOC_GPIO_PIN_COUNT};
+
+    /**
+     * @brief Attaches a handler to a pin. The pin must be configured with an interrupt type
+     * (e.g. through `gpio_config()`) for the handler to be called.
+     *
+     * @param pin GPIO number
+     * @param handler Function called on every interrupt of the pin
+     * @param arg User argument forwarded to the handler
+     * @param track_stats If set to true, the latency and duration of the handler are recorded
+     * @param intr_alloc_flags Flags the ISR service must meet (see `RequireIsrServiceFlags()`),
+     * which aborts if the service was already installed without them. With 0 the service is
+     * installed with the default flags if needed and nothing is required.
+     */
+    static void Register(const gpio_num_t pin,
+                         const Handler handler,
+                         void *const arg = nullptr,
+                         const bool track_stats = true,
+                         const int intr_alloc_flags = 0);
+
+    /**
+     * @brief Same as the other `Register()`, with the pin checked at compile time
+     *
+     * @tparam PIN GPIO number
+     */
+    template <gpio_num_t PIN>
+    static void Register(const Handler handler,
+                         void *const arg = nullptr,
+                         const bool track_stats = true,
+                         const int intr_alloc_flags = 0)
+    {
+      static_assert(IsValidPin(PIN), "Not a GPIO of this chip");
+      Register(PIN, handler, arg, track_stats, intr_alloc_flags);
+    }
+
+    /**
+     * @brief Detaches the handler of a pin
+     *
+     * @param pin GPIO number
+     */
+    static void Unregister(const gpio_num_t pin);
+
+    /**
+     * @brief Stamps the time at which an interrupt of the pin is triggered. The next interrupt
+     * of the pin records its entry latency from this stamp. Can be called from an ISR.
+     *
+     * @param pin GPIO number
+     */
+    static void MarkTrigger(const gpio_num_t pin);
+
+    /**
+     * @brief Returns the timing statistics of the handler of a pin
+     *
+     * @param pin GPIO number
+     */
+    static IsrHandlerStats GetStats(const gpio_num_t pin);
+
+    /**
+     * @brief Same as the other `GetStats()`, with the pin checked at compile time
+     *
+     * @tparam PIN GPIO number
+     */
+    template <gpio_num_t PIN>
+    static IsrHandlerStats GetStats()
+    {
+      static_assert(IsValidPin(PIN), "Not a GPIO of this chip");
+      return GetStats(PIN);
+    }
+
+    /**
+     * @brief Clears the timing statistics of the handler of a pin
+     *
+     * @param pin GPIO number
+     */
+    static void ResetStats(const gpio_num_t pin);
+
+    /**
+     * @brief Logs the timing statistics of every registered handler that tracks them
+     */
+    static void Report();
+
+  private:
+    // Tag used for the logging system
+    static constexpr char LOG_TAG[]{ESPTOOLS_LOG_TAG_CREATOR("IsrDispatch")};
+    // Compile-time log level of the module
+    static constexpr esp_log_level_t LOG_LEVEL{ESPTOOLS_LOG_LEVEL_ISR_DISPATCH};
+
+    /**
+     * @brief Checks at compile time that a pin has an entry in the table
+     */
+    static constexpr bool IsValidPin(const gpio_num_t pin)
+    {
+      return pin >= 0 && static_cast<size_t>(pin) < SIZE &&
+             ((SOC_GPIO_VALID_GPIO_MASK >> pin) & 1) != 0;
+    }
+
+    /**
+     * @brief ISR registered on the ISR service for every pin, calls the handler of the entry
+     *
+     * @param arg Pointer to the entry of the table
+     */
+    static void Trampoline(void *arg);
+  };
+
+} // namespace ESPTools
@@ -0,0 +1,230 @@
+#include "ESPTools/logger.h"
+#include "ESPTools/job_pool.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+namespace ESPTools
+{
+
+#ifdef CONFIG_FREERTOS_UNICORE
+
+  JobGroup::JobGroup() {}
+
+  JobGroup::~JobGroup() {}
+
+  JobPool::JobPool(const UBaseType_t, const bool) {}
+
+  JobPool::~JobPool() {}
+
+  void JobPool::Start() {}
+
+  void JobPool::Submit(JobGroup &, const Function function, void *const arg,
+                       const size_t begin, const size_t end, const size_t)
+  {
+    function(arg, begin, end);
+  }
+
+  void JobPool::Wait(JobGroup &) {}
+
+  void JobPool::ParallelFor(const size_t count, const size_t, const Function function,
+                            void *const arg)
+  {
+    if (count > 0)
+    {
+      function(arg, 0, count);
+    }
+  }
+
+  size_t JobPool::GetWorkerCount() const { return 0; }
+
+#else
+
+  static_assert(portNUM_PROCESSORS == 2, "JobPool supports up to two cores");
+
+  JobGroup::JobGroup() : pending_(1), done_buffer_(), done_(nullptr)
+  {
+    done_ = xSemaphoreCreateBinaryStatic(&done_buffer_);
+  }
+
+  JobGroup::~JobGroup() { vSemaphoreDelete(done_); }
+
+  JobPool::JobPool(const UBaseType_t priority, const bool use_protocol_core)
+      : workers_{{*this, priority, CorePolicy::App}, {*this, priority, CorePolicy::Protocol}},
+        worker_count_(use_protocol_core ? 2 : 1),
+        shared_(),
+        jobs_()
+  {
+  }
+
+  JobPool::~JobPool()
+  {
+    for (Worker &worker : workers_)
+    {
+      worker.Stop();
+    }
+  }
+
+  void JobPool::Start()
+  {
+    for (size_t i{0}; i < worker_count_; ++i)
+    {
+      workers_[i].Start();
+    }
+    ESPTOOLS_LOGD("Job pool started with %u workers", static_cast<unsigned>(worker_count_));
+  }
+
+  void JobPool::Submit(JobGroup &group, const Function function, void *const arg,
+                       const size_t begin, const size_t end, const size_t grain)
+  {
+    Worker *const worker{GetCurrentWorker()};
+    const Job job{function, arg, begin, end, grain, &group};
+    group.pending_.fetch_add(1, std::memory_order_relaxed);
+    Job *const record{jobs_.Acquire(job)};
+    if (!record || !Push(record, worker))
+    {
+      // No room to queue it, run it here
+      jobs_.Release(record);
+      Execute(job, worker);
+      return;
+    }
+    Notify(worker);
+  }
+
+  void JobPool::Wait(JobGroup &group)
+  {
+    Worker *const worker{GetCurrentWorker()};
+    while (group.pending_.load(std::memory_order_acquire) > 1 && RunOne(worker))
+    {
+    }
+    // Drop the reference of the group, the last job gives the semaphore if it is still running
+    if (group.pending_.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    {
+      xSemaphoreTake(group.done_, portMAX_DELAY);
+    }
+    group.pending_.store(1, std::memory_order_relaxed);
+  }
+
+  void JobPool::ParallelFor(const size_t count, const size_t grain, const Function function,
+                            void *const arg)
+  {
+    if (count == 0)
+    {
+      return;
+    }
+    // By default four chunks per worker, to absorb uneven chunk durations
+    const size_t chunks{4 * (worker_count_ + 1)};
+    const size_t chunk{(grain > 0) ? grain : (count + chunks - 1) / chunks};
+    if (count <= chunk || !workers_[0].GetHandle())
+    {
+      function(arg, 0, count);
+      return;
+    }
+    JobGroup group;
+    Submit(group, function, arg, 0, count, chunk);
+    Wait(group);
+  }
+
+  size_t JobPool::GetWorkerCount() const { return worker_count_; }
+
+  JobPool::Worker *JobPool::GetCurrentWorker()
+  {
+    const TaskHandle_t task{xTaskGetCurrentTaskHandle()};
+    for (size_t i{0}; i < worker_count_; ++i)
+    {
+      if (workers_[i].GetHandle() == task)
+      {
+        return &workers_[i];
+      }
+    }
+    return nullptr;
+  }
+
+  bool JobPool::Push(Job *const job, Worker *const worker)
+  {
+    if (worker)
+    {
+      return worker->deque_.Push(job);
+    }
+    portENTER_CRITICAL(&shared_lock_);
+    const bool pushed{shared_.Push(job)};
+    portEXIT_CRITICAL(&shared_lock_);
+    return pushed;
+  }
+
+  bool JobPool::RunOne(Worker *const worker)
+  {
+    Job *record{nullptr};
+    bool found{(worker && worker->deque_.Pop(record)) || shared_.Steal(record)};
+    for (size_t i{0}; i < worker_count_ && !found; ++i)
+    {
+      found = &workers_[i] != worker && workers_[i].deque_.Steal(record);
+    }
+    if (!found)
+    {
+      return false;
+    }
+    const Job job{*record};
+    jobs_.Release(record);
+    Execute(job, worker);
+    return true;
+  }
+
+  void JobPool::Execute(Job job, Worker *const worker)
+  {
+    bool pushed{false};
+    while (job.grain > 0 && job.end - job.begin > job.grain)
+    {
+      const size_t middle{job.begin + (job.end - job.begin) / 2};
+      job.group->pending_.fetch_add(1, std::memory_order_relaxed);
+      Job *const upper{jobs_.Acquire(Job{job.function, job.arg, middle, job.end, job.grain,
+                                         job.group})};
+      if (!upper || !Push(upper, worker))
+      {
+        jobs_.Release(upper);
+        job.group->pending_.fetch_sub(1, std::memory_order_relaxed);
+        break;
+      }
+      pushed = true;
+      job.end = middle;
+    }
+    if (pushed)
+    {
+      Notify(worker);
+    }
+
+    JobGroup &group{*job.group};
+    job.function(job.arg, job.begin, job.end);
+    // The waiting task holds its own reference, so reaching 0 means it is blocked on done_
+    if (group.pending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+      xSemaphoreGive(group.done_);
+    }
+  }
+
+  void JobPool::Notify(const Worker *const worker)
+  {
+    for (size_t i{0}; i < worker_count_; ++i)
+    {
+      if (&workers_[i] != worker && workers_[i].GetHandle())
+      {
+        xTaskNotifyGive(workers_[i].GetHandle());
+      }
+    }
+  }
+
+  void JobPool::Worker::Run()
+  {
+    while (true)
+    {
+      while (pool_.RunOne(this))
+      {
+      }
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+  }
+
+#endif
+
+} // namespace ESPTools
@@ -0,0 +1,344 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/logger.h"
+#include "ESPTools/object_pool.h"
+#include "ESPTools/task.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Maximum number of queued jobs per deque, and of jobs in flight. Must be a power of two.
+#ifndef ESPTOOLS_JOB_POOL_CAPACITY
+#define ESPTOOLS_JOB_POOL_CAPACITY 32
+#endif
+
+// Stack size in bytes of every worker task
+#ifndef ESPTOOLS_JOB_POOL_STACK_SIZE
+#define ESPTOOLS_JOB_POOL_STACK_SIZE 3072
+#endif
+
+// Compile-time log level of the JobPool module
+#ifndef ESPTOOLS_LOG_LEVEL_JOB_POOL
+#define ESPTOOLS_LOG_LEVEL_JOB_POOL ESPTOOLS_LOG_LEVEL
+#endif
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Fixed-capacity work-stealing deque (Chase and Lev, with the C11 memory orders of Lê et
+   * al.). The owner pushes and pops at the bottom without any read-modify-write, unless a single
+   * element is left, while any other context steals from the top with a compare-and-swap.
+   *
+   * @details Indices are free-running 32-bit counters compared through their signed difference,
+   * so they can wrap around. Unlike the original algorithm the buffer does not grow: `Push()`
+   * fails when it is full.
+   *
+   * @tparam T Type of the stored elements. Must be trivially copyable, typically a pointer.
+   * @tparam CAPACITY Maximum number of stored elements. Must be a power of two.
+   */
+  template <typename T, size_t CAPACITY>
+  class WorkStealingDeque
+  {
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0,
+                  "WorkStealingDeque capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "WorkStealingDeque elements must be trivially copyable");
+
+  public:
+    constexpr WorkStealingDeque() : top_(0), bottom_(0), buffer_() {}
+
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+    WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+    /**
+     * @brief Adds an element at the bottom. Must only be called by the owner.
+     *
+     * @return False if the deque is full
+     */
+    bool Push(const T &item)
+    {
+      const uint32_t bottom{bottom_.load(std::memory_order_relaxed)};
+      const uint32_t top{top_.load(std::memory_order_acquire)};
+      if (bottom - top >= CAPACITY)
+      {
+        return false;
+      }
+      buffer_[bottom & MASK].store(item, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return true;
+    }
+
+    /**
+     * @brief Takes the newest element, from the bottom. Must only be called by the owner.
+     *
+     * @return False if the deque is empty, or its last element was stolen meanwhile
+     */
+    bool Pop(T &item)
+    {
+      const uint32_t bottom{bottom_.load(std::memory_order_relaxed) - 1};
+      bottom_.store(bottom, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      uint32_t top{top_.load(std::memory_order_relaxed)};
+      if (static_cast<int32_t>(bottom - top) < 0)
+      {
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return false;
+      }
+      item = buffer_[bottom & MASK].load(std::memory_order_relaxed);
+      if (bottom != top)
+      {
+        return true;
+      }
+      // Last element, race against the thieves for it
+      const bool taken{top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed)};
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return taken;
+    }
+
+    /**
+     * @brief Takes the oldest element, from the top. Can be called from any task.
+     *
+     * @return False if the deque is empty, or another context took the element first
+     */
+    bool Steal(T &item)
+    {
+      uint32_t top{top_.load(std::memory_order_acquire)};
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      const uint32_t bottom{bottom_.load(std::memory_order_acquire)};
+      if (static_cast<int32_t>(bottom - top) <= 0)
+      {
+        return false;
+      }
+      item = buffer_[top & MASK].load(std::memory_order_relaxed);
+      return top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the number of stored elements. Only a snapshot if other contexts are using
+     * the deque.
+     */
+    size_t Size() const
+    {
+      const int32_t size{static_cast<int32_t>(bottom_.load(std::memory_order_relaxed) -
+                                              top_.load(std::memory_order_relaxed))};
+      return (size > 0) ? static_cast<size_t>(size) : 0;
+    }
+
+  private:
+    static constexpr uint32_t MASK{CAPACITY - 1};
+
+    std::atomic<uint32_t> top_;
+    std::atomic<uint32_t> bottom_;
+    std::atomic<T> buffer_[CAPACITY];
+  };
+
+  /**
+   * @brief Set of jobs submitted to a JobPool that can be waited for together. It must outlive
+   * its jobs, which `JobPool::Wait()` guarantees.
+   */
+  class JobGroup
+  {
+  public:
+    JobGroup();
+    ~JobGroup();
+
+    JobGroup(const JobGroup &) = delete;
+    JobGroup &operator=(const JobGroup &) = delete;
+
+  private:
+    friend class JobPool;
+
+#ifndef CONFIG_FREERTOS_UNICORE
+    // Jobs not completed yet, plus one reference held until `Wait()`
+    std::atomic<uint32_t> pending_;
+    // Given by the job that completes the group
+    StaticSemaphore_t done_buffer_;
+    SemaphoreHandle_t done_;
+#endif
+  };
+
+  /**
+   * @brief Runs short compute jobs (filters, checksums...) on one worker task per core, so the
+   * protocol core also works between the WiFi bursts. Every worker owns a WorkStealingDeque:
+   * it runs its own jobs newest first, and when it runs out it steals the oldest jobs of the
+   * other deques. The task that waits for a JobGroup also runs and steals jobs until the group
+   * completes, so it never sits idle.
+   *
+   * @details Range jobs, such as the ones of `ParallelFor()`, are split in halves by whoever runs
+   * them until they reach the grain size: the upper half is pushed to the deque of the worker
+   * (jobs run by other tasks push to a shared deque, guarded by a spinlock) and the lower half is
+   * run at once. The other cores steal the large halves first, which balances the load with few
+   * steals. Job records come from an ObjectPool, and a job that cannot be split because the pool
+   * or the deque is full just runs its whole range, so submitting never fails.
+   *
+   * With CONFIG_FREERTOS_UNICORE there is no other core to use: no worker is created and the jobs
+   * run inline on the calling task, with no synchronization at all.
+   */
+  class JobPool
+  {
+  public:
+    /**
+     * @brief Function of a job. Called with the range [begin, end) of its items, which is
+     * [0, 0) for the jobs that are not ranges.
+     */
+    using Function = void (*)(void *arg, size_t begin, size_t end);
+
+    /**
+     * @brief Initializes the workers without creating their tasks
+     *
+     * @param priority Priority of the worker tasks
+     * @param use_protocol_core If set to false, only the application core gets a worker
+     */
+    JobPool(const UBaseType_t priority = 1, const bool use_protocol_core = true);
+
+    ~JobPool();
+
+    JobPool(const JobPool &) = delete;
+    JobPool &operator=(const JobPool &) = delete;
+
+    /**
+     * @brief Creates the worker tasks
+     */
+    void Start();
+
+    /**
+     * @brief Submits a job
+     *
+     * @param group Group the job belongs to
+     * @param function Function of the job
+     * @param arg Argument passed to the function, must live until the group is waited for
+     * @param begin First item of the range
+     * @param end Item past the end of the range
+     * @param grain Number of items below which the range is not split, 0 to never split it
+     */
+    void Submit(JobGroup &group, const Function function, void *const arg,
+                const size_t begin = 0, const size_t end = 0, const size_t grain = 0);
+
+    /**
+     * @brief Runs jobs until all the jobs of the group are completed, then blocks until the last
+     * one returns. The group can be reused afterwards.
+     */
+    void Wait(JobGroup &group);
+
+    /**
+     * @brief Calls `function` over chunks of [0, count) in parallel and waits for all of them
+     *
+     * @param count Number of items
+     * @param grain Maximum number of items per call, 0 to choose it from the number of workers
+     * @param function Function called with every chunk
+     * @param arg Argument passed to the function
+     */
+    void ParallelFor(const size_t count, const size_t grain, const Function function,
+                     void *const arg);
+
+    /**
+     * @brief Same as the other `ParallelFor()`, with a callable
+     *
+     * @tparam Callable Callable with signature `void(size_t begin, size_t end)`
+     */
+    template <typename Callable>
+    void ParallelFor(const size_t count, const size_t grain, Callable &&callable)
+    {
+      using Type = std::remove_reference_t<Callable>;
+      ParallelFor(
+          count, grain, [](void *const arg, const size_t begin, const size_t end)
+          { (*static_cast<Type *>(arg))(begin, end); },
+          const_cast<void *>(static_cast<const void *>(&callable)));
+    }
+
+    /**
+     * @brief Returns the number of worker tasks, 0 on unicore builds
+     */
+    size_t GetWorkerCount() const;
+
+  private:
+    // Tag used for the logging system
+    static constexpr char LOG_TAG[]{ESPTOOLS_LOG_TAG_CREATOR("JobPool")};
+    // Compile-time log level of the module
+    static constexpr esp_log_level_t LOG_LEVEL{ESPTOOLS_LOG_LEVEL_JOB_POOL};
+
+#ifndef CONFIG_FREERTOS_UNICORE
+    struct Job
+    {
+      Function function;
+      void *arg;
+      size_t begin;
+      size_t end;
+      size_t grain;
+      JobGroup *group;
+    };
+
+    using Deque = WorkStealingDeque<Job *, ESPTOOLS_JOB_POOL_CAPACITY>;
+
+    /**
+     * @brief Worker task pinned to one core
+     */
+    class Worker : public StaticTask<ESPTOOLS_JOB_POOL_STACK_SIZE>
+    {
+    public:
+      Worker(JobPool &pool, const UBaseType_t priority, const CorePolicy core_policy)
+          : StaticTask("esptools_job", priority, core_policy), pool_(pool), deque_()
+      {
+      }
+
+      ~Worker() override { Stop(); }
+
+    protected:
+      void Run() override;
+
+    private:
+      friend class JobPool;
+
+      JobPool &pool_;
+      Deque deque_;
+    };
+
+    /**
+     * @brief Returns the worker running on the calling task, nullptr for other tasks
+     */
+    Worker *GetCurrentWorker();
+
+    /**
+     * @brief Queues a job on the deque of the worker, or on the shared deque without a worker
+     *
+     * @return False if the deque is full
+     */
+    bool Push(Job *const job, Worker *const worker);
+
+    /**
+     * @brief Takes a job, preferably from the own deque, and runs it
+     *
+     * @return False if no job was found
+     */
+    bool RunOne(Worker *const worker);
+
+    /**
+     * @brief Runs a job, splitting its range first. The job record is already released.
+     */
+    void Execute(Job job, Worker *const worker);
+
+    /**
+     * @brief Wakes up the workers other than the calling one
+     */
+    void Notify(const Worker *const worker);
+
+    Worker workers_[portNUM_PROCESSORS];
+    const size_t worker_count_;
+    // Jobs pushed by tasks that are not workers
+    Deque shared_;
+    portMUX_TYPE shared_lock_ = portMUX_INITIALIZER_UNLOCKED;
+    ObjectPool<Job, ESPTOOLS_JOB_POOL_CAPACITY> jobs_;
+#endif
+  };
+
+} // namespace ESPTools
@@ -0,0 +1,195 @@
+#include "ESPTools/log_capture.h"
+
+#include <esp_attr.h>
+#include <esp_system.h>
+#include <soc/soc_caps.h>
+
+#include <cstdio>
+
+#if defined(ESPTOOLS_LOG_CAPTURE_RTC) && SOC_RTC_SLOW_MEM_SUPPORTED
+#define ESPTOOLS_LOG_CAPTURE_ATTR RTC_NOINIT_ATTR
+#else
+#define ESPTOOLS_LOG_CAPTURE_ATTR __NOINIT_ATTR
+#endif
+
+namespace ESPTools
+{
+
+  namespace
+  {
+    static_assert((ESPTOOLS_LOG_CAPTURE_SIZE & (ESPTOOLS_LOG_CAPTURE_SIZE - 1)) == 0,
+                  "ESPTOOLS_LOG_CAPTURE_SIZE must be a power of two");
+
+    // Marks a buffer that holds valid data
+    constexpr uint32_t MAGIC{0x4c4f4743};
+    constexpr uint32_t MASK{ESPTOOLS_LOG_CAPTURE_SIZE - 1};
+
+    /**
+     * @brief Content kept across resets
+     */
+    struct CaptureBuffer
+    {
+      uint32_t magic;
+      // Absolute position of the next byte, the data is indexed modulo its size
+      uint32_t head;
+      char data[ESPTOOLS_LOG_CAPTURE_SIZE];
+    };
+
+    ESPTOOLS_LOG_CAPTURE_ATTR CaptureBuffer capture;
+    // Head at boot, the text before it was written before the current boot
+    uint32_t boot_head{0};
+    // Set by Init(), until then the content of the buffer cannot be trusted
+    bool capturing{false};
+
+    /**
+     * @brief Returns the letter printed by ESP_LOG for a level
+     */
+    char LevelLetter(const esp_log_level_t level)
+    {
+      switch (level)
+      {
+      case ESP_LOG_ERROR:
+        return 'E';
+      case ESP_LOG_WARN:
+        return 'W';
+      case ESP_LOG_INFO:
+        return 'I';
+      case ESP_LOG_DEBUG:
+        return 'D';
+      default:
+        return 'V';
+      }
+    }
+
+    /**
+     * @brief Returns the absolute range of the text written before the current boot that has not
+     * been overwritten yet
+     */
+    void GetPreviousBootRange(uint32_t &begin, uint32_t &end)
+    {
+      const uint32_t head{__atomic_load_n(&capture.head, __ATOMIC_RELAXED)};
+      end = boot_head;
+      begin = (head > ESPTOOLS_LOG_CAPTURE_SIZE) ? head - ESPTOOLS_LOG_CAPTURE_SIZE : 0;
+      if (begin >= end)
+      {
+        begin = end;
+        return;
+      }
+      // The oldest line is incomplete when the buffer has wrapped around
+      if (begin > 0)
+      {
+        while (begin < end && capture.data[begin & MASK] != '\n')
+        {
+          ++begin;
+        }
+        begin = (begin < end) ? begin + 1 : end;
+      }
+    }
+  } // namespace
+
+  void LogCapture::Init()
+  {
+    const esp_reset_reason_t reason{esp_reset_reason()};
+    if (capture.magic != MAGIC || reason == ESP_RST_POWERON || reason == ESP_RST_BROWNOUT)
+    {
+      capture.head = 0;
+      capture.magic = MAGIC;
+    }
+    boot_head = capture.head;
+    capturing = true;
+    Write(ESP_LOG_INFO, LOG_TAG, "Boot, reset reason %d", reason);
+  }
+
+  void LogCapture::Write(const esp_log_level_t level,
+                         const char *const tag,
+                         const char *const format, ...)
+  {
+    va_list args;
+    va_start(args, format);
+    WriteV(level, tag, format, args);
+    va_end(args);
+  }
+
+  void LogCapture::WriteV(const esp_log_level_t level,
+                          const char *const tag,
+                          const char *const format,
+                          va_list args)
+  {
+    if (!capturing)
+    {
+      return;
+    }
+
+    // Same layout as the ESP_LOG lines, without colors
+    char line[ESPTOOLS_LOG_CAPTURE_LINE_LENGTH];
+    const int prefix{snprintf(line, sizeof(line), "%c (%" PRIu32 ") %s: ", LevelLetter(level),
+                              esp_log_timestamp(), tag)};
+    size_t length{(prefix > 0) ? static_cast<size_t>(prefix) : 0};
+    if (length < sizeof(line))
+    {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+      const int message{vsnprintf(line + length, sizeof(line) - length, format, args)};
+#pragma GCC diagnostic pop
+      length += (message > 0) ? static_cast<size_t>(message) : 0;
+    }
+    // Truncated lines keep their line break
+    if (length > sizeof(line) - 2)
+    {
+      length = sizeof(line) - 2;
+    }
+    line[length++] = '\n';
+
+    // Reserve the bytes, the other writers continue after them
+    const uint32_t position{__atomic_fetch_add(&capture.head, static_cast<uint32_t>(length),
+                                               __ATOMIC_RELAXED)};
+    for (size_t i{0}; i < length; ++i)
+    {
+      capture.data[(position + i) & MASK] = line[i];
+    }
+  }
+
+  size_t LogCapture::ReadPreviousBoot(char *const buffer, const size_t size)
+  {
+    uint32_t begin;
+    uint32_t end;
+    GetPreviousBootRange(begin, end);
+    // Keep the newest text if the destination is too small
+    if (end - begin > size)
+    {
+      begin = end - static_cast<uint32_t>(size);
+    }
+    for (uint32_t position{begin}; position != end; ++position)
+    {
+      buffer[position - begin] = capture.data[position & MASK];
+    }
+    return end - begin;
+  }
+
+  void LogCapture::DumpPreviousBoot()
+  {
+    uint32_t begin;
+    uint32_t end;
+    GetPreviousBootRange(begin, end);
+    esp_log_write(ESP_LOG_INFO, LOG_TAG,
+                  LOG_FORMAT(I, "%" PRIu32 " bytes captured before the last reset:"),
+                  esp_log_timestamp(), LOG_TAG, end - begin);
+    // Up to two contiguous chunks, before and after the end of the buffer
+    while (begin != end)
+    {
+      const uint32_t offset{begin & MASK};
+      const uint32_t contiguous{ESPTOOLS_LOG_CAPTURE_SIZE - offset};
+      const uint32_t length{(end - begin < contiguous) ? end - begin : contiguous};
+      esp_log_write(ESP_LOG_INFO, LOG_TAG, "%.*s", static_cast<int>(length),
+                    &capture.data[offset]);
+      begin += length;
+    }
+  }
+
+  void LogCapture::Clear()
+  {
+    __atomic_store_n(&capture.head, 0, __ATOMIC_RELAXED);
+    boot_head = 0;
+  }
+
+} // namespace ESPTools
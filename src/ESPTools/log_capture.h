@@ -0,0 +1,101 @@
+#pragma once
+
+#include "ESPTools/core.h"
+
+#include <esp_log.h>
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+
+// Capacity in bytes of the capture buffer. Must be a power of two.
+#ifndef ESPTOOLS_LOG_CAPTURE_SIZE
+#define ESPTOOLS_LOG_CAPTURE_SIZE 4096
+#endif
+
+// Maximum length of a captured line, longer lines are truncated
+#ifndef ESPTOOLS_LOG_CAPTURE_LINE_LENGTH
+#define ESPTOOLS_LOG_CAPTURE_LINE_LENGTH 128
+#endif
+
+// Level up to which the ESPTOOLS_LOG* macros are captured. It is independent of the levels of
+// the console output, so warnings and errors are kept even when the output is disabled.
+#ifndef ESPTOOLS_LOG_CAPTURE_LEVEL
+#define ESPTOOLS_LOG_CAPTURE_LEVEL ESP_LOG_INFO
+#endif
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Keeps the last ESPTOOLS_LOG_CAPTURE_SIZE bytes of ESPTools log lines in a circular
+   * buffer that is not initialized at boot, so the lines written before a panic, a watchdog or a
+   * software reset can be dumped on the next boot. Enabled by defining `ESPTOOLS_LOG_CAPTURE`, in
+   * which case the `ESPTOOLS_LOG*` macros write every message up to ESPTOOLS_LOG_CAPTURE_LEVEL to
+   * the buffer in addition to the console.
+   *
+   * @details Writers reserve their bytes by atomically advancing the head of the buffer and then
+   * copy the line, so there is no lock and no allocation, and it can stay enabled in release
+   * builds. A writer that is lapped by the others (the buffer wraps around while it copies) may
+   * leave a mangled line, which is the price of never blocking. On the ESP32-C2, which lacks the
+   * RISC-V atomic extension, the atomic builtins are emulated by disabling the interrupts for a
+   * few instructions.
+   *
+   * The buffer is placed in the `.noinit` section of the internal RAM by default, which keeps its
+   * content across every reset except power-on and brownout. With `ESPTOOLS_LOG_CAPTURE_RTC` it is
+   * placed in the RTC slow memory instead (on the chips that have it), which also keeps it across
+   * deep sleep.
+   */
+  class LogCapture
+  {
+  public:
+    /**
+     * @brief Validates the buffer kept from the previous boot, or clears it after a power-on,
+     * and starts capturing. Must be called at boot, before any message is captured.
+     */
+    static void Init();
+
+    /**
+     * @brief Formats a line and adds it to the buffer. Called by the `ESPTOOLS_LOG*` macros.
+     *
+     * @param level Level of the message
+     * @param tag Tag of the message
+     * @param format Format string
+     */
+    [[gnu::format(printf, 3, 4)]] static void Write(const esp_log_level_t level,
+                                                    const char *const tag,
+                                                    const char *const format, ...);
+
+    /**
+     * @brief Same as `Write()`, with the arguments as a va_list
+     */
+    static void WriteV(const esp_log_level_t level,
+                       const char *const tag,
+                       const char *const format,
+                       va_list args);
+
+    /**
+     * @brief Copies the text captured before the current boot that is still in the buffer
+     *
+     * @param buffer Destination of the text, it is not null terminated
+     * @param size Size of the destination
+     * @return Number of copied bytes
+     */
+    static size_t ReadPreviousBoot(char *const buffer, const size_t size);
+
+    /**
+     * @brief Outputs the text captured before the current boot through `esp_log_write`
+     */
+    static void DumpPreviousBoot();
+
+    /**
+     * @brief Discards the whole content of the buffer
+     */
+    static void Clear();
+
+  private:
+    // Tag used for the logging system
+    static constexpr char LOG_TAG[]{ESPTOOLS_LOG_TAG_CREATOR("LogCapture")};
+  };
+
+} // namespace ESPTools
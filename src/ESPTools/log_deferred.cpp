@@ -0,0 +1,125 @@
+#include "ESPTools/logger.h"
+#include "ESPTools/log_deferred.h"
+#include "ESPTools/ring_buffer.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_attr.h>
+
+#include <atomic>
+#include <cstdio>
+#include <utility>
+
+namespace ESPTools
+{
+
+  namespace
+  {
+    // Records waiting to be formatted by the deferred log task
+    MpscRingBuffer<DeferredLogRecord, ESPTOOLS_LOG_DEFERRED_CAPACITY> records;
+    // Number of records dropped because the buffer was full
+    std::atomic<uint32_t> dropped_records{0};
+
+    /**
+     * @brief Formats a record, forwarding its ESPTOOLS_LOG_DEFERRED_MAX_ARGS words to snprintf
+     */
+    template <size_t... INDICES>
+    void Format(char *const line, const size_t size, const DeferredLogRecord &record,
+                std::index_sequence<INDICES...>)
+    {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+      snprintf(line, size, record.format, record.args[INDICES]...);
+#pragma GCC diagnostic pop
+    }
+  } // namespace
+
+  void DeferredLog::Start(const UBaseType_t priority,
+                          const BaseType_t core_id,
+                          const uint32_t period_ms)
+  {
+    static StackType_t stack[ESPTOOLS_LOG_DEFERRED_STACK_SIZE / sizeof(StackType_t)];
+    static StaticTask_t task_buffer;
+    static TaskHandle_t task{nullptr};
+    if (task)
+    {
+      ESPTOOLS_LOGW("Deferred log task already started");
+      return;
+    }
+
+    const TickType_t period{(pdMS_TO_TICKS(period_ms) > 0) ? pdMS_TO_TICKS(period_ms) : 1};
+    task = xTaskCreateStaticPinnedToCore(TaskEntry, "esptools_log",
+                                         sizeof(stack) / sizeof(StackType_t),
+                                         reinterpret_cast<void *>(static_cast<uintptr_t>(period)),
+                                         priority, stack, &task_buffer, core_id);
+  }
+
+  bool IRAM_ATTR DeferredLog::Push(const DeferredLogRecord &record)
+  {
+    if (records.Push(record))
+    {
+      return true;
+    }
+    dropped_records.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  uint32_t DeferredLog::GetDropCount()
+  {
+    return dropped_records.load(std::memory_order_relaxed);
+  }
+
+  void DeferredLog::Output(const DeferredLogRecord &record)
+  {
+    // Every argument occupies a single word, so the stored words can be forwarded as they are.
+    // Unused trailing words are ignored by the format string.
+    char line[ESPTOOLS_LOG_DEFERRED_LINE_LENGTH];
+    Format(line, sizeof(line), record, std::make_index_sequence<ESPTOOLS_LOG_DEFERRED_MAX_ARGS>());
+
+    switch (record.level)
+    {
+    case ESP_LOG_ERROR:
+      esp_log_write(record.level, record.tag, LOG_FORMAT(E, "%s"),
+                    record.timestamp, record.tag, line);
+      break;
+    case ESP_LOG_WARN:
+      esp_log_write(record.level, record.tag, LOG_FORMAT(W, "%s"),
+                    record.timestamp, record.tag, line);
+      break;
+    case ESP_LOG_INFO:
+      esp_log_write(record.level, record.tag, LOG_FORMAT(I, "%s"),
+                    record.timestamp, record.tag, line);
+      break;
+    case ESP_LOG_DEBUG:
+      esp_log_write(record.level, record.tag, LOG_FORMAT(D, "%s"),
+                    record.timestamp, record.tag, line);
+      break;
+    default:
+      esp_log_write(record.level, record.tag, LOG_FORMAT(V, "%s"),
+                    record.timestamp, record.tag, line);
+      break;
+    }
+  }
+
+  void DeferredLog::TaskEntry(void *arg)
+  {
+    const TickType_t period{static_cast<TickType_t>(reinterpret_cast<uintptr_t>(arg))};
+    uint32_t reported_drops{0};
+    while (true)
+    {
+      records.Drain(Output);
+      const uint32_t drops{dropped_records.load(std::memory_order_relaxed)};
+      if (drops != reported_drops)
+      {
+        // Output directly, queueing it could be dropped as well
+        esp_log_write(ESP_LOG_WARN, LOG_TAG,
+                      LOG_FORMAT(W, "%" PRIu32 " deferred log records dropped"),
+                      esp_log_timestamp(), LOG_TAG, drops - reported_drops);
+        reported_drops = drops;
+      }
+      vTaskDelay(period);
+    }
+  }
+
+} // namespace ESPTools
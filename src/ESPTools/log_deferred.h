@@ -0,0 +1,168 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/logger.h"
+
+#include <esp_attr.h>
+#include <esp_log.h>
+
+#include <cstdint>
+#include <type_traits>
+
+// Compile-time log level of the DeferredLog module
+#ifndef ESPTOOLS_LOG_LEVEL_DEFERRED_LOG
+#define ESPTOOLS_LOG_LEVEL_DEFERRED_LOG ESPTOOLS_LOG_LEVEL
+#endif
+
+// Maximum number of records waiting to be formatted. Must be a power of two.
+#ifndef ESPTOOLS_LOG_DEFERRED_CAPACITY
+#define ESPTOOLS_LOG_DEFERRED_CAPACITY 64
+#endif
+
+// Maximum number of arguments of a deferred record, including the caller function name
+#ifndef ESPTOOLS_LOG_DEFERRED_MAX_ARGS
+#define ESPTOOLS_LOG_DEFERRED_MAX_ARGS 8
+#endif
+
+// Maximum length of a formatted message, longer messages are truncated
+#ifndef ESPTOOLS_LOG_DEFERRED_LINE_LENGTH
+#define ESPTOOLS_LOG_DEFERRED_LINE_LENGTH 192
+#endif
+
+// Stack size in bytes of the task that formats and outputs the records
+#ifndef ESPTOOLS_LOG_DEFERRED_STACK_SIZE
+#define ESPTOOLS_LOG_DEFERRED_STACK_SIZE 3072
+#endif
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Binary log record queued by the `ESPTOOLS_LOG*` macros when `ESPTOOLS_LOG_DEFERRED`
+   * is defined. Only pointers and raw argument words are stored, the formatting is done later by
+   * the deferred log task.
+   */
+  struct DeferredLogRecord
+  {
+    static_assert(ESPTOOLS_LOG_DEFERRED_MAX_ARGS >= 1 && ESPTOOLS_LOG_DEFERRED_MAX_ARGS <= 255,
+                  "ESPTOOLS_LOG_DEFERRED_MAX_ARGS must be from 1 to 255");
+
+    const char *tag;
+    const char *format;
+    uint32_t timestamp;
+    esp_log_level_t level;
+    uint8_t argc;
+    uintptr_t args[ESPTOOLS_LOG_DEFERRED_MAX_ARGS];
+  };
+
+  /**
+   * @brief Converts a log argument to the word stored in a `DeferredLogRecord`
+   *
+   * @details Only arguments that are passed in a single word by the variadic calling convention
+   * are supported, so the stored words can be forwarded to `printf` as they are. Floating point
+   * values and, on the 32-bit ESP32 chips, 64-bit integers are rejected at compile time. Strings
+   * are stored as pointers, so they must outlive the record (string literals or static storage
+   * such as `GpioState::ToStr()`).
+   */
+  template <typename T>
+  constexpr uintptr_t EncodeDeferredLogArg(const T arg)
+  {
+    static_assert(!std::is_floating_point_v<T>,
+                  "Floating point arguments are not supported by the deferred logger");
+    static_assert(sizeof(T) <= sizeof(uintptr_t),
+                  "Arguments wider than a word are not supported by the deferred logger");
+    if constexpr (std::is_pointer_v<T>)
+    {
+      return reinterpret_cast<uintptr_t>(arg);
+    }
+    else
+    {
+      return static_cast<uintptr_t>(arg);
+    }
+  }
+
+  /**
+   * @brief Deferred logging backend. When `ESPTOOLS_LOG_DEFERRED` is defined the `ESPTOOLS_LOG*`
+   * macros only queue a `DeferredLogRecord`, which costs a few dozen cycles, and a low priority
+   * task formats and outputs it later through `esp_log`, so the caller never waits for the UART.
+   */
+  class DeferredLog
+  {
+  public:
+    /**
+     * @brief Starts the task that formats and outputs the queued records. Records queued before
+     * calling it are kept until the buffer is full.
+     *
+     * @param priority Priority of the task, it should be lower than the one of the application
+     * tasks
+     * @param core_id Core the task is pinned to
+     * @param period_ms Period in milliseconds at which the buffer is emptied
+     */
+    static void Start(const UBaseType_t priority = 1,
+                      const BaseType_t core_id = APP_CORE_ID,
+                      const uint32_t period_ms = 20);
+
+    /**
+     * @brief Pushes a record to the buffer. Lock-free, it can be called from any task or ISR.
+     *
+     * @param record Record to queue
+     * @return True if the record was queued, false if it was dropped because the buffer was full
+     */
+    static bool Push(const DeferredLogRecord &record);
+
+    /**
+     * @brief Returns the number of records dropped because the buffer was full
+     */
+    static uint32_t GetDropCount();
+
+  private:
+    // Tag used for the logging system
+    static constexpr char LOG_TAG[]{ESPTOOLS_LOG_TAG_CREATOR("DeferredLog")};
+    // Compile-time log level of the module
+    static constexpr esp_log_level_t LOG_LEVEL{ESPTOOLS_LOG_LEVEL_DEFERRED_LOG};
+
+    /**
+     * @brief Formats a record and outputs it with the same layout as the `ESP_LOG*` macros
+     *
+     * @param record Record to output
+     */
+    static void Output(const DeferredLogRecord &record);
+
+    /**
+     * @brief Task that periodically empties the buffer
+     *
+     * @param arg Period in ticks at which the buffer is emptied
+     */
+    static void TaskEntry(void *arg);
+  };
+
+  /**
+   * @brief Builds and queues a deferred log record. Called by the `ESPTOOLS_LOG*` macros.
+   *
+   * @param level Level of the message
+   * @param tag Tag of the message, must have static storage duration
+   * @param format Format string, must have static storage duration
+   * @param args Arguments of the format string
+   */
+  template <typename... Args>
+  IRAM_ATTR inline void WriteDeferredLog(const esp_log_level_t level,
+                                         const char *const tag,
+                                         const char *const format,
+                                         const Args... args)
+  {
+    static_assert(sizeof...(Args) <= ESPTOOLS_LOG_DEFERRED_MAX_ARGS,
+                  "Too many arguments for a deferred log record");
+    DeferredLog::Push({tag,
+                       format,
+                       esp_log_timestamp(),
+                       level,
+                       static_cast<uint8_t>(sizeof...(Args)),
+                       {EncodeDeferredLogArg(args)...}});
+  }
+
+  /**
+   * @brief Never called, only used to keep the compiler format checks on the deferred macros
+   */
+  [[gnu::format(printf, 1, 2)]] inline void CheckDeferredLogFormat(const char *, ...) {}
+
+} // namespace ESPTools
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <esp_timer.h>
+
+#include <atomic>
+#include <cstdint>
+
+// Default minimum interval in milliseconds between the messages of a rate limited call site
+#ifndef ESPTOOLS_LOG_RATE_LIMIT_INTERVAL_MS
+#define ESPTOOLS_LOG_RATE_LIMIT_INTERVAL_MS 1000
+#endif
+
+// Default number of messages a rate limited call site can output in a burst
+#ifndef ESPTOOLS_LOG_RATE_LIMIT_BURST
+#define ESPTOOLS_LOG_RATE_LIMIT_BURST 5
+#endif
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Token bucket used by the rate limited `ESPTOOLS_LOG*_RL` macros. Each call site owns
+   * a static instance, which lets `burst` messages through at once and then one message every
+   * `interval_ms`. The rest are counted, and the count is reported by the next message let through.
+   *
+   * @details The bucket is a single timestamp, the time at which it will be full again (GCRA,
+   * generic cell rate algorithm), so a check is a timer read, a subtraction and a compare. There is
+   * no lock: the state is accessed with relaxed loads and stores, which are plain memory accesses
+   * on every ESP32 chip. Calls from several tasks at the same time may let an extra message
+   * through or miss some suppressed messages in the count, which is acceptable for logging.
+   *
+   * Time is measured in units of 1024 us, taken from `esp_timer_get_time()` with a shift, so it
+   * wraps around after about 50 days. A call site that stays idle that long is detected as such,
+   * as its timestamp falls out of the window of the bucket.
+   */
+  class LogRateLimiter
+  {
+  public:
+    /**
+     * @param interval_ms Minimum interval between messages once the burst is spent
+     * @param burst Maximum number of messages let through at once
+     */
+    constexpr LogRateLimiter(const uint32_t interval_ms, const uint32_t burst)
+        : interval_(ToTicks(interval_ms)),
+          tolerance_(ToTicks(interval_ms) * (burst > 0 ? burst - 1 : 0)),
+          full_at_(0),
+          suppressed_(0)
+    {
+    }
+
+    /**
+     * @brief Takes a token from the bucket
+     *
+     * @param[out] suppressed Number of messages suppressed since the last message let through.
+     * Only set when the function returns true.
+     * @return True if the message can be output
+     */
+    bool Allow(uint32_t &suppressed)
+    {
+      const uint32_t now{static_cast<uint32_t>(esp_timer_get_time() >> 10)};
+      const uint32_t full_at{full_at_.load(std::memory_order_relaxed)};
+      // Distance of the full time into the future. A past time wraps to a large value.
+      const uint32_t ahead{full_at - now};
+      uint32_t next;
+      if (ahead > tolerance_ + interval_)
+      {
+        // Full bucket, the full time is in the past
+        next = now + interval_;
+      }
+      else if (ahead <= tolerance_)
+      {
+        next = full_at + interval_;
+      }
+      else
+      {
+        suppressed_.store(suppressed_.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+        return false;
+      }
+      full_at_.store(next, std::memory_order_relaxed);
+      suppressed = suppressed_.load(std::memory_order_relaxed);
+      if (suppressed)
+      {
+        suppressed_.store(0, std::memory_order_relaxed);
+      }
+      return true;
+    }
+
+  private:
+    /**
+     * @brief Converts milliseconds to units of 1024 us, rounding up
+     */
+    static constexpr uint32_t ToTicks(const uint32_t ms)
+    {
+      return static_cast<uint32_t>((static_cast<uint64_t>(ms) * 1000 + 1023) >> 10);
+    }
+
+    // Time between two tokens
+    const uint32_t interval_;
+    // How far into the future the full time can be while still letting messages through
+    const uint32_t tolerance_;
+    // Time at which the bucket will be full, i.e. the earliest time of the next message when no
+    // burst is allowed
+    std::atomic<uint32_t> full_at_;
+    // Messages suppressed since the last message let through
+    std::atomic<uint32_t> suppressed_;
+  };
+
+} // namespace ESPTools
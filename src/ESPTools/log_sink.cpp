@@ -0,0 +1,260 @@
+#include "ESPTools/logger.h"
+#include "ESPTools/log_sink.h"
+
+#include <driver/uart.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/ringbuf.h>
+#include <freertos/task.h>
+
+#include <atomic>
+#include <cstdio>
+
+namespace ESPTools
+{
+
+  namespace
+  {
+    // Pending lines, each one a separate item of the ring buffer
+    alignas(4) uint8_t storage[ESPTOOLS_LOG_SINK_BUFFER_SIZE];
+    StaticRingbuffer_t ringbuffer_buffer;
+    RingbufHandle_t lines{nullptr};
+    // Lines buffered and not yet handed to the UART driver
+    std::atomic<uint32_t> pending_lines{0};
+
+    TaskHandle_t task{nullptr};
+    uart_port_t output_port{UartLogSink::DEFAULT_PORT};
+    std::atomic<LogSinkPolicy> overflow_policy{LogSinkPolicy::DropNewest};
+    std::atomic<TickType_t> block_timeout{0};
+    // Output function replaced by the sink
+    vprintf_like_t previous_vprintf{nullptr};
+
+    // Dropped lines per level, index ESP_LOG_NONE counts the lines without a known level
+    std::atomic<uint32_t> dropped_lines[ESP_LOG_VERBOSE + 1]{};
+
+    /**
+     * @brief Returns the level of an esp_log line from its first letter, skipping the color
+     * escape sequence, or ESP_LOG_NONE if it does not start like one
+     */
+    esp_log_level_t GetLineLevel(const char *line, const size_t length)
+    {
+      const char *const end{line + length};
+      if (line < end && *line == '\033')
+      {
+        while (line < end && *line != 'm')
+        {
+          ++line;
+        }
+        line += (line < end) ? 1 : 0;
+      }
+      if (line + 1 >= end || line[1] != ' ')
+      {
+        return ESP_LOG_NONE;
+      }
+      switch (*line)
+      {
+      case 'E':
+        return ESP_LOG_ERROR;
+      case 'W':
+        return ESP_LOG_WARN;
+      case 'I':
+        return ESP_LOG_INFO;
+      case 'D':
+        return ESP_LOG_DEBUG;
+      case 'V':
+        return ESP_LOG_VERBOSE;
+      default:
+        return ESP_LOG_NONE;
+      }
+    }
+
+    void CountDrop(const char *const line, const size_t length)
+    {
+      dropped_lines[GetLineLevel(line, length)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Discards pending lines, oldest first, until `length` bytes fit in the buffer
+     *
+     * @return False if the buffer ran out of lines to discard
+     */
+    bool MakeRoom(const char *const line, const size_t length)
+    {
+      while (xRingbufferSend(lines, line, length, 0) != pdTRUE)
+      {
+        size_t size{0};
+        char *const oldest{static_cast<char *>(xRingbufferReceive(lines, &size, 0))};
+        if (!oldest)
+        {
+          // Either empty, or every line is being transmitted
+          return false;
+        }
+        CountDrop(oldest, size);
+        vRingbufferReturnItem(lines, oldest);
+        pending_lines.fetch_sub(1, std::memory_order_relaxed);
+      }
+      return true;
+    }
+  } // namespace
+
+  void UartLogSink::Start(const uart_port_t port,
+                          const uint32_t baud_rate,
+                          const LogSinkPolicy policy,
+                          const TickType_t timeout,
+                          const UBaseType_t priority,
+                          const BaseType_t core_id)
+  {
+    static StackType_t stack[ESPTOOLS_LOG_SINK_STACK_SIZE / sizeof(StackType_t)];
+    static StaticTask_t task_buffer;
+    if (previous_vprintf)
+    {
+      ESPTOOLS_LOGW("UART log sink already started");
+      return;
+    }
+
+    if (!uart_is_driver_installed(port))
+    {
+      // The driver requires a receive buffer larger than the FIFO, even if nothing is read
+      ESP_ERROR_CHECK(uart_driver_install(port, SOC_UART_FIFO_LEN * 2,
+                                          ESPTOOLS_LOG_SINK_UART_BUFFER_SIZE, 0, nullptr, 0));
+    }
+    if (task && port != output_port)
+    {
+      // Lines left by a previous run go to the UART they were written for
+      Flush(pdMS_TO_TICKS(100));
+    }
+    if (baud_rate != 0)
+    {
+      // Let the previous output leave at the old rate
+      uart_wait_tx_done(port, pdMS_TO_TICKS(100));
+      ESP_ERROR_CHECK(uart_set_baudrate(port, baud_rate));
+    }
+
+    output_port = port;
+    SetPolicy(policy, timeout);
+    if (!task)
+    {
+      lines = xRingbufferCreateStatic(sizeof(storage), RINGBUF_TYPE_NOSPLIT, storage,
+                                      &ringbuffer_buffer);
+      task = xTaskCreateStaticPinnedToCore(TaskEntry, "esptools_sink",
+                                           sizeof(stack) / sizeof(StackType_t), nullptr,
+                                           priority, stack, &task_buffer, core_id);
+    }
+    else
+    {
+      // Started again after Stop(): the task and its buffer are reused, on the same core
+      vTaskPrioritySet(task, priority);
+    }
+    previous_vprintf = esp_log_set_vprintf(VPrintf);
+    ESPTOOLS_LOGI("Log output buffered to UART %d", static_cast<int>(port));
+  }
+
+  void UartLogSink::Stop()
+  {
+    if (!previous_vprintf)
+    {
+      return;
+    }
+    esp_log_set_vprintf(previous_vprintf);
+    previous_vprintf = nullptr;
+  }
+
+  void UartLogSink::SetPolicy(const LogSinkPolicy policy, const TickType_t timeout)
+  {
+    block_timeout.store(timeout, std::memory_order_relaxed);
+    overflow_policy.store(policy, std::memory_order_relaxed);
+  }
+
+  uint32_t UartLogSink::GetDropCount(const esp_log_level_t level)
+  {
+    return (level <= ESP_LOG_VERBOSE) ? dropped_lines[level].load(std::memory_order_relaxed) : 0;
+  }
+
+  uint32_t UartLogSink::GetDropCount()
+  {
+    uint32_t total{0};
+    for (const std::atomic<uint32_t> &count : dropped_lines)
+    {
+      total += count.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  bool UartLogSink::Flush(const TickType_t timeout)
+  {
+    if (!task)
+    {
+      return true;
+    }
+    const TickType_t start{xTaskGetTickCount()};
+    while (pending_lines.load(std::memory_order_relaxed) != 0)
+    {
+      if (xTaskGetTickCount() - start >= timeout)
+      {
+        return false;
+      }
+      vTaskDelay(1);
+    }
+    const TickType_t elapsed{xTaskGetTickCount() - start};
+    return uart_wait_tx_done(output_port, (elapsed < timeout) ? timeout - elapsed : 0) == ESP_OK;
+  }
+
+  int UartLogSink::VPrintf(const char *const format, va_list args)
+  {
+    char line[ESPTOOLS_LOG_SINK_LINE_LENGTH];
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+    const int written{vsnprintf(line, sizeof(line), format, args)};
+#pragma GCC diagnostic pop
+    if (written <= 0)
+    {
+      return written;
+    }
+    // Truncated lines keep their end of line
+    size_t length{static_cast<size_t>(written)};
+    if (length >= sizeof(line))
+    {
+      length = sizeof(line) - 1;
+      line[length - 1] = '\n';
+    }
+
+    // Counted before sending, so the task never sees more lines sent than pending
+    pending_lines.fetch_add(1, std::memory_order_relaxed);
+    BaseType_t sent{pdFALSE};
+    switch (overflow_policy.load(std::memory_order_relaxed))
+    {
+    case LogSinkPolicy::DropOldest:
+      sent = MakeRoom(line, length) ? pdTRUE : pdFALSE;
+      break;
+    case LogSinkPolicy::DropNewest:
+      sent = xRingbufferSend(lines, line, length, 0);
+      break;
+    case LogSinkPolicy::Block:
+      sent = xRingbufferSend(lines, line, length, block_timeout.load(std::memory_order_relaxed));
+      break;
+    }
+    if (sent != pdTRUE)
+    {
+      pending_lines.fetch_sub(1, std::memory_order_relaxed);
+      CountDrop(line, length);
+    }
+    return written;
+  }
+
+  void UartLogSink::TaskEntry(void *)
+  {
+    while (true)
+    {
+      size_t size{0};
+      void *const line{xRingbufferReceive(lines, &size, portMAX_DELAY)};
+      if (!line)
+      {
+        continue;
+      }
+      // Blocks only while the TX buffer of the driver is full
+      uart_write_bytes(output_port, line, size);
+      vRingbufferReturnItem(lines, line);
+      pending_lines.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+
+} // namespace ESPTools
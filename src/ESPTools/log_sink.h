@@ -0,0 +1,151 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/logger.h"
+
+#include <driver/uart.h>
+#include <freertos/FreeRTOS.h>
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+
+// Compile-time log level of the UartLogSink module
+#ifndef ESPTOOLS_LOG_LEVEL_LOG_SINK
+#define ESPTOOLS_LOG_LEVEL_LOG_SINK ESPTOOLS_LOG_LEVEL
+#endif
+
+// Capacity in bytes of the buffer of pending lines
+#ifndef ESPTOOLS_LOG_SINK_BUFFER_SIZE
+#define ESPTOOLS_LOG_SINK_BUFFER_SIZE 8192
+#endif
+
+// Maximum length of a line, longer lines are truncated
+#ifndef ESPTOOLS_LOG_SINK_LINE_LENGTH
+#define ESPTOOLS_LOG_SINK_LINE_LENGTH 256
+#endif
+
+// Size of the TX buffer of the UART driver, emptied into the FIFO by its ISR
+#ifndef ESPTOOLS_LOG_SINK_UART_BUFFER_SIZE
+#define ESPTOOLS_LOG_SINK_UART_BUFFER_SIZE 1024
+#endif
+
+// Stack size in bytes of the task that feeds the UART driver
+#ifndef ESPTOOLS_LOG_SINK_STACK_SIZE
+#define ESPTOOLS_LOG_SINK_STACK_SIZE 2048
+#endif
+
+namespace ESPTools
+{
+
+  /**
+   * @brief What to do with a line that does not fit in the buffer of the UartLogSink
+   */
+  enum class LogSinkPolicy : uint8_t
+  {
+    // Discard the oldest pending lines until the new one fits
+    DropOldest,
+    // Discard the new line
+    DropNewest,
+    // Wait up to the configured timeout for room, then discard the new line
+    Block,
+  };
+
+  /**
+   * @brief Log output that never stalls the caller on the UART. Bound with `esp_log_set_vprintf`,
+   * so it receives every `ESP_LOG*` and `ESPTOOLS_LOG*` message (and the lines output by the
+   * DeferredLog task): each line is formatted into a buffer of ESPTOOLS_LOG_SINK_BUFFER_SIZE bytes
+   * and the call returns. A low priority task moves the lines into the TX buffer of the UART
+   * driver, whose ISR feeds the hardware FIFO, so the slow UART only ever blocks that task.
+   *
+   * @details When the buffer is full the line, or the oldest pending ones, are dropped according
+   * to the LogSinkPolicy, and counted per level so the losses can be reported. The level is taken
+   * from the letter that starts the lines of esp_log; other output (e.g. `esp_log_write` with a
+   * custom format) is counted under ESP_LOG_NONE.
+   *
+   * The chips have no DMA usable by the UART driver for transmission, which is why the transfer
+   * to the FIFO is interrupt driven. Messages logged from ISRs or before the scheduler starts
+   * (`ESP_EARLY_LOG*`, `ESP_DRAM_LOG*`) bypass esp_log_set_vprintf and are not buffered.
+   */
+  class UartLogSink
+  {
+  public:
+    // UART of the console
+    static constexpr uart_port_t DEFAULT_PORT{
+        static_cast<uart_port_t>(CONFIG_ESP_CONSOLE_UART_NUM)};
+
+    /**
+     * @brief Installs the UART driver if needed and redirects the log output to the sink
+     *
+     * @details The task and the buffer are created by the first call and kept by `Stop()`, so
+     * starting the sink again only redirects the output and applies the new settings, except
+     * `core_id`: the task stays on the core it was created on.
+     *
+     * @param port UART of the output, by default the console one
+     * @param baud_rate New baud rate of the UART, 0 to keep the current one
+     * @param policy What to do with the lines that do not fit in the buffer
+     * @param timeout Maximum time to wait for room with LogSinkPolicy::Block
+     * @param priority Priority of the task that feeds the UART driver
+     * @param core_id Core the task is pinned to
+     */
+    static void Start(const uart_port_t port = DEFAULT_PORT,
+                      const uint32_t baud_rate = 0,
+                      const LogSinkPolicy policy = LogSinkPolicy::DropNewest,
+                      const TickType_t timeout = pdMS_TO_TICKS(10),
+                      const UBaseType_t priority = 1,
+                      const BaseType_t core_id = APP_CORE_ID);
+
+    /**
+     * @brief Restores the previous log output. The pending lines are still transmitted, and the
+     * sink can be started again.
+     */
+    static void Stop();
+
+    /**
+     * @brief Changes the overflow policy
+     *
+     * @param policy What to do with the lines that do not fit in the buffer
+     * @param timeout Maximum time to wait for room with LogSinkPolicy::Block
+     */
+    static void SetPolicy(const LogSinkPolicy policy, const TickType_t timeout = pdMS_TO_TICKS(10));
+
+    /**
+     * @brief Returns the number of dropped lines of a level
+     *
+     * @param level Level of the lines, ESP_LOG_NONE for the lines without a known level
+     */
+    static uint32_t GetDropCount(const esp_log_level_t level);
+
+    /**
+     * @brief Returns the number of dropped lines of every level
+     */
+    static uint32_t GetDropCount();
+
+    /**
+     * @brief Waits until every pending line has been transmitted
+     *
+     * @param timeout Maximum time to wait
+     * @return False on timeout
+     */
+    static bool Flush(const TickType_t timeout = portMAX_DELAY);
+
+  private:
+    // Tag used for the logging system
+    static constexpr char LOG_TAG[]{ESPTOOLS_LOG_TAG_CREATOR("UartLogSink")};
+    // Compile-time log level of the module
+    static constexpr esp_log_level_t LOG_LEVEL{ESPTOOLS_LOG_LEVEL_LOG_SINK};
+
+    /**
+     * @brief Output function given to `esp_log_set_vprintf`, buffers a line
+     */
+    static int VPrintf(const char *format, va_list args);
+
+    /**
+     * @brief Task that moves the buffered lines to the UART driver
+     *
+     * @param arg Unused
+     */
+    static void TaskEntry(void *arg);
+  };
+
+} // namespace ESPTools
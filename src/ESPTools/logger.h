@@ -1,20 +1,173 @@
 #pragma once
 
 #include "ESPTools/core.h"
+#include "ESPTools/log_rate_limit.h"
 
 #ifdef ESPTOOLS_DEBUG
 #define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
 #endif
 #include <esp_log.h>
 
-// Macros used for logging. Wrapper around ESP log macros that include the caller function
+// Default compile-time log level of the ESPTools modules. Calls above the level of their module
+// are removed at compile time, so neither their format strings nor the runtime level lookup reach
+// the binary. The level of each module can be overridden with ESPTOOLS_LOG_LEVEL_<MODULE>, e.g.
+// `-D ESPTOOLS_LOG_LEVEL_GPIO_INPUT=ESP_LOG_WARN`.
+#ifndef ESPTOOLS_LOG_LEVEL
+#ifdef ESPTOOLS_DEBUG
+#define ESPTOOLS_LOG_LEVEL ESP_LOG_VERBOSE
+#else
+#define ESPTOOLS_LOG_LEVEL LOG_LOCAL_LEVEL
+#endif
+#endif
+
+// Compile-time log level used by the ESPTOOLS_LOG* macros outside of the ESPTools modules. Like
+// LOG_TAG, it can be shadowed by a LOG_LEVEL constant declared in an inner scope.
+static constexpr esp_log_level_t LOG_LEVEL{ESPTOOLS_LOG_LEVEL};
+
+namespace ESPTools
+{
+
+  // Compile-time log level of the ESPTools master tag
+  static constexpr esp_log_level_t LOG_LEVEL{ESPTOOLS_LOG_LEVEL};
+
+} // namespace ESPTools
+
+#ifdef ESPTOOLS_LOG_CAPTURE
+#include "ESPTools/log_capture.h"
+
+// Copies the message to the crash persistent capture buffer (see `ESPTools::LogCapture`). The
+// level check is independent of LOG_LEVEL, so it works even when the console output is disabled.
+#define ESPTOOLS_LOG_CAPTURE_WRITE(level, format, ...)                                     \
+    if constexpr (ESPTOOLS_LOG_CAPTURE_LEVEL >= level)                                     \
+    {                                                                                      \
+        ESPTools::LogCapture::Write(level, LOG_TAG, "[%s] " format,                        \
+                                    __func__ __VA_OPT__(, ) __VA_ARGS__);                  \
+    }
+// Whether a message of the level reaches the console or the capture buffer
+#define ESPTOOLS_LOG_ENABLED(level) (LOG_LEVEL >= (level) || ESPTOOLS_LOG_CAPTURE_LEVEL >= (level))
+#else
+#define ESPTOOLS_LOG_CAPTURE_WRITE(level, format, ...)
+#define ESPTOOLS_LOG_ENABLED(level) (LOG_LEVEL >= (level))
+#endif
+
+#ifdef ESPTOOLS_LOG_DEFERRED
+#include "ESPTools/log_deferred.h"
+
+// Deferred variant of the logging macros. The records are only queued, and they are formatted and
+// output later by the task started with `ESPTools::DeferredLog::Start()`. Arguments must fit in a
+// word and strings must have static storage duration (see `ESPTools::EncodeDeferredLogArg`).
+#define ESPTOOLS_LOG_WRITE(level, format, ...)                                             \
+    do                                                                                     \
+    {                                                                                      \
+        ESPTOOLS_LOG_CAPTURE_WRITE(level, format __VA_OPT__(, ) __VA_ARGS__)               \
+        if constexpr (LOG_LEVEL >= level)                                                  \
+        {                                                                                  \
+            if (false)                                                                     \
+            {                                                                              \
+                ESPTools::CheckDeferredLogFormat("[%s] " format,                           \
+                                                 __func__ __VA_OPT__(, ) __VA_ARGS__);     \
+            }                                                                              \
+            ESPTools::WriteDeferredLog(level, LOG_TAG, "[%s] " format,                     \
+                                       __func__ __VA_OPT__(, ) __VA_ARGS__);               \
+        }                                                                                  \
+    } while (0)
+#else
+// Wrapper around the ESP log macros that includes the caller function. The level check against
+// LOG_LEVEL is resolved at compile time.
+#define ESPTOOLS_LOG_WRITE(level, format, ...)                                             \
+    do                                                                                     \
+    {                                                                                      \
+        ESPTOOLS_LOG_CAPTURE_WRITE(level, format __VA_OPT__(, ) __VA_ARGS__)               \
+        if constexpr (LOG_LEVEL >= level)                                                  \
+        {                                                                                  \
+            ESP_LOG_LEVEL(level, LOG_TAG, "[%s] " format,                                  \
+                          __func__ __VA_OPT__(, ) __VA_ARGS__);                            \
+        }                                                                                  \
+    } while (0)
+#endif
+
+// Macros used for logging
 #define ESPTOOLS_LOGV(format, ...) \
-    ESP_LOGV(LOG_TAG, "[%s] " format, __func__ __VA_OPT__(, ) __VA_ARGS__)
+    ESPTOOLS_LOG_WRITE(ESP_LOG_VERBOSE, format __VA_OPT__(, ) __VA_ARGS__)
 #define ESPTOOLS_LOGD(format, ...) \
-    ESP_LOGD(LOG_TAG, "[%s] " format, __func__ __VA_OPT__(, ) __VA_ARGS__)
+    ESPTOOLS_LOG_WRITE(ESP_LOG_DEBUG, format __VA_OPT__(, ) __VA_ARGS__)
 #define ESPTOOLS_LOGI(format, ...) \
-    ESP_LOGI(LOG_TAG, "[%s] " format, __func__ __VA_OPT__(, ) __VA_ARGS__)
+    ESPTOOLS_LOG_WRITE(ESP_LOG_INFO, format __VA_OPT__(, ) __VA_ARGS__)
 #define ESPTOOLS_LOGW(format, ...) \
-    ESP_LOGW(LOG_TAG, "[%s] " format, __func__ __VA_OPT__(, ) __VA_ARGS__)
+    ESPTOOLS_LOG_WRITE(ESP_LOG_WARN, format __VA_OPT__(, ) __VA_ARGS__)
 #define ESPTOOLS_LOGE(format, ...) \
-    ESP_LOGE(LOG_TAG, "[%s] " format, __func__ __VA_OPT__(, ) __VA_ARGS__)
+    ESPTOOLS_LOG_WRITE(ESP_LOG_ERROR, format __VA_OPT__(, ) __VA_ARGS__)
+
+// Rate limited variant of ESPTOOLS_LOG_WRITE. Every call site gets its own static token bucket
+// (see `ESPTools::LogRateLimiter`), which lets `burst` messages through at once and then one
+// every `interval_ms`. The first message let through after some were dropped is preceded by a
+// single "Suppressed N messages" line. The bucket is removed along with the message when the
+// level is compiled out.
+#define ESPTOOLS_LOG_WRITE_RATE_LIMITED(level, interval_ms, burst, format, ...)            \
+    do                                                                                     \
+    {                                                                                      \
+        if constexpr (ESPTOOLS_LOG_ENABLED(level))                                         \
+        {                                                                                  \
+            static constinit ESPTools::LogRateLimiter esptools_log_rate_limiter{           \
+                interval_ms, burst};                                                       \
+            uint32_t esptools_log_suppressed;                                              \
+            if (esptools_log_rate_limiter.Allow(esptools_log_suppressed))                  \
+            {                                                                              \
+                if (esptools_log_suppressed)                                               \
+                {                                                                          \
+                    ESPTOOLS_LOG_WRITE(level, "Suppressed %" PRIu32 " messages",           \
+                                       esptools_log_suppressed);                           \
+                }                                                                          \
+                ESPTOOLS_LOG_WRITE(level, format __VA_OPT__(, ) __VA_ARGS__);              \
+            }                                                                              \
+        }                                                                                  \
+    } while (0)
+
+// Rate limited macros, with the default limits ESPTOOLS_LOG_RATE_LIMIT_INTERVAL_MS and
+// ESPTOOLS_LOG_RATE_LIMIT_BURST. Meant for messages that can repeat in a fast loop, such as the
+// errors of a failing sensor.
+#define ESPTOOLS_LOG_WRITE_RL(level, format, ...)                                          \
+    ESPTOOLS_LOG_WRITE_RATE_LIMITED(level, ESPTOOLS_LOG_RATE_LIMIT_INTERVAL_MS,            \
+                                    ESPTOOLS_LOG_RATE_LIMIT_BURST,                         \
+                                    format __VA_OPT__(, ) __VA_ARGS__)
+#define ESPTOOLS_LOGV_RL(format, ...) \
+    ESPTOOLS_LOG_WRITE_RL(ESP_LOG_VERBOSE, format __VA_OPT__(, ) __VA_ARGS__)
+#define ESPTOOLS_LOGD_RL(format, ...) \
+    ESPTOOLS_LOG_WRITE_RL(ESP_LOG_DEBUG, format __VA_OPT__(, ) __VA_ARGS__)
+#define ESPTOOLS_LOGI_RL(format, ...) \
+    ESPTOOLS_LOG_WRITE_RL(ESP_LOG_INFO, format __VA_OPT__(, ) __VA_ARGS__)
+#define ESPTOOLS_LOGW_RL(format, ...) \
+    ESPTOOLS_LOG_WRITE_RL(ESP_LOG_WARN, format __VA_OPT__(, ) __VA_ARGS__)
+#define ESPTOOLS_LOGE_RL(format, ...) \
+    ESPTOOLS_LOG_WRITE_RL(ESP_LOG_ERROR, format __VA_OPT__(, ) __VA_ARGS__)
+
+// Tracing of hot paths (see `ESPTools::Trace`), compiled in by default in debug builds only. In
+// release builds the macros expand to nothing unless `-D ESPTOOLS_TRACE=1` is given.
+#ifndef ESPTOOLS_TRACE
+#ifdef ESPTOOLS_DEBUG
+#define ESPTOOLS_TRACE 1
+#else
+#define ESPTOOLS_TRACE 0
+#endif
+#endif
+
+#if ESPTOOLS_TRACE
+#include "ESPTools/trace.h"
+
+#define ESPTOOLS_TRACE_CONCAT_IMPL(a, b) a##b
+#define ESPTOOLS_TRACE_CONCAT(a, b) ESPTOOLS_TRACE_CONCAT_IMPL(a, b)
+// Records the beginning and the end of the enclosing scope. The name must be a string literal.
+#define ESPTOOLS_TRACE_SCOPE(name) \
+    const ESPTools::TraceScope ESPTOOLS_TRACE_CONCAT(esptools_trace_scope_, __LINE__) { name }
+// Records the value of a counter. The name must be a string literal.
+#define ESPTOOLS_TRACE_COUNTER(name, value) ESPTools::Trace::Counter(name, value)
+#else
+#define ESPTOOLS_TRACE_SCOPE(name) \
+    do                             \
+    {                              \
+    } while (0)
+#define ESPTOOLS_TRACE_COUNTER(name, value) \
+    do                                      \
+    {                                       \
+    } while (0)
+#endif
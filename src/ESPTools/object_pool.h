@@ -0,0 +1,235 @@
+#pragma once
+
+#include "ESPTools/core.h"
+
+#include <esp_attr.h>
+#include <esp_err.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Fixed-capacity pool of objects of a single type, with O(1) `Acquire()` and `Release()`.
+   * All the memory is reserved up front, so objects can be created and destroyed repeatedly
+   * without fragmenting the heap or paying the variable latency of `malloc()`. Intended as the
+   * default allocator of the ESPTools subsystems that need short-lived records.
+   *
+   * @details Free slots are linked through an intrusive free list stored inside the unused slots
+   * themselves, so the pool has no per-object overhead. Slots that were never used are handed out
+   * from a bump index, which keeps the pool constant initialized (no construction order issues
+   * when declared at namespace scope). Accesses are serialized with a spinlock critical section,
+   * which is a few instructions long.
+   *
+   * @tparam T Type of the pooled objects
+   * @tparam N Number of objects in the pool
+   * @tparam ISR_SAFE If set to true, the pool can also be used from ISRs. Its methods are placed in
+   * IRAM and use `portENTER_CRITICAL_SAFE()`. Objects acquired from an ISR must be trivially
+   * constructible in practice, as their constructor also runs in the ISR. Task-only pools keep
+   * their code in flash, so they do not use up IRAM.
+   * @tparam CAPS Heap capabilities (`MALLOC_CAP_*`) of the storage. With the default value of 0 the
+   * storage is part of the pool object itself (static memory when the pool is static). Otherwise
+   * it is allocated once from the heap in the constructor, e.g. with `MALLOC_CAP_DMA` for buffers
+   * accessed by a peripheral or `MALLOC_CAP_INTERNAL` to keep them off the PSRAM.
+   */
+  template <typename T, size_t N, bool ISR_SAFE = false, uint32_t CAPS = 0>
+  class ObjectPool
+  {
+    static_assert(N > 0, "ObjectPool needs room for at least one object");
+
+  public:
+    constexpr ObjectPool()
+        : slots_(), free_list_(nullptr), unused_(0), available_(N), min_available_(N)
+    {
+      if constexpr (CAPS != 0)
+      {
+        slots_ = static_cast<Slot *>(
+            heap_caps_aligned_alloc(alignof(Slot), sizeof(Slot) * N, CAPS));
+        ESP_ERROR_CHECK(slots_ ? ESP_OK : ESP_ERR_NO_MEM);
+      }
+    }
+
+    /**
+     * @brief Frees the heap storage, if any. Objects still acquired are not destroyed.
+     */
+    ~ObjectPool()
+    {
+      if constexpr (CAPS != 0)
+      {
+        heap_caps_free(slots_);
+      }
+    }
+
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool &operator=(const ObjectPool &) = delete;
+
+    /**
+     * @brief Returns the number of objects of the pool
+     */
+    static constexpr size_t Capacity() { return N; }
+
+    /**
+     * @brief Takes a free slot and constructs an object in it
+     *
+     * @param args Arguments forwarded to the constructor of T
+     * @return Pointer to the new object, nullptr if the pool is exhausted
+     */
+    template <typename... Args>
+    T *Acquire(Args &&...args)
+      requires(!ISR_SAFE)
+    {
+      void *const slot{Allocate()};
+      return slot ? new (slot) T(std::forward<Args>(args)...) : nullptr;
+    }
+
+    template <typename... Args>
+    IRAM_ATTR T *Acquire(Args &&...args)
+      requires(ISR_SAFE)
+    {
+      void *const slot{Allocate()};
+      return slot ? new (slot) T(std::forward<Args>(args)...) : nullptr;
+    }
+
+    /**
+     * @brief Destroys an object and returns its slot to the pool
+     *
+     * @param object Object obtained from `Acquire()` of this same pool. nullptr is ignored.
+     */
+    void Release(T *const object)
+      requires(!ISR_SAFE)
+    {
+      if (object)
+      {
+        object->~T();
+        Deallocate(object);
+      }
+    }
+
+    IRAM_ATTR void Release(T *const object)
+      requires(ISR_SAFE)
+    {
+      if (object)
+      {
+        object->~T();
+        Deallocate(object);
+      }
+    }
+
+    /**
+     * @brief Checks if an object belongs to the storage of this pool
+     *
+     * @param object Pointer to check
+     */
+    bool Owns(const T *const object) const
+    {
+      const auto address{reinterpret_cast<uintptr_t>(object)};
+      return address >= reinterpret_cast<uintptr_t>(&slots_[0]) &&
+             address < reinterpret_cast<uintptr_t>(&slots_[0] + N);
+    }
+
+    /**
+     * @brief Returns the number of free objects
+     */
+    size_t GetAvailable() const { return available_; }
+
+    /**
+     * @brief Returns the lowest number of free objects seen since the creation of the pool. Useful
+     * to size N.
+     */
+    size_t GetMinAvailable() const { return min_available_; }
+
+  private:
+    union Slot
+    {
+      Slot *next{nullptr};
+      alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    // The helpers are always inlined, so they end up in the section of Acquire() and Release()
+
+    /**
+     * @brief Takes a slot from the free list or, if empty, from the never used ones
+     *
+     * @return Memory of the slot, nullptr if the pool is exhausted
+     */
+    [[gnu::always_inline]] void *Allocate()
+    {
+      Lock();
+      Slot *slot{free_list_};
+      if (slot)
+      {
+        free_list_ = slot->next;
+      }
+      else if (unused_ < N)
+      {
+        slot = &slots_[unused_++];
+      }
+      if (slot && --available_ < min_available_)
+      {
+        min_available_ = available_;
+      }
+      Unlock();
+      return slot ? slot->storage : nullptr;
+    }
+
+    /**
+     * @brief Pushes a slot onto the free list
+     *
+     * @param memory Memory of the slot
+     */
+    [[gnu::always_inline]] void Deallocate(void *const memory)
+    {
+      Slot *const slot{static_cast<Slot *>(memory)};
+      Lock();
+      slot->next = free_list_;
+      free_list_ = slot;
+      ++available_;
+      Unlock();
+    }
+
+    [[gnu::always_inline]] void Lock()
+    {
+      if constexpr (ISR_SAFE)
+      {
+        portENTER_CRITICAL_SAFE(&lock_);
+      }
+      else
+      {
+        portENTER_CRITICAL(&lock_);
+      }
+    }
+
+    [[gnu::always_inline]] void Unlock()
+    {
+      if constexpr (ISR_SAFE)
+      {
+        portEXIT_CRITICAL_SAFE(&lock_);
+      }
+      else
+      {
+        portEXIT_CRITICAL(&lock_);
+      }
+    }
+
+    std::conditional_t<CAPS == 0, Slot[N], Slot *> slots_;
+    Slot *free_list_;
+    size_t unused_;
+    size_t available_;
+    size_t min_available_;
+    portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+  };
+
+  /**
+   * @brief ObjectPool that can be used both from tasks and ISRs
+   */
+  template <typename T, size_t N, uint32_t CAPS = 0>
+  using IsrObjectPool = ObjectPool<T, N, true, CAPS>;
+
+} // namespace ESPTools
@@ -0,0 +1,114 @@
+#include "ESPTools/logger.h"
+#include "ESPTools/perf_lock.h"
+
+#include <esp_attr.h>
+#include <esp_pm.h>
+#include <esp_timer.h>
+
+namespace ESPTools
+{
+
+  PerfLock::PerfLock(const esp_pm_lock_type_t type, const char *const name)
+      : name_(name),
+        handle_(nullptr),
+        depth_(0),
+        since_us_(0),
+        created_us_(esp_timer_get_time()),
+        held_us_(0),
+        holds_()
+  {
+    const esp_err_t result{esp_pm_lock_create(type, 0, name_, &handle_)};
+    if (result == ESP_ERR_NOT_SUPPORTED)
+    {
+      handle_ = nullptr;
+      ESPTOOLS_LOGW("Power management disabled, lock \"%s\" is only measured", name_);
+      return;
+    }
+    ESP_ERROR_CHECK(result);
+  }
+
+  PerfLock::~PerfLock()
+  {
+    if (handle_)
+    {
+      ESP_ERROR_CHECK(esp_pm_lock_delete(handle_));
+    }
+  }
+
+  void IRAM_ATTR PerfLock::Acquire()
+  {
+    // Taken before the hold starts, so the measured time includes the frequency switch
+    if (handle_)
+    {
+      esp_pm_lock_acquire(handle_);
+    }
+    const int64_t now_us{esp_timer_get_time()};
+    portENTER_CRITICAL_SAFE(&lock_);
+    if (depth_++ == 0)
+    {
+      since_us_ = now_us;
+    }
+    portEXIT_CRITICAL_SAFE(&lock_);
+  }
+
+  void IRAM_ATTR PerfLock::Release()
+  {
+    const int64_t now_us{esp_timer_get_time()};
+    portENTER_CRITICAL_SAFE(&lock_);
+    const bool held{depth_ > 0};
+    if (held && --depth_ == 0)
+    {
+      const int64_t hold_us{now_us - since_us_};
+      held_us_ += hold_us;
+      holds_.Add((hold_us < UINT32_MAX) ? static_cast<uint32_t>(hold_us) : UINT32_MAX);
+    }
+    portEXIT_CRITICAL_SAFE(&lock_);
+    if (held && handle_)
+    {
+      esp_pm_lock_release(handle_);
+    }
+  }
+
+  PerfLockStats PerfLock::GetStats() const
+  {
+    const int64_t now_us{esp_timer_get_time()};
+    portENTER_CRITICAL(&lock_);
+    const PerfLockStats stats{
+        .held_us = held_us_ + ((depth_ > 0) ? now_us - since_us_ : 0),
+        .lifetime_us = now_us - created_us_,
+        .holds = holds_,
+        .held = depth_ > 0,
+    };
+    portEXIT_CRITICAL(&lock_);
+    return stats;
+  }
+
+  void PerfLock::ResetStats()
+  {
+    const int64_t now_us{esp_timer_get_time()};
+    portENTER_CRITICAL(&lock_);
+    since_us_ = now_us;
+    created_us_ = now_us;
+    held_us_ = 0;
+    holds_.Reset();
+    portEXIT_CRITICAL(&lock_);
+  }
+
+  void PerfLock::Report() const
+  {
+    const PerfLockStats stats{GetStats()};
+    const int64_t lifetime_us{(stats.lifetime_us > 0) ? stats.lifetime_us : 1};
+    // Tenths of a percent, to log the duty cycle without floating point
+    const uint32_t duty{static_cast<uint32_t>(stats.held_us * 1000 / lifetime_us)};
+    // Milliseconds as 32-bit words, which deferred logging can store
+    ESPTOOLS_LOGI("%s: held %" PRIu32 " ms of %" PRIu32 " ms (%" PRIu32 ".%" PRIu32 "%%)%s",
+                  name_, static_cast<uint32_t>(stats.held_us / 1000),
+                  static_cast<uint32_t>(lifetime_us / 1000), duty / 10, duty % 10,
+                  stats.held ? ", held now" : "");
+    ESPTOOLS_LOGI("%s: %" PRIu32 " holds, duration min/mean/max %" PRIu32 "/%" PRIu32 "/%" PRIu32
+                  " us",
+                  name_, stats.holds.GetCount(), stats.holds.GetMin(), stats.holds.GetMean(),
+                  stats.holds.GetMax());
+  }
+
+} // namespace ESPTools
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/logger.h"
+#include "ESPTools/stats.h"
+
+#include <esp_pm.h>
+#include <freertos/FreeRTOS.h>
+
+#include <cstdint>
+
+// Compile-time log level of the PerfLock module
+#ifndef ESPTOOLS_LOG_LEVEL_PERF_LOCK
+#define ESPTOOLS_LOG_LEVEL_PERF_LOCK ESPTOOLS_LOG_LEVEL
+#endif
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Time a PerfLock has been held
+   */
+  struct PerfLockStats
+  {
+    // Total time held in microseconds, including the current hold
+    int64_t held_us;
+    // Time since the lock was created in microseconds
+    int64_t lifetime_us;
+    // Durations of the completed holds in microseconds
+    RunningStats<uint32_t> holds;
+    // True while the lock is held
+    bool held;
+  };
+
+  /**
+   * @brief Power management lock (`esp_pm`) that measures how long it is held. Held around
+   * latency critical work, e.g. with ESP_PM_CPU_FREQ_MAX or ESP_PM_NO_LIGHT_SLEEP, it lets the
+   * automatic light sleep and frequency scaling run at low power the rest of the time, and the
+   * statistics show what the bursts actually cost.
+   *
+   * @details Acquisitions nest, and the time is measured from the first acquisition to the last
+   * release. Both can be called from any task or ISR. Without CONFIG_PM_ENABLE the esp_pm lock
+   * cannot be created, and the object only measures the time.
+   */
+  class PerfLock
+  {
+  public:
+    /**
+     * @brief Creates the esp_pm lock
+     *
+     * @param type Type of the lock
+     * @param name Name of the lock, must have static storage duration
+     */
+    PerfLock(const esp_pm_lock_type_t type, const char *const name);
+
+    /**
+     * @brief Deletes the esp_pm lock. The lock must not be held.
+     */
+    ~PerfLock();
+
+    PerfLock(const PerfLock &) = delete;
+    PerfLock &operator=(const PerfLock &) = delete;
+
+    /**
+     * @brief Takes the lock, or one more level of it if it is already held
+     */
+    void Acquire();
+
+    /**
+     * @brief Releases one level of the lock. Unbalanced releases are ignored.
+     */
+    void Release();
+
+    /**
+     * @brief Returns the name of the lock
+     */
+    const char *GetName() const { return name_; }
+
+    /**
+     * @brief Returns a consistent copy of the statistics
+     */
+    PerfLockStats GetStats() const;
+
+    /**
+     * @brief Discards the statistics, the current hold is measured from now
+     */
+    void ResetStats();
+
+    /**
+     * @brief Logs the statistics
+     */
+    void Report() const;
+
+  private:
+    // Tag used for the logging system
+    static constexpr char LOG_TAG[]{ESPTOOLS_LOG_TAG_CREATOR("PerfLock")};
+    // Compile-time log level of the module
+    static constexpr esp_log_level_t LOG_LEVEL{ESPTOOLS_LOG_LEVEL_PERF_LOCK};
+
+    const char *const name_;
+    // nullptr without power management support
+    esp_pm_lock_handle_t handle_;
+    // Nested acquisitions
+    uint32_t depth_;
+    // Start of the current hold
+    int64_t since_us_;
+    // Start of the measurements
+    int64_t created_us_;
+    // Total time of the completed holds
+    int64_t held_us_;
+    RunningStats<uint32_t> holds_;
+    mutable portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+  };
+
+  /**
+   * @brief Holds a PerfLock for the lifetime of the object
+   *
+   * @code
+   * static ESPTools::PerfLock cpu_max{ESP_PM_CPU_FREQ_MAX, "burst"};
+   * {
+   *   ESPTools::PerfScope scope{cpu_max};
+   *   // Runs at the maximum frequency
+   * }
+   * @endcode
+   */
+  class PerfScope
+  {
+  public:
+    explicit PerfScope(PerfLock &lock) : lock_(lock) { lock_.Acquire(); }
+    ~PerfScope() { lock_.Release(); }
+
+    PerfScope(const PerfScope &) = delete;
+    PerfScope &operator=(const PerfScope &) = delete;
+
+  private:
+    PerfLock &lock_;
+  };
+
+} // namespace ESPTools
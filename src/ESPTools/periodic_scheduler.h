@@ -0,0 +1,383 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/logger.h"
+#include "ESPTools/perf_lock.h"
+
+#include <esp_attr.h>
+#include <esp_err.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Compile-time log level of the PeriodicScheduler module
+#ifndef ESPTOOLS_LOG_LEVEL_PERIODIC_SCHEDULER
+#define ESPTOOLS_LOG_LEVEL_PERIODIC_SCHEDULER ESPTOOLS_LOG_LEVEL
+#endif
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Context in which the jobs of a PeriodicScheduler are executed
+   */
+  enum class DispatchContext : uint8_t
+  {
+    // From the esp_timer task. Jobs may block briefly and use any FreeRTOS API.
+    Task,
+    // Directly from the esp_timer ISR. Jobs must be in IRAM and only use ISR-safe APIs.
+    // Requires CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD.
+    Isr
+  };
+
+  /**
+   * @brief Runs many periodic jobs from a single one-shot esp_timer, instead of one task (and one
+   * stack) per `while (true) { ...; vTaskDelay(); }` loop.
+   *
+   * @details Jobs are kept in a binary min-heap ordered by their next deadline, and the timer is
+   * always armed for the earliest one, so the timer fires only when there is work to do and each
+   * dispatch costs O(log MAX_JOBS). Deadlines are absolute: the next one is computed from the
+   * previous deadline, not from the time the job actually ran, so there is no accumulated drift
+   * and the period is kept at esp_timer (microsecond) resolution instead of the RTOS tick. When a
+   * job runs so late that whole periods were missed, they are skipped and counted as overruns
+   * rather than executed back to back.
+   *
+   * Jobs are executed one after the other outside of the internal lock, so they may add or remove
+   * jobs, including themselves. Jobs can be added and removed from any task, and also from ISRs
+   * when the dispatch context is `DispatchContext::Isr`.
+   *
+   * @tparam MAX_JOBS Maximum number of simultaneously registered jobs
+   */
+  template <size_t MAX_JOBS = 16>
+  class PeriodicScheduler
+  {
+    static_assert(MAX_JOBS > 0 && MAX_JOBS < UINT8_MAX, "Unsupported number of jobs");
+
+  public:
+    // Function executed by a job
+    using Callback = void (*)(void *arg);
+    // Identifier returned by Add(), negative on failure
+    using JobId = int;
+
+    /**
+     * @brief Creates the dispatcher timer. Jobs are not executed until `Start()` is called.
+     *
+     * @param name Name of the timer, must have static storage duration
+     * @param context Context in which the jobs are executed
+     */
+    PeriodicScheduler(const char *const name = "ESPTools Sched",
+                      const DispatchContext context = DispatchContext::Task)
+        : timer_(nullptr), jobs_(), heap_(), heap_size_(0), running_(false), perf_lock_(nullptr)
+    {
+#if !CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+      ESP_ERROR_CHECK(context == DispatchContext::Isr ? ESP_ERR_NOT_SUPPORTED : ESP_OK);
+#endif
+      const esp_timer_create_args_t args{
+          .callback = Dispatch,
+          .arg = this,
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+          .dispatch_method = (context == DispatchContext::Isr) ? ESP_TIMER_ISR : ESP_TIMER_TASK,
+#else
+          .dispatch_method = ESP_TIMER_TASK,
+#endif
+          .name = name,
+          .skip_unhandled_events = true,
+      };
+      ESP_ERROR_CHECK(esp_timer_create(&args, &timer_));
+    }
+
+    /**
+     * @brief Stops and deletes the dispatcher timer
+     */
+    ~PeriodicScheduler()
+    {
+      Stop();
+      ESP_ERROR_CHECK(esp_timer_delete(timer_));
+    }
+
+    PeriodicScheduler(const PeriodicScheduler &) = delete;
+    PeriodicScheduler &operator=(const PeriodicScheduler &) = delete;
+
+    /**
+     * @brief Registers a periodic job
+     *
+     * @param callback Function to execute
+     * @param arg Argument passed to the callback
+     * @param period_us Period of the job in microseconds
+     * @param first_delay_us Delay of the first execution. A negative value waits one full period.
+     * @return Identifier of the job, or -1 if the scheduler is full or the period is not valid
+     */
+    IRAM_ATTR JobId Add(const Callback callback,
+                        void *const arg,
+                        const int64_t period_us,
+                        const int64_t first_delay_us = -1)
+    {
+      if (!callback || period_us <= 0)
+      {
+        return -1;
+      }
+      const int64_t now_us{esp_timer_get_time()};
+      portENTER_CRITICAL_SAFE(&lock_);
+      JobId id{-1};
+      for (size_t i{0}; i < MAX_JOBS; ++i)
+      {
+        if (!jobs_[i].callback)
+        {
+          id = static_cast<JobId>(i);
+          break;
+        }
+      }
+      if (id >= 0)
+      {
+        Job &job{jobs_[id]};
+        job.callback = callback;
+        job.arg = arg;
+        job.period_us = period_us;
+        job.deadline_us = now_us + ((first_delay_us < 0) ? period_us : first_delay_us);
+        job.overruns = 0;
+        job.heap_index = static_cast<uint8_t>(heap_size_);
+        heap_[heap_size_++] = static_cast<uint8_t>(id);
+        SiftUp(job.heap_index);
+        if (job.heap_index == 0)
+        {
+          Rearm(now_us);
+        }
+      }
+      portEXIT_CRITICAL_SAFE(&lock_);
+      return id;
+    }
+
+    /**
+     * @brief Unregisters a job. If the job is being executed, the current execution completes
+     * but there are no further ones.
+     *
+     * @param id Identifier returned by `Add()`
+     * @return False if the identifier does not belong to a registered job
+     */
+    IRAM_ATTR bool Remove(const JobId id)
+    {
+      if (id < 0 || static_cast<size_t>(id) >= MAX_JOBS)
+      {
+        return false;
+      }
+      portENTER_CRITICAL_SAFE(&lock_);
+      const bool registered{jobs_[id].callback != nullptr};
+      if (registered)
+      {
+        const uint8_t index{jobs_[id].heap_index};
+        jobs_[id].callback = nullptr;
+        // Move the last element to the freed position and restore the heap property
+        heap_[index] = heap_[--heap_size_];
+        jobs_[heap_[index]].heap_index = index;
+        if (index < heap_size_)
+        {
+          SiftDown(SiftUp(index));
+        }
+      }
+      portEXIT_CRITICAL_SAFE(&lock_);
+      return registered;
+    }
+
+    /**
+     * @brief Starts dispatching the registered jobs
+     */
+    void Start()
+    {
+      portENTER_CRITICAL(&lock_);
+      running_ = true;
+      Rearm(esp_timer_get_time());
+      portEXIT_CRITICAL(&lock_);
+      ESPTOOLS_LOGD("Scheduler started with %u jobs", static_cast<unsigned>(heap_size_));
+    }
+
+    /**
+     * @brief Stops dispatching the jobs. Deadlines keep their original phase, so missed periods
+     * are counted as overruns when the scheduler is started again.
+     */
+    void Stop()
+    {
+      portENTER_CRITICAL(&lock_);
+      running_ = false;
+      esp_timer_stop(timer_);
+      portEXIT_CRITICAL(&lock_);
+    }
+
+    /**
+     * @brief Sets a lock held while the due jobs run, so e.g. an ESP_PM_CPU_FREQ_MAX lock runs
+     * them at full speed and the CPU stays at low frequency between dispatches
+     *
+     * @param lock Lock to hold, nullptr to run the jobs without one. Must outlive the scheduler.
+     */
+    void SetPerfLock(PerfLock *const lock) { perf_lock_.store(lock, std::memory_order_relaxed); }
+
+    /**
+     * @brief Returns the number of registered jobs
+     */
+    size_t GetJobCount() const { return heap_size_; }
+
+    /**
+     * @brief Returns the number of periods a job has skipped because it ran too late
+     *
+     * @param id Identifier returned by `Add()`
+     */
+    uint32_t GetOverruns(const JobId id) const
+    {
+      return (id >= 0 && static_cast<size_t>(id) < MAX_JOBS) ? jobs_[id].overruns : 0;
+    }
+
+  private:
+    // Tag used for the logging system
+    static constexpr char LOG_TAG[]{ESPTOOLS_LOG_TAG_CREATOR("Periodic Scheduler")};
+    // Compile-time log level of the module
+    static constexpr esp_log_level_t LOG_LEVEL{ESPTOOLS_LOG_LEVEL_PERIODIC_SCHEDULER};
+
+    struct Job
+    {
+      // nullptr when the slot is free
+      Callback callback;
+      void *arg;
+      int64_t period_us;
+      int64_t deadline_us;
+      uint32_t overruns;
+      // Position of the job inside heap_
+      uint8_t heap_index;
+    };
+
+    /**
+     * @brief Callback of the esp_timer. Runs every job whose deadline has been reached and arms
+     * the timer for the next deadline.
+     *
+     * @param arg Pointer to the PeriodicScheduler object
+     */
+    IRAM_ATTR static void Dispatch(void *arg)
+    {
+      ESPTOOLS_TRACE_SCOPE("PeriodicScheduler::Dispatch");
+      PeriodicScheduler &scheduler{*static_cast<PeriodicScheduler *>(arg)};
+      PerfLock *const perf_lock{scheduler.perf_lock_.load(std::memory_order_relaxed)};
+      if (perf_lock)
+      {
+        perf_lock->Acquire();
+      }
+      while (true)
+      {
+        const int64_t now_us{esp_timer_get_time()};
+        portENTER_CRITICAL_SAFE(&scheduler.lock_);
+        if (!scheduler.running_ || scheduler.heap_size_ == 0 ||
+            scheduler.jobs_[scheduler.heap_[0]].deadline_us > now_us)
+        {
+          scheduler.Rearm(now_us);
+          portEXIT_CRITICAL_SAFE(&scheduler.lock_);
+          if (perf_lock)
+          {
+            perf_lock->Release();
+          }
+          return;
+        }
+        Job &job{scheduler.jobs_[scheduler.heap_[0]]};
+        const Callback callback{job.callback};
+        void *const job_arg{job.arg};
+        // Advance from the previous deadline so the schedule does not drift
+        job.deadline_us += job.period_us;
+        if (job.deadline_us <= now_us)
+        {
+          const int64_t missed{(now_us - job.deadline_us) / job.period_us + 1};
+          job.deadline_us += missed * job.period_us;
+          job.overruns += static_cast<uint32_t>(missed);
+        }
+        scheduler.SiftDown(0);
+        portEXIT_CRITICAL_SAFE(&scheduler.lock_);
+        callback(job_arg);
+      }
+    }
+
+    /**
+     * @brief Arms the timer for the earliest deadline. Must be called with the lock taken.
+     *
+     * @param now_us Current time in microseconds
+     */
+    IRAM_ATTR void Rearm(const int64_t now_us)
+    {
+      esp_timer_stop(timer_);
+      if (running_ && heap_size_ > 0)
+      {
+        const int64_t delay_us{jobs_[heap_[0]].deadline_us - now_us};
+        ESP_ERROR_CHECK(esp_timer_start_once(timer_, (delay_us > 0) ? delay_us : 0));
+      }
+    }
+
+    /**
+     * @brief Compares the deadlines of two heap positions
+     */
+    IRAM_ATTR bool Earlier(const size_t a, const size_t b) const
+    {
+      return jobs_[heap_[a]].deadline_us < jobs_[heap_[b]].deadline_us;
+    }
+
+    /**
+     * @brief Swaps two heap positions, keeping the back references of the jobs updated
+     */
+    IRAM_ATTR void Swap(const size_t a, const size_t b)
+    {
+      const uint8_t job{heap_[a]};
+      heap_[a] = heap_[b];
+      heap_[b] = job;
+      jobs_[heap_[a]].heap_index = static_cast<uint8_t>(a);
+      jobs_[heap_[b]].heap_index = static_cast<uint8_t>(b);
+    }
+
+    /**
+     * @brief Moves a heap element towards the root while it is earlier than its parent
+     *
+     * @return Final position of the element
+     */
+    IRAM_ATTR size_t SiftUp(size_t index)
+    {
+      while (index > 0 && Earlier(index, (index - 1) / 2))
+      {
+        Swap(index, (index - 1) / 2);
+        index = (index - 1) / 2;
+      }
+      return index;
+    }
+
+    /**
+     * @brief Moves a heap element towards the leaves while it is later than any of its children
+     */
+    IRAM_ATTR void SiftDown(size_t index)
+    {
+      while (true)
+      {
+        const size_t left{2 * index + 1};
+        const size_t right{left + 1};
+        size_t earliest{index};
+        if (left < heap_size_ && Earlier(left, earliest))
+        {
+          earliest = left;
+        }
+        if (right < heap_size_ && Earlier(right, earliest))
+        {
+          earliest = right;
+        }
+        if (earliest == index)
+        {
+          return;
+        }
+        Swap(index, earliest);
+        index = earliest;
+      }
+    }
+
+    esp_timer_handle_t timer_;
+    Job jobs_[MAX_JOBS];
+    // Indices of jobs_ ordered as a binary min-heap
+    uint8_t heap_[MAX_JOBS];
+    size_t heap_size_;
+    bool running_;
+    std::atomic<PerfLock *> perf_lock_;
+    portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+  };
+
+} // namespace ESPTools
@@ -0,0 +1,391 @@
+#include "ESPTools/pulse_capture.h"
+#include "ESPTools/logger.h"
+#include "ESPTools/stats.h"
+
+#include <esp_attr.h>
+#include <esp_cpu.h>
+#include <esp_rom_sys.h>
+#include <freertos/task.h>
+
+#if SOC_RMT_SUPPORTED
+#include <esp_rom_gpio.h>
+#include <soc/gpio_pins.h>
+#include <soc/gpio_reg.h>
+#include <soc/rmt_periph.h>
+#include <soc/soc.h>
+#endif
+
+namespace ESPTools
+{
+
+#if SOC_RMT_SUPPORTED
+  namespace
+  {
+
+    /**
+     * @brief Finds the RMT receive signal that the GPIO matrix feeds from a pin, as the IDF 5.0
+     * channel handle does not tell which channel it is
+     *
+     * @return Input signal index, or -1 if no receiver is routed from the pin
+     */
+    int FindRxSignal(const gpio_num_t pin)
+    {
+      for (size_t i{0}; i < SOC_RMT_CHANNELS_PER_GROUP; ++i)
+      {
+        const int signal{rmt_periph_signals.groups[0].channels[i].rx_sig};
+        if (signal >= 0 &&
+            REG_GET_FIELD(GPIO_FUNC0_IN_SEL_CFG_REG + 4 * signal, GPIO_FUNC0_IN_SEL) ==
+                static_cast<uint32_t>(pin))
+        {
+          return signal;
+        }
+      }
+      return -1;
+    }
+
+  } // namespace
+#endif
+
+  PulseCapture::PulseCapture(const gpio_num_t pin,
+                             const bool inverse_logic,
+                             const uint32_t resolution_hz,
+                             const Callback callback,
+                             void *const callback_arg,
+                             const UBaseType_t priority,
+                             const int intr_alloc_flags,
+                             const uint32_t window_ms)
+      : StaticTask("ESPTools Pulse", priority),
+        pin_(pin),
+        inverse_logic_(inverse_logic),
+        resolution_hz_(resolution_hz),
+        callback_(callback),
+        callback_arg_(callback_arg),
+        intr_alloc_flags_(intr_alloc_flags),
+        measurement_(),
+        dropped_(0),
+        batch_()
+#if SOC_RMT_SUPPORTED
+        ,
+        channel_(nullptr),
+        window_timer_(nullptr),
+        receive_config_{
+            .signal_range_min_ns = 0,
+            // Longest level the receiver can count, after which the frame is considered finished
+            .signal_range_max_ns =
+                static_cast<uint32_t>((uint64_t{32767} * 1000000000) / resolution_hz),
+        },
+        // A window must outlast the idle time that ends the frame it cuts
+        min_window_us_(2 * (receive_config_.signal_range_max_ns / 1000 + 1)),
+        max_window_us_((window_ms * 1000 > min_window_us_) ? window_ms * 1000 : min_window_us_),
+        window_us_(max_window_us_),
+        rx_signal_(-1),
+        symbols_(),
+        received_symbols_(),
+        cut_(),
+        ready_(),
+        active_buffer_(0),
+        next_buffer_(0),
+        cutting_(false)
+#else
+        ,
+        window_ms_(window_ms),
+        segments_(),
+        cycles_per_us_(esp_rom_get_cpu_ticks_per_us()),
+        last_edge_cycles_(0),
+        last_state_(),
+        first_edge_(true)
+#endif
+  {
+#if SOC_RMT_SUPPORTED
+    const rmt_rx_channel_config_t config{
+        .gpio_num = pin_,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = resolution_hz_,
+#if SOC_RMT_SUPPORT_DMA
+        .mem_block_symbols = BATCH_SYMBOLS,
+        .flags = {.invert_in = false, .with_dma = true, .io_loop_back = false},
+#else
+        .mem_block_symbols = SOC_RMT_MEM_WORDS_PER_CHANNEL,
+        .flags = {.invert_in = false, .with_dma = false, .io_loop_back = false},
+#endif
+    };
+    // A receiver released by a previous channel keeps its route from the pin, so it is cleared
+    // before looking for the receiver of the new channel
+    for (int signal{FindRxSignal(pin_)}; signal >= 0; signal = FindRxSignal(pin_))
+    {
+      esp_rom_gpio_connect_in_signal(GPIO_MATRIX_CONST_ZERO_INPUT, signal, false);
+    }
+    ESP_ERROR_CHECK(rmt_new_rx_channel(&config, &channel_));
+    rx_signal_ = FindRxSignal(pin_);
+    ESP_ERROR_CHECK(rx_signal_ >= 0 ? ESP_OK : ESP_ERR_NOT_FOUND);
+
+    const rmt_rx_event_callbacks_t callbacks{.on_recv_done = RmtDoneHandler};
+    ESP_ERROR_CHECK(rmt_rx_register_event_callbacks(channel_, &callbacks, this));
+    const esp_timer_create_args_t args{
+        .callback = WindowHandler,
+        .arg = this,
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+        .dispatch_method = ESP_TIMER_ISR,
+#else
+        .dispatch_method = ESP_TIMER_TASK,
+#endif
+        .name = "esptools_pulse",
+        .skip_unhandled_events = true,
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&args, &window_timer_));
+    ESP_ERROR_CHECK(rmt_enable(channel_));
+    ESPTOOLS_LOGD("GPIO %d captured by RMT at %" PRIu32 " Hz", pin_, resolution_hz_);
+#else
+    const gpio_config_t config{
+        .pin_bit_mask = CreateBitMaskAt<uint64_t>(pin_),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_ANYEDGE,
+    };
+    ESP_ERROR_CHECK(gpio_config(&config));
+    ESP_ERROR_CHECK(gpio_intr_disable(pin_));
+    ESPTOOLS_LOGD("GPIO %d captured by the GPIO ISR (no RMT on this chip)", pin_);
+#endif
+  }
+
+  PulseCapture::~PulseCapture()
+  {
+    // Stop the interrupts first, so they never notify a deleted task
+#if SOC_RMT_SUPPORTED
+    ESP_ERROR_CHECK(rmt_disable(channel_));
+    // The receive done callback restarts the timer, so it is stopped once the channel is
+    esp_timer_stop(window_timer_);
+    ESP_ERROR_CHECK(esp_timer_delete(window_timer_));
+    ESP_ERROR_CHECK(rmt_del_channel(channel_));
+#else
+    ESP_ERROR_CHECK(gpio_intr_disable(pin_));
+    ESP_ERROR_CHECK(gpio_isr_handler_remove(pin_));
+#endif
+    Stop();
+  }
+
+  bool PulseCapture::Start()
+  {
+    if (!StaticTask::Start())
+    {
+      return false;
+    }
+#if !SOC_RMT_SUPPORTED
+    InstallIsrService(intr_alloc_flags_);
+    ESP_ERROR_CHECK(gpio_isr_handler_add(pin_, IsrHandler, this));
+    ESP_ERROR_CHECK(gpio_intr_enable(pin_));
+#endif
+    return true;
+  }
+
+  PulseMeasurement PulseCapture::GetMeasurement()
+  {
+    portENTER_CRITICAL(&lock_);
+    const PulseMeasurement measurement{measurement_};
+    portEXIT_CRITICAL(&lock_);
+    return measurement;
+  }
+
+  void PulseCapture::Run()
+  {
+#if SOC_RMT_SUPPORTED
+    // The timer is started first, as the receive done callback restarts it
+    ESP_ERROR_CHECK(esp_timer_start_periodic(window_timer_, window_us_));
+    Receive(active_buffer_);
+    while (true)
+    {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      // The callback fills the buffers in turns, so they become ready in the same order
+      while (ready_[next_buffer_].load(std::memory_order_acquire))
+      {
+        // Each symbol holds two segments, a zero duration marks the end of the frame
+        const rmt_symbol_word_t *const symbols{symbols_[next_buffer_]};
+        size_t count{0};
+        for (size_t i{0}; i < received_symbols_[next_buffer_]; ++i)
+        {
+          const uint32_t durations[2]{symbols[i].duration0, symbols[i].duration1};
+          const uint32_t levels[2]{symbols[i].level0, symbols[i].level1};
+          for (size_t j{0}; j < 2 && durations[j] != 0; ++j)
+          {
+            batch_[count++] = {static_cast<uint32_t>((uint64_t{durations[j]} * 1000000000) /
+                                                     resolution_hz_),
+                               GpioState(levels[j], inverse_logic_)};
+          }
+        }
+        if (cut_[next_buffer_] && count > 0)
+        {
+          --count;
+        }
+        // The buffer is released before processing, so the callback can receive into it again
+        ready_[next_buffer_].store(false, std::memory_order_release);
+        next_buffer_ ^= 1;
+        Process(count);
+      }
+    }
+#else
+    while (true)
+    {
+      // Partial batches are processed too, so slow signals are still reported
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(window_ms_));
+      const size_t count{segments_.PopBatch(batch_, BATCH_SIZE)};
+      if (count > 0)
+      {
+        Process(count);
+      }
+    }
+#endif
+  }
+
+  void PulseCapture::Process(const size_t count)
+  {
+    ESPTOOLS_TRACE_SCOPE("PulseCapture::Process");
+    RunningStats<uint32_t> high;
+    RunningStats<uint32_t> low;
+    for (size_t i{0}; i < count; ++i)
+    {
+      (batch_[i].state == GpioState::High ? high : low).Add(batch_[i].duration_ns);
+    }
+
+    PulseMeasurement measurement{};
+    if (high.GetCount() > 0 && low.GetCount() > 0)
+    {
+      measurement.pulses = (high.GetCount() < low.GetCount()) ? high.GetCount() : low.GetCount();
+      measurement.high_ns = high.GetMean();
+      measurement.low_ns = low.GetMean();
+      measurement.period_ns = measurement.high_ns + measurement.low_ns;
+      measurement.frequency_millihz =
+          static_cast<uint32_t>(uint64_t{1000000000000} / measurement.period_ns);
+    }
+    portENTER_CRITICAL(&lock_);
+    measurement_ = measurement;
+    portEXIT_CRITICAL(&lock_);
+
+    ESPTOOLS_LOGV("GPIO %d: %u segments, period %" PRIu32 " ns", pin_,
+                  static_cast<unsigned>(count), measurement.period_ns);
+    if (callback_)
+    {
+      callback_(*this, batch_, count, callback_arg_);
+    }
+  }
+
+#if SOC_RMT_SUPPORTED
+  void IRAM_ATTR PulseCapture::Receive(const size_t buffer)
+  {
+    ESP_ERROR_CHECK(
+        rmt_receive(channel_, symbols_[buffer], sizeof(symbols_[buffer]), &receive_config_));
+  }
+
+  void IRAM_ATTR PulseCapture::AdaptWindow(const size_t symbol_count)
+  {
+    // The window is only lengthened well below the limit, so it does not swing back and forth
+    if (symbol_count + 1 >= RECEIVE_SYMBOLS)
+    {
+      window_us_ = (window_us_ / 2 > min_window_us_) ? window_us_ / 2 : min_window_us_;
+    }
+    else if (symbol_count < RECEIVE_SYMBOLS / 4)
+    {
+      window_us_ = (window_us_ * 2 < max_window_us_) ? window_us_ * 2 : max_window_us_;
+    }
+  }
+
+  bool IRAM_ATTR PulseCapture::RmtDoneHandler(rmt_channel_handle_t channel,
+                                              const rmt_rx_done_event_data_t *data,
+                                              void *arg)
+  {
+    (void)channel;
+    PulseCapture &capture{*static_cast<PulseCapture *>(arg)};
+
+    // The pin is connected again whether the timer or the idle line ended the frame
+    const bool cut{capture.cutting_.exchange(false, std::memory_order_relaxed)};
+    esp_rom_gpio_connect_in_signal(capture.pin_, capture.rx_signal_, false);
+    capture.AdaptWindow(data->num_symbols);
+
+    const size_t buffer{capture.active_buffer_};
+    const bool released{!capture.ready_[buffer ^ 1].load(std::memory_order_acquire)};
+    if (released)
+    {
+      capture.received_symbols_[buffer] = data->num_symbols;
+      capture.cut_[buffer] = cut;
+      capture.ready_[buffer].store(true, std::memory_order_release);
+      capture.active_buffer_ = buffer ^ 1;
+    }
+    else
+    {
+      // The task still holds the other buffer, so this one is reused for the next batch. The
+      // callback is the only writer, so a load/store pair avoids an atomic read-modify-write.
+      capture.dropped_.store(capture.dropped_.load(std::memory_order_relaxed) +
+                                 2 * data->num_symbols,
+                             std::memory_order_relaxed);
+    }
+    capture.Receive(capture.active_buffer_);
+    // The window starts with the new frame
+    esp_timer_stop(capture.window_timer_);
+    esp_timer_start_periodic(capture.window_timer_, capture.window_us_);
+
+    BaseType_t higher_priority_task_woken{pdFALSE};
+    if (released)
+    {
+      vTaskNotifyGiveFromISR(capture.GetHandle(), &higher_priority_task_woken);
+    }
+    return higher_priority_task_woken == pdTRUE;
+  }
+
+  void IRAM_ATTR PulseCapture::WindowHandler(void *arg)
+  {
+    PulseCapture &capture{*static_cast<PulseCapture *>(arg)};
+    if (!capture.cutting_.exchange(true, std::memory_order_relaxed))
+    {
+      // A constant at the current level adds no edge, so the frame ends after the idle time
+      esp_rom_gpio_connect_in_signal(gpio_get_level(capture.pin_) ? GPIO_MATRIX_CONST_ONE_INPUT
+                                                                  : GPIO_MATRIX_CONST_ZERO_INPUT,
+                                     capture.rx_signal_, false);
+    }
+    else
+    {
+      // The previous cut ended no frame, so none was running and the pin is connected again
+      esp_rom_gpio_connect_in_signal(capture.pin_, capture.rx_signal_, false);
+      capture.cutting_.store(false, std::memory_order_relaxed);
+    }
+  }
+#else
+  void IRAM_ATTR PulseCapture::IsrHandler(void *arg)
+  {
+    PulseCapture &capture{*static_cast<PulseCapture *>(arg)};
+
+    const uint32_t now_cycles{esp_cpu_get_cycle_count()};
+    const GpioState state(gpio_get_level(capture.pin_), capture.inverse_logic_);
+    if (state == capture.last_state_)
+    {
+      return;
+    }
+
+    // The first segment started before the capture did, so its duration is unknown
+    if (!capture.first_edge_)
+    {
+      const PulseSegment segment{
+          static_cast<uint32_t>((uint64_t{now_cycles - capture.last_edge_cycles_} * 1000) /
+                                capture.cycles_per_us_),
+          capture.last_state_};
+      if (!capture.segments_.Push(segment))
+      {
+        // The ISR is the only writer, so a load/store pair avoids an atomic read-modify-write
+        capture.dropped_.store(capture.dropped_.load(std::memory_order_relaxed) + 1,
+                               std::memory_order_relaxed);
+      }
+    }
+    capture.first_edge_ = false;
+    capture.last_edge_cycles_ = now_cycles;
+    capture.last_state_ = state;
+
+    const TaskHandle_t handle{capture.GetHandle()};
+    if (handle && capture.segments_.Size() >= BATCH_SIZE)
+    {
+      BaseType_t higher_priority_task_woken{pdFALSE};
+      vTaskNotifyGiveFromISR(handle, &higher_priority_task_woken);
+      portYIELD_FROM_ISR(higher_priority_task_woken);
+    }
+  }
+#endif
+
+} // namespace ESPTools
@@ -0,0 +1,282 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/gpio_state.h"
+#include "ESPTools/logger.h"
+#include "ESPTools/ring_buffer.h"
+#include "ESPTools/task.h"
+
+#include <driver/gpio.h>
+#include <freertos/FreeRTOS.h>
+#include <soc/soc_caps.h>
+
+#if SOC_RMT_SUPPORTED
+#include <driver/rmt_rx.h>
+#include <esp_timer.h>
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Compile-time log level of the PulseCapture module
+#ifndef ESPTOOLS_LOG_LEVEL_PULSE_CAPTURE
+#define ESPTOOLS_LOG_LEVEL_PULSE_CAPTURE ESPTOOLS_LOG_LEVEL
+#endif
+
+// Number of level segments processed per batch (two per RMT symbol)
+#ifndef ESPTOOLS_PULSE_CAPTURE_BATCH_SIZE
+#if SOC_RMT_SUPPORT_DMA
+#define ESPTOOLS_PULSE_CAPTURE_BATCH_SIZE 512
+#else
+#define ESPTOOLS_PULSE_CAPTURE_BATCH_SIZE 128
+#endif
+#endif
+
+// Stack size in bytes of the task that processes the batches
+#ifndef ESPTOOLS_PULSE_CAPTURE_STACK_SIZE
+#define ESPTOOLS_PULSE_CAPTURE_STACK_SIZE 3072
+#endif
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Time the signal stayed at a given level
+   */
+  struct PulseSegment
+  {
+    uint32_t duration_ns;
+    GpioState state;
+  };
+
+  /**
+   * @brief Averages computed over the complete segments of a batch, with RunningStats, so the
+   * segments of a level must not differ by 2^31 ns (about 2.1 s) or more within a batch
+   */
+  struct PulseMeasurement
+  {
+    // Number of complete pulses (High plus Low segment) in the batch
+    uint32_t pulses;
+    uint32_t high_ns;
+    uint32_t low_ns;
+    uint32_t period_ns;
+    // Frequency in thousandths of a hertz, 0 if no pulse was captured
+    uint32_t frequency_millihz;
+  };
+
+  /**
+   * @brief Measures the high/low durations, period and frequency of a digital signal, such as a
+   * tachometer or a flow meter output, without one interrupt per edge.
+   *
+   * @details On the chips with an RMT peripheral the edges are timestamped by the RMT receiver
+   * and a whole batch of segments is delivered with a single interrupt, using DMA when the chip
+   * supports it (ESP32-S3). With IDF 5.0 a receive frame only ends once the line stays idle for
+   * the maximum RMT duration (32767 ticks of `resolution_hz`), which also sets the lowest
+   * measurable frequency. A full buffer does not end it, so a running signal would never complete
+   * a batch. An esp_timer therefore bounds each batch to a capture window: when it expires, the
+   * receiver input is switched in the GPIO matrix from the pin to a constant at the current pin
+   * level, and the frame ends one idle time later. The window is halved while batches fill the
+   * receiver, and grows back to `window_ms` when they no longer do. Without DMA a batch cannot
+   * hold more than the memory block of the channel, the excess symbols are truncated by the
+   * driver.
+   *
+   * Two receive buffers are used in turns, and the receive done callback reconnects the pin and
+   * re-arms the receiver into the other buffer before waking up the processing task, so the
+   * next batch is captured while the previous one is processed. The edges within the idle time
+   * that ends a window are not captured, and the last segment of a window ended by the timer is
+   * discarded, as an edge racing with the cut may have faked it. If the task still holds the
+   * other buffer, the finished batch is discarded and counted by `GetDroppedSegments()`.
+   * `rmt_receive()` is called from the callback, so the callback runs from IRAM only if
+   * `CONFIG_RMT_ISR_IRAM_SAFE` is set. The object must be placed in internal memory (e.g.
+   * statically allocated).
+   *
+   * On the chips without RMT (ESP32-C2) the edges are timestamped with the CPU cycle counter in a
+   * GPIO ISR registered through `InstallIsrService` and passed to the processing task through a
+   * SpscRingBuffer. This path costs one interrupt per edge, so it is limited to a few kHz and
+   * assumes a fixed CPU frequency. The MCPWM capture unit is not used, as the chips that have it
+   * also have RMT.
+   *
+   * Batches are processed by a task owned by the object. It converts them to GpioState-tagged
+   * segments, updates the measurement and calls the optional callback.
+   */
+  class PulseCapture : private StaticTask<ESPTOOLS_PULSE_CAPTURE_STACK_SIZE>
+  {
+  public:
+    /**
+     * @brief Callback invoked from the processing task for every captured batch
+     *
+     * @param capture PulseCapture object that captured the batch
+     * @param segments Captured segments, in chronological order
+     * @param count Number of segments
+     * @param arg User argument provided when constructing the PulseCapture
+     */
+    using Callback = void (*)(PulseCapture &capture, const PulseSegment *segments, size_t count,
+                              void *arg);
+
+    // Number of segments per batch
+    static constexpr size_t BATCH_SIZE{ESPTOOLS_PULSE_CAPTURE_BATCH_SIZE};
+    // Default RMT tick frequency, 0.1 us resolution and frames of up to 3.2 ms per level
+    static constexpr uint32_t DEFAULT_RESOLUTION_HZ{10 * 1000 * 1000};
+    // Default longest capture window of a batch
+    static constexpr uint32_t DEFAULT_WINDOW_MS{100};
+
+    /**
+     * @brief Configures the capture peripheral. The capture begins with `Start()`.
+     *
+     * @param pin GPIO number of the signal
+     * @param inverse_logic If set to true, the read levels are inverted (active low signal)
+     * @param resolution_hz Tick frequency of the RMT receiver. Ignored without RMT.
+     * @param callback Optional function called with every batch
+     * @param callback_arg User argument forwarded to the callback
+     * @param priority Priority of the processing task
+     * @param intr_alloc_flags Flags forwarded to `InstallIsrService` in case it has not been
+     * installed yet. Only used without RMT.
+     * @param window_ms Longest capture window of a batch. With RMT it is raised to twice the
+     * idle time that ends a frame. Without RMT, it is how long the task waits before processing a
+     * partial batch.
+     */
+    PulseCapture(const gpio_num_t pin,
+                 const bool inverse_logic = false,
+                 const uint32_t resolution_hz = DEFAULT_RESOLUTION_HZ,
+                 const Callback callback = nullptr,
+                 void *const callback_arg = nullptr,
+                 const UBaseType_t priority = 5,
+                 const int intr_alloc_flags = 0,
+                 const uint32_t window_ms = DEFAULT_WINDOW_MS);
+
+    /**
+     * @brief Stops the capture and releases the peripheral
+     */
+    ~PulseCapture() override;
+
+    /**
+     * @brief Starts the processing task and the capture
+     *
+     * @return False if the task could not be created
+     */
+    bool Start();
+
+    /**
+     * @brief Returns the GPIO number of the signal
+     */
+    gpio_num_t GetPin() const { return pin_; }
+
+    /**
+     * @brief Returns the measurement of the last processed batch
+     */
+    PulseMeasurement GetMeasurement();
+
+    /**
+     * @brief Returns the number of segments lost because the processing task did not keep up.
+     * With RMT, the segments lost in the idle time that ends a window are not counted.
+     */
+    uint32_t GetDroppedSegments() const { return dropped_.load(std::memory_order_relaxed); }
+
+  private:
+    // Tag used for the logging system
+    static constexpr char LOG_TAG[]{ESPTOOLS_LOG_TAG_CREATOR("Pulse Capture")};
+    // Compile-time log level of the module
+    static constexpr esp_log_level_t LOG_LEVEL{ESPTOOLS_LOG_LEVEL_PULSE_CAPTURE};
+
+    /**
+     * @brief Body of the processing task
+     */
+    void Run() override;
+
+    /**
+     * @brief Updates the measurement with a batch and forwards it to the callback
+     *
+     * @param count Number of segments stored in batch_
+     */
+    void Process(const size_t count);
+
+#if SOC_RMT_SUPPORTED
+    /**
+     * @brief Starts receiving into one of the symbol buffers. Also called from the receive done
+     * callback.
+     *
+     * @param buffer Index of the buffer
+     */
+    void Receive(const size_t buffer);
+
+    /**
+     * @brief Halves the capture window while the batches fill the receiver, and lets it grow
+     * back once the signal slows down
+     *
+     * @param symbol_count Number of symbols of the last batch
+     */
+    void AdaptWindow(const size_t symbol_count);
+
+    /**
+     * @brief RMT receive done callback, re-arms the receiver into the other buffer and wakes up
+     * the processing task
+     */
+    static bool RmtDoneHandler(rmt_channel_handle_t channel,
+                               const rmt_rx_done_event_data_t *data,
+                               void *arg);
+
+    /**
+     * @brief Window timer callback, cuts the receiver input so the running frame ends. If the
+     * previous cut ended no frame, the line is idle and the pin is connected again.
+     */
+    static void WindowHandler(void *arg);
+
+    static constexpr size_t BATCH_SYMBOLS{BATCH_SIZE / 2};
+#if SOC_RMT_SUPPORT_DMA
+    static constexpr size_t RECEIVE_SYMBOLS{BATCH_SYMBOLS};
+#else
+    // Without DMA, a frame cannot hold more than the memory block of the channel
+    static constexpr size_t RECEIVE_SYMBOLS{BATCH_SYMBOLS < SOC_RMT_MEM_WORDS_PER_CHANNEL
+                                                ? BATCH_SYMBOLS
+                                                : SOC_RMT_MEM_WORDS_PER_CHANNEL};
+#endif
+#else
+    /**
+     * @brief GPIO ISR, timestamps each edge and queues the segment that has just finished
+     */
+    static void IsrHandler(void *arg);
+#endif
+
+    const gpio_num_t pin_;
+    const bool inverse_logic_;
+    const uint32_t resolution_hz_;
+    const Callback callback_;
+    void *const callback_arg_;
+    const int intr_alloc_flags_;
+    PulseMeasurement measurement_;
+    std::atomic<uint32_t> dropped_;
+    PulseSegment batch_[BATCH_SIZE];
+    portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+#if SOC_RMT_SUPPORTED
+    rmt_channel_handle_t channel_;
+    esp_timer_handle_t window_timer_;
+    const rmt_receive_config_t receive_config_;
+    // Shortest and longest capture windows, and the current one
+    const uint32_t min_window_us_;
+    const uint32_t max_window_us_;
+    uint32_t window_us_;
+    // GPIO matrix input signal of the receiver
+    int rx_signal_;
+    rmt_symbol_word_t symbols_[2][BATCH_SYMBOLS];
+    // Batch of each buffer, valid while its ready flag is set
+    size_t received_symbols_[2];
+    bool cut_[2];
+    std::atomic<bool> ready_[2];
+    // Buffer being received into, owned by the receive done callback once started
+    size_t active_buffer_;
+    // Next buffer processed by the task
+    size_t next_buffer_;
+    // Set while the receiver input is cut from the pin
+    std::atomic<bool> cutting_;
+#else
+    const uint32_t window_ms_;
+    SpscRingBuffer<PulseSegment, BATCH_SIZE * 2> segments_;
+    uint32_t cycles_per_us_;
+    uint32_t last_edge_cycles_;
+    GpioState last_state_;
+    bool first_edge_;
+#endif
+  };
+
+} // namespace ESPTools
@@ -0,0 +1,294 @@
+#pragma once
+
+#include "ESPTools/core.h"
+
+#include <esp_attr.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Fixed-capacity, lock-free, single-producer/single-consumer ring buffer. Intended to
+   * pass data from an ISR (producer) to a task (consumer) without the critical section and
+   * double copy of a FreeRTOS queue.
+   *
+   * @details Synchronization relies only on atomic loads and stores of the head and tail
+   * indices, which are plain word accesses on every ESP32 chip (including the ESP32-C2, which
+   * lacks the RISC-V atomic extension), so no lock or libatomic call is ever involved. The
+   * indices run freely and are masked on access, which is why the capacity must be a power of
+   * two. Only one context may push and only one context may pop at the same time.
+   *
+   * @tparam T Type of the stored elements. Must be trivially copyable.
+   * @tparam CAPACITY Maximum number of stored elements. Must be a power of two.
+   */
+  template <typename T, size_t CAPACITY>
+  class SpscRingBuffer
+  {
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0,
+                  "SpscRingBuffer capacity must be a power of two");
+    static_assert(CAPACITY <= (1UL << 31), "SpscRingBuffer capacity is too big");
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "SpscRingBuffer elements must be trivially copyable");
+
+  public:
+    constexpr SpscRingBuffer() : head_(0), tail_(0), buffer_() {}
+
+    SpscRingBuffer(const SpscRingBuffer &) = delete;
+    SpscRingBuffer &operator=(const SpscRingBuffer &) = delete;
+
+    /**
+     * @brief Returns the maximum number of elements the buffer can hold
+     */
+    static constexpr size_t Capacity() { return CAPACITY; }
+
+    /**
+     * @brief Inserts an element. Must only be called from the producer context.
+     *
+     * @param item Element to insert
+     * @return True if the element was inserted, false if the buffer was full
+     */
+    IRAM_ATTR bool Push(const T &item)
+    {
+      const uint32_t head{head_.load(std::memory_order_relaxed)};
+      if (head - tail_.load(std::memory_order_acquire) >= CAPACITY)
+      {
+        return false;
+      }
+      buffer_[head & MASK] = item;
+      head_.store(head + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * @brief Extracts the oldest element. Must only be called from the consumer context.
+     *
+     * @param item Destination of the extracted element
+     * @return True if an element was extracted, false if the buffer was empty
+     */
+    IRAM_ATTR bool Pop(T &item)
+    {
+      const uint32_t tail{tail_.load(std::memory_order_relaxed)};
+      if (tail == head_.load(std::memory_order_acquire))
+      {
+        return false;
+      }
+      item = buffer_[tail & MASK];
+      tail_.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * @brief Extracts up to `max_items` elements at once, releasing all the slots with a single
+     * store. Must only be called from the consumer context.
+     *
+     * @param items Destination array with room for at least `max_items` elements
+     * @param max_items Maximum number of elements to extract
+     * @return Number of extracted elements
+     */
+    size_t PopBatch(T *const items, const size_t max_items)
+    {
+      const uint32_t tail{tail_.load(std::memory_order_relaxed)};
+      const uint32_t available{head_.load(std::memory_order_acquire) - tail};
+      const size_t count{(available < max_items) ? available : max_items};
+      for (size_t i{0}; i < count; ++i)
+      {
+        items[i] = buffer_[(tail + i) & MASK];
+      }
+      tail_.store(tail + count, std::memory_order_release);
+      return count;
+    }
+
+    /**
+     * @brief Calls `handler` for every element available when the function is entered, so the
+     * consumer can empty the buffer in a single wakeup. Elements pushed meanwhile are left for
+     * the next call. Must only be called from the consumer context.
+     *
+     * @tparam Handler Callable with signature `void(const T &)`
+     * @param handler Function invoked for each element, from the oldest to the newest
+     * @return Number of processed elements
+     */
+    template <typename Handler>
+    size_t Drain(Handler &&handler)
+    {
+      const uint32_t tail{tail_.load(std::memory_order_relaxed)};
+      const uint32_t head{head_.load(std::memory_order_acquire)};
+      for (uint32_t index{tail}; index != head; ++index)
+      {
+        handler(static_cast<const T &>(buffer_[index & MASK]));
+      }
+      tail_.store(head, std::memory_order_release);
+      return head - tail;
+    }
+
+    /**
+     * @brief Returns the number of stored elements. The value is only a snapshot when called
+     * while the other side is active.
+     */
+    size_t Size() const
+    {
+      return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Returns true if there are no stored elements
+     */
+    bool Empty() const { return Size() == 0; }
+
+  private:
+    static constexpr uint32_t MASK{CAPACITY - 1};
+
+    // Written only by the producer
+    std::atomic<uint32_t> head_;
+    // Written only by the consumer
+    std::atomic<uint32_t> tail_;
+    T buffer_[CAPACITY];
+  };
+
+  /**
+   * @brief Fixed-capacity, lock-free, multiple-producer/single-consumer ring buffer. Used where
+   * several tasks and ISRs produce records for a single consumer task, such as the deferred
+   * logging backend.
+   *
+   * @details Bounded queue in which every slot carries a sequence number (D. Vyukov's design).
+   * Producers claim a slot with a compare-and-swap on the head index and then publish it by
+   * updating its sequence, so no lock is held while the element is copied. On chips without
+   * atomic instructions (ESP32-C2) the compare-and-swap is emulated by the toolchain with a short
+   * interrupt-disabled section. Sequences are stored relative to the slot index so the whole
+   * object is zero-initialized at compile time and can be used before the static constructors
+   * run.
+   *
+   * @tparam T Type of the stored elements. Must be trivially copyable.
+   * @tparam CAPACITY Maximum number of stored elements. Must be a power of two.
+   */
+  template <typename T, size_t CAPACITY>
+  class MpscRingBuffer
+  {
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0,
+                  "MpscRingBuffer capacity must be a power of two");
+    static_assert(CAPACITY <= (1UL << 30), "MpscRingBuffer capacity is too big");
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "MpscRingBuffer elements must be trivially copyable");
+
+  public:
+    constexpr MpscRingBuffer() : head_(0), tail_(0), slots_() {}
+
+    MpscRingBuffer(const MpscRingBuffer &) = delete;
+    MpscRingBuffer &operator=(const MpscRingBuffer &) = delete;
+
+    /**
+     * @brief Returns the maximum number of elements the buffer can hold
+     */
+    static constexpr size_t Capacity() { return CAPACITY; }
+
+    /**
+     * @brief Inserts an element. Can be called concurrently from any task or ISR.
+     *
+     * @param item Element to insert
+     * @return True if the element was inserted, false if the buffer was full
+     */
+    IRAM_ATTR bool Push(const T &item)
+    {
+      uint32_t head{head_.load(std::memory_order_relaxed)};
+      while (true)
+      {
+        Slot &slot{slots_[head & MASK]};
+        const uint32_t sequence{slot.sequence.load(std::memory_order_acquire) + (head & MASK)};
+        const int32_t difference{static_cast<int32_t>(sequence - head)};
+        if (difference == 0)
+        {
+          // The slot is free for this lap, try to claim it
+          if (head_.compare_exchange_weak(head, head + 1, std::memory_order_relaxed))
+          {
+            slot.item = item;
+            slot.sequence.store(head + 1 - (head & MASK), std::memory_order_release);
+            return true;
+          }
+        }
+        else if (difference < 0)
+        {
+          // The slot still holds an element of the previous lap
+          return false;
+        }
+        else
+        {
+          // Another producer claimed the slot meanwhile
+          head = head_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    /**
+     * @brief Extracts the oldest element. Must only be called from the consumer context.
+     *
+     * @param item Destination of the extracted element
+     * @return True if an element was extracted, false if the buffer was empty or the oldest
+     * element is still being written by a producer
+     */
+    bool Pop(T &item)
+    {
+      const uint32_t tail{tail_.load(std::memory_order_relaxed)};
+      Slot &slot{slots_[tail & MASK]};
+      if (slot.sequence.load(std::memory_order_acquire) + (tail & MASK) != tail + 1)
+      {
+        return false;
+      }
+      item = slot.item;
+      slot.sequence.store(tail + CAPACITY - (tail & MASK), std::memory_order_release);
+      tail_.store(tail + 1, std::memory_order_relaxed);
+      return true;
+    }
+
+    /**
+     * @brief Calls `handler` for every published element, in place and without copying it, so
+     * the consumer can empty the buffer in a single wakeup. Must only be called from the
+     * consumer context.
+     *
+     * @tparam Handler Callable with signature `void(const T &)`
+     * @param handler Function invoked for each element, from the oldest to the newest
+     * @param max_items Maximum number of elements to process
+     * @return Number of processed elements
+     */
+    template <typename Handler>
+    size_t Drain(Handler &&handler, const size_t max_items = CAPACITY)
+    {
+      uint32_t tail{tail_.load(std::memory_order_relaxed)};
+      size_t count{0};
+      while (count < max_items)
+      {
+        Slot &slot{slots_[tail & MASK]};
+        if (slot.sequence.load(std::memory_order_acquire) + (tail & MASK) != tail + 1)
+        {
+          break;
+        }
+        handler(static_cast<const T &>(slot.item));
+        slot.sequence.store(tail + CAPACITY - (tail & MASK), std::memory_order_release);
+        ++tail;
+        ++count;
+      }
+      tail_.store(tail, std::memory_order_relaxed);
+      return count;
+    }
+
+  private:
+    static constexpr uint32_t MASK{CAPACITY - 1};
+
+    struct Slot
+    {
+      // Sequence number minus the slot index, zero means free for the first lap
+      std::atomic<uint32_t> sequence;
+      T item;
+    };
+
+    // Shared by all the producers
+    std::atomic<uint32_t> head_;
+    // Written only by the consumer
+    std::atomic<uint32_t> tail_;
+    Slot slots_[CAPACITY];
+  };
+
+} // namespace ESPTools
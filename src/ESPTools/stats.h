@@ -0,0 +1,387 @@
+#pragma once
+
+#include "ESPTools/core.h"
+
+#include <esp_attr.h>
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Returns the integer square root of a value, rounded down
+   */
+  constexpr uint32_t IntegerSqrt(const uint64_t value)
+  {
+    uint64_t remainder{value};
+    uint64_t root{0};
+    uint64_t bit{uint64_t{1} << 62};
+    while (bit > value)
+    {
+      bit >>= 2;
+    }
+    while (bit != 0)
+    {
+      if (remainder >= root + bit)
+      {
+        remainder -= root + bit;
+        root = (root >> 1) + bit;
+      }
+      else
+      {
+        root >>= 1;
+      }
+      bit >>= 2;
+    }
+    return static_cast<uint32_t>(root);
+  }
+
+  /**
+   * @brief Running count, minimum, maximum, mean and variance of a series of integer samples,
+   * updated in constant time and memory without floating point, so it can be fed from an ISR.
+   *
+   * @details Variance is accumulated on the samples shifted by the first one, which keeps the sums
+   * small and is as robust as Welford's algorithm, but without its division per sample: `Add()`
+   * is a handful of integer operations, and the integer divisions only happen in the getters.
+   * The deviation of every sample from the first one must fit in 31 bits, and the sum of the
+   * squared deviations in 63 bits (e.g. 2^32 samples deviating less than 2^15).
+   *
+   * The object is not synchronized: it must have a single writer, and readers in other contexts
+   * must take their copies through `SeqLocked`.
+   *
+   * @tparam T Type of the samples, `uint32_t` or `int32_t`
+   */
+  template <typename T = uint32_t>
+  class RunningStats
+  {
+    static_assert(std::is_same_v<T, uint32_t> || std::is_same_v<T, int32_t>,
+                  "RunningStats samples must be uint32_t or int32_t");
+
+  public:
+    constexpr RunningStats() : count_(0), min_(0), max_(0), offset_(0), sum_(0), sum_squares_(0)
+    {
+    }
+
+    /**
+     * @brief Adds a sample
+     */
+    IRAM_ATTR void Add(const T value)
+    {
+      if (count_ == 0)
+      {
+        min_ = value;
+        max_ = value;
+        offset_ = value;
+      }
+      else if (value < min_)
+      {
+        min_ = value;
+      }
+      else if (value > max_)
+      {
+        max_ = value;
+      }
+      ++count_;
+      const int32_t deviation{static_cast<int32_t>(static_cast<uint32_t>(value) -
+                                                   static_cast<uint32_t>(offset_))};
+      sum_ += deviation;
+      sum_squares_ += int64_t{deviation} * deviation;
+    }
+
+    /**
+     * @brief Discards all the samples
+     */
+    constexpr void Reset() { *this = RunningStats(); }
+
+    /**
+     * @brief Returns the number of samples
+     */
+    constexpr uint32_t GetCount() const { return count_; }
+
+    /**
+     * @brief Returns the smallest sample, 0 without samples
+     */
+    constexpr T GetMin() const { return min_; }
+
+    /**
+     * @brief Returns the largest sample, 0 without samples
+     */
+    constexpr T GetMax() const { return max_; }
+
+    /**
+     * @brief Returns the mean of the samples rounded towards zero, 0 without samples
+     */
+    constexpr T GetMean() const
+    {
+      return (count_ == 0) ? 0 : static_cast<T>(offset_ + sum_ / static_cast<int64_t>(count_));
+    }
+
+    /**
+     * @brief Returns the population variance of the samples, rounded down
+     */
+    constexpr uint64_t GetVariance() const
+    {
+      if (count_ == 0)
+      {
+        return 0;
+      }
+      // sum_squares - sum^2 / count without overflowing: sum = quotient * count + remainder
+      const int64_t count{count_};
+      const int64_t quotient{sum_ / count};
+      const int64_t remainder{sum_ % count};
+      const int64_t squares{sum_squares_ - quotient * (sum_ + remainder) -
+                            (remainder * remainder) / count};
+      return static_cast<uint64_t>(squares) / static_cast<uint64_t>(count);
+    }
+
+    /**
+     * @brief Returns the population standard deviation of the samples, rounded down
+     */
+    constexpr uint32_t GetStdDev() const { return IntegerSqrt(GetVariance()); }
+
+  private:
+    uint32_t count_;
+    T min_;
+    T max_;
+    // First sample, the sums are relative to it
+    T offset_;
+    int64_t sum_;
+    int64_t sum_squares_;
+  };
+
+  /**
+   * @brief Exponentially weighted moving average with a smoothing factor of 1 / 2^SHIFT, kept in
+   * fixed point so updating it is one shift and two additions.
+   *
+   * @details The first sample initializes the average. A step in the input reaches 63% of its
+   * size after 2^SHIFT samples. Like RunningStats, it must have a single writer.
+   *
+   * @tparam SHIFT Base 2 logarithm of the inverse of the smoothing factor, from 0 to 16
+   */
+  template <unsigned SHIFT>
+  class Ewma
+  {
+    static_assert(SHIFT <= 16, "Ewma shift must be at most 16");
+
+  public:
+    constexpr Ewma() : scaled_(0), initialized_(false) {}
+
+    /**
+     * @brief Adds a sample
+     */
+    IRAM_ATTR void Add(const int32_t value)
+    {
+      if (!initialized_)
+      {
+        scaled_ = int64_t{value} * (int64_t{1} << SHIFT);
+        initialized_ = true;
+        return;
+      }
+      scaled_ += value - (scaled_ >> SHIFT);
+    }
+
+    /**
+     * @brief Discards the average, the next sample initializes it again
+     */
+    constexpr void Reset() { *this = Ewma(); }
+
+    /**
+     * @brief Returns the average, rounded down, 0 without samples
+     */
+    constexpr int32_t Get() const { return static_cast<int32_t>(scaled_ >> SHIFT); }
+
+    /**
+     * @brief Returns true once a sample has been added
+     */
+    constexpr bool HasValue() const { return initialized_; }
+
+  private:
+    // Average multiplied by 2^SHIFT
+    int64_t scaled_;
+    bool initialized_;
+  };
+
+  /**
+   * @brief Histogram of unsigned samples in power of two buckets: bucket 0 counts the zeros and
+   * bucket i the samples in [2^(i-1), 2^i). The last bucket also counts every larger sample.
+   * Adding a sample is a count-leading-zeros and an increment, so the distribution of cycle
+   * counts or durations can be recorded in an ISR and the percentiles read later.
+   *
+   * @details Every bucket is an atomic word written with a plain load and store, which is only
+   * correct with a single writer, but lets any context read a bucket without locks or libatomic
+   * calls, also on the ESP32-C2. The buckets are not read at once, so a total or a percentile read
+   * during updates may miss the latest samples.
+   *
+   * @tparam BUCKETS Number of buckets, from 2 to 33. 33 covers the whole `uint32_t` range.
+   */
+  template <size_t BUCKETS = 33>
+  class Log2Histogram
+  {
+    static_assert(BUCKETS >= 2 && BUCKETS <= 33, "Log2Histogram needs 2 to 33 buckets");
+
+  public:
+    constexpr Log2Histogram() : buckets_() {}
+
+    Log2Histogram(const Log2Histogram &) = delete;
+    Log2Histogram &operator=(const Log2Histogram &) = delete;
+
+    /**
+     * @brief Returns the number of buckets
+     */
+    static constexpr size_t Size() { return BUCKETS; }
+
+    /**
+     * @brief Returns the bucket of a sample
+     */
+    static constexpr size_t GetBucket(const uint32_t value)
+    {
+      const size_t bucket{static_cast<size_t>(std::bit_width(value))};
+      return (bucket < BUCKETS) ? bucket : BUCKETS - 1;
+    }
+
+    /**
+     * @brief Returns the smallest sample counted by a bucket
+     */
+    static constexpr uint32_t GetBucketMin(const size_t bucket)
+    {
+      return (bucket == 0) ? 0 : uint32_t{1} << (bucket - 1);
+    }
+
+    /**
+     * @brief Adds a sample. Must only be called from the writer context.
+     */
+    IRAM_ATTR void Add(const uint32_t value)
+    {
+      std::atomic<uint32_t> &bucket{buckets_[GetBucket(value)]};
+      bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the number of samples of a bucket
+     */
+    uint32_t GetCount(const size_t bucket) const
+    {
+      return buckets_[bucket].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the number of samples of all the buckets
+     */
+    uint32_t GetTotal() const
+    {
+      uint32_t total{0};
+      for (const std::atomic<uint32_t> &bucket : buckets_)
+      {
+        total += bucket.load(std::memory_order_relaxed);
+      }
+      return total;
+    }
+
+    /**
+     * @brief Returns an upper bound of a percentile: the smallest sample of the bucket above the
+     * one that holds it, so the true value is below it and, past bucket 0, at least half of it
+     *
+     * @param percent Percentile, from 0 to 100
+     * @return Upper bound, or UINT32_MAX if the percentile falls in the last bucket
+     */
+    uint32_t GetPercentile(const uint32_t percent) const
+    {
+      const uint64_t target{(uint64_t{GetTotal()} * percent + 99) / 100};
+      uint64_t seen{0};
+      for (size_t bucket{0}; bucket < BUCKETS - 1; ++bucket)
+      {
+        seen += GetCount(bucket);
+        if (seen >= target && seen > 0)
+        {
+          return GetBucketMin(bucket + 1);
+        }
+      }
+      return UINT32_MAX;
+    }
+
+    /**
+     * @brief Clears every bucket. Must only be called from the writer context.
+     */
+    void Reset()
+    {
+      for (std::atomic<uint32_t> &bucket : buckets_)
+      {
+        bucket.store(0, std::memory_order_relaxed);
+      }
+    }
+
+  private:
+    std::atomic<uint32_t> buckets_[BUCKETS];
+  };
+
+  /**
+   * @brief Sequence lock around a value with a single writer, typically a statistics accumulator
+   * updated in an ISR. The writer never waits, and readers retry their copy until it was not
+   * disturbed by an update, so they always get a consistent value without disabling interrupts.
+   *
+   * @details The sequence is odd while an update is in progress. Readers must not preempt the
+   * writer on its core (e.g. read from a higher priority interrupt than the one that writes),
+   * as they would then retry forever.
+   *
+   * @tparam T Type of the value. Must be trivially copyable.
+   */
+  template <typename T>
+  class SeqLocked
+  {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLocked values must be trivially copyable");
+
+  public:
+    constexpr SeqLocked() : sequence_(0), value_() {}
+
+    SeqLocked(const SeqLocked &) = delete;
+    SeqLocked &operator=(const SeqLocked &) = delete;
+
+    /**
+     * @brief Starts an update. Must only be called from the writer context, and be followed by
+     * `EndWrite()` once the value is modified.
+     *
+     * @return Value to modify
+     */
+    IRAM_ATTR T &BeginWrite()
+    {
+      sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      return value_;
+    }
+
+    /**
+     * @brief Publishes the update started by `BeginWrite()`
+     */
+    IRAM_ATTR void EndWrite()
+    {
+      sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Returns a consistent copy of the value
+     */
+    T Read() const
+    {
+      while (true)
+      {
+        const uint32_t before{sequence_.load(std::memory_order_acquire)};
+        const T copy{value_};
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if ((before & 1) == 0 && sequence_.load(std::memory_order_relaxed) == before)
+        {
+          return copy;
+        }
+      }
+    }
+
+  private:
+    std::atomic<uint32_t> sequence_;
+    T value_;
+  };
+
+} // namespace ESPTools
@@ -0,0 +1,90 @@
+#include "ESPTools/task.h"
+#include "ESPTools/logger.h"
+
+#include <atomic>
+
+namespace ESPTools
+{
+
+  Task::Task(const char *const name,
+             const UBaseType_t priority,
+             StackType_t *const stack,
+             const uint32_t stack_size,
+             const CorePolicy core_policy)
+      : name_(name),
+        priority_(priority),
+        stack_(stack),
+        stack_size_(stack_size),
+        core_id_(SelectCore(core_policy)),
+        task_buffer_(),
+        handle_(nullptr)
+  {
+  }
+
+  Task::~Task()
+  {
+    Stop();
+  }
+
+  bool Task::Start()
+  {
+    // Declared here and not as class members, so they are not inherited by the derived classes
+    static constexpr char LOG_TAG[]{ESPTOOLS_LOG_TAG_CREATOR("Task")};
+    static constexpr esp_log_level_t LOG_LEVEL{ESPTOOLS_LOG_LEVEL_TASK};
+
+    if (handle_)
+    {
+      ESPTOOLS_LOGW("Task %s already started", name_);
+      return false;
+    }
+    handle_ = xTaskCreateStaticPinnedToCore(Entry, name_, stack_size_ / sizeof(StackType_t), this,
+                                            priority_, stack_, &task_buffer_, core_id_);
+    if (!handle_)
+    {
+      ESPTOOLS_LOGE("Task %s could not be created", name_);
+      return false;
+    }
+    ESPTOOLS_LOGD("Task %s started on core %d", name_, core_id_);
+    return true;
+  }
+
+  void Task::Stop()
+  {
+    if (handle_)
+    {
+      vTaskDelete(handle_);
+      handle_ = nullptr;
+    }
+  }
+
+  BaseType_t Task::SelectCore(const CorePolicy core_policy)
+  {
+    switch (core_policy)
+    {
+    case CorePolicy::Protocol:
+      return PROTOCOL_CORE_ID;
+    case CorePolicy::Spread:
+    {
+#ifdef CONFIG_FREERTOS_UNICORE
+      return APP_CORE_ID;
+#else
+      // Start on the application core so a single spread task behaves like CorePolicy::App
+      static std::atomic<uint32_t> next_core{APP_CORE_ID};
+      return static_cast<BaseType_t>(next_core.fetch_add(1, std::memory_order_relaxed) %
+                                     portNUM_PROCESSORS);
+#endif
+    }
+    default:
+      return APP_CORE_ID;
+    }
+  }
+
+  void Task::Entry(void *arg)
+  {
+    Task &task{*static_cast<Task *>(arg)};
+    task.Run();
+    // The task is deleted by Stop() or by the destructor, as the memory belongs to the object
+    vTaskSuspend(nullptr);
+  }
+
+} // namespace ESPTools
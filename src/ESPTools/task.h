@@ -0,0 +1,151 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/logger.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <cstdint>
+
+// Compile-time log level of the Task module
+#ifndef ESPTOOLS_LOG_LEVEL_TASK
+#define ESPTOOLS_LOG_LEVEL_TASK ESPTOOLS_LOG_LEVEL
+#endif
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Core selection policy used when creating a Task
+   */
+  enum class CorePolicy : uint8_t
+  {
+    // Pin the task to APP_CORE_ID, keeping application work off the protocol core
+    App,
+    // Pin the task to PROTOCOL_CORE_ID
+    Protocol,
+    // Pin every new task to the next core in a round-robin fashion
+    Spread
+  };
+
+  /**
+   * @brief RAII wrapper around a statically allocated FreeRTOS task whose entry point is the
+   * `Run()` member function. The task is created with `xTaskCreateStaticPinnedToCore`, so no heap
+   * memory is used and the core is always known.
+   *
+   * @details The task is created by `Start()`, not by the constructor, as `Run()` cannot be called
+   * before the derived class is fully constructed. When `Run()` returns the task suspends itself.
+   * The task is deleted by `Stop()` or by the destructor. Derived classes whose `Run()` uses
+   * their own members must call `Stop()` in their destructor, before those members are destroyed.
+   * Stack size follows the ESP-IDF convention and is given in bytes.
+   */
+  class Task
+  {
+  public:
+    /**
+     * @brief Initializes the task without creating it
+     *
+     * @param name Name of the task, must have static storage duration
+     * @param priority Priority of the task
+     * @param stack Stack buffer of the task, must outlive the object
+     * @param stack_size Size of `stack` in bytes
+     * @param core_policy Policy used to choose the core the task is pinned to
+     */
+    Task(const char *const name,
+         const UBaseType_t priority,
+         StackType_t *const stack,
+         const uint32_t stack_size,
+         const CorePolicy core_policy = CorePolicy::App);
+
+    /**
+     * @brief Deletes the task if it is still alive
+     */
+    virtual ~Task();
+
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+
+    /**
+     * @brief Creates the task, which starts executing `Run()`
+     *
+     * @return True if the task was created, false if it was already started or could not be
+     * created
+     */
+    bool Start();
+
+    /**
+     * @brief Deletes the task. Must not be called from the task itself.
+     */
+    void Stop();
+
+    /**
+     * @brief Returns the FreeRTOS handle of the task, nullptr if it is not started
+     */
+    TaskHandle_t GetHandle() const { return handle_; }
+
+    /**
+     * @brief Returns the core the task is pinned to
+     */
+    BaseType_t GetCoreId() const { return core_id_; }
+
+  protected:
+    /**
+     * @brief Entry point of the task
+     */
+    virtual void Run() = 0;
+
+  private:
+    /**
+     * @brief Resolves a core policy to a core ID
+     *
+     * @param core_policy Policy to resolve
+     */
+    static BaseType_t SelectCore(const CorePolicy core_policy);
+
+    /**
+     * @brief Trampoline passed to FreeRTOS, calls `Run()` on the Task object
+     *
+     * @param arg Pointer to the Task object
+     */
+    static void Entry(void *arg);
+
+    const char *const name_;
+    const UBaseType_t priority_;
+    StackType_t *const stack_;
+    const uint32_t stack_size_;
+    const BaseType_t core_id_;
+    StaticTask_t task_buffer_;
+    TaskHandle_t handle_;
+  };
+
+  /**
+   * @brief Task owning a statically sized stack
+   *
+   * @tparam STACK_SIZE Size of the stack in bytes
+   */
+  template <uint32_t STACK_SIZE>
+  class StaticTask : public Task
+  {
+    static_assert(STACK_SIZE >= configMINIMAL_STACK_SIZE, "Stack size too small");
+
+  public:
+    /**
+     * @brief Initializes the task without creating it
+     *
+     * @param name Name of the task, must have static storage duration
+     * @param priority Priority of the task
+     * @param core_policy Policy used to choose the core the task is pinned to
+     */
+    StaticTask(const char *const name,
+               const UBaseType_t priority,
+               const CorePolicy core_policy = CorePolicy::App)
+        : Task(name, priority, stack_, sizeof(stack_), core_policy)
+    {
+    }
+
+  private:
+    StackType_t stack_[STACK_SIZE / sizeof(StackType_t)];
+  };
+
+} // namespace ESPTools
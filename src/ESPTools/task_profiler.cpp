@@ -0,0 +1,130 @@
+#include "ESPTools/task_profiler.h"
+#include "ESPTools/logger.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <limits>
+
+namespace ESPTools
+{
+
+  static_assert(ESPTOOLS_TASK_PROFILER_MAX_TASKS > 0 &&
+                    ESPTOOLS_TASK_PROFILER_MAX_TASKS <= std::numeric_limits<UBaseType_t>::max(),
+                "Invalid ESPTOOLS_TASK_PROFILER_MAX_TASKS");
+
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+  namespace
+  {
+    // Snapshot filled by uxTaskGetSystemState()
+    TaskStatus_t statuses[ESPTOOLS_TASK_PROFILER_MAX_TASKS];
+    // Run time counters of the previous sample, identified by the task number
+    UBaseType_t previous_numbers[ESPTOOLS_TASK_PROFILER_MAX_TASKS];
+    uint32_t previous_runtimes[ESPTOOLS_TASK_PROFILER_MAX_TASKS];
+    UBaseType_t previous_count{0};
+    uint32_t previous_total_runtime{0};
+
+    /**
+     * @brief Returns the run time counter of a task in the previous sample, or 0 if it did not
+     * exist yet
+     *
+     * @param number Task number as reported by uxTaskGetSystemState()
+     */
+    uint32_t PreviousRuntime(const UBaseType_t number)
+    {
+      for (UBaseType_t i{0}; i < previous_count; ++i)
+      {
+        if (previous_numbers[i] == number)
+        {
+          return previous_runtimes[i];
+        }
+      }
+      return 0;
+    }
+  } // namespace
+#endif
+
+  void TaskProfiler::Start(const uint32_t period_ms,
+                           const UBaseType_t priority,
+                           const BaseType_t core_id)
+  {
+    static StackType_t stack[ESPTOOLS_TASK_PROFILER_STACK_SIZE / sizeof(StackType_t)];
+    static StaticTask_t task_buffer;
+    static TaskHandle_t task{nullptr};
+    if (task)
+    {
+      ESPTOOLS_LOGW("Task profiler already started");
+      return;
+    }
+
+    const TickType_t period{(pdMS_TO_TICKS(period_ms) > 0) ? pdMS_TO_TICKS(period_ms) : 1};
+    task = xTaskCreateStaticPinnedToCore(TaskEntry, "esptools_prof",
+                                         sizeof(stack) / sizeof(StackType_t),
+                                         reinterpret_cast<void *>(static_cast<uintptr_t>(period)),
+                                         priority, stack, &task_buffer, core_id);
+  }
+
+  UBaseType_t TaskProfiler::Sample()
+  {
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+    const UBaseType_t capacity{static_cast<UBaseType_t>(ESPTOOLS_TASK_PROFILER_MAX_TASKS)};
+    const UBaseType_t task_count{uxTaskGetNumberOfTasks()};
+    if (task_count > capacity)
+    {
+      // uxTaskGetSystemState() fills nothing when the array is too small
+      ESPTOOLS_LOGW_RL("%u tasks running but only room for %u, sample skipped: increase "
+                       "ESPTOOLS_TASK_PROFILER_MAX_TASKS",
+                       static_cast<unsigned>(task_count), static_cast<unsigned>(capacity));
+      return 0;
+    }
+
+    uint32_t total_runtime{0};
+    const UBaseType_t count{uxTaskGetSystemState(statuses, capacity, &total_runtime)};
+    // Unsigned arithmetic keeps the deltas valid across a single wrap of the counters
+    const uint32_t total_delta{total_runtime - previous_total_runtime};
+    if (count == 0 || total_delta == 0)
+    {
+      return 0;
+    }
+
+    for (UBaseType_t i{0}; i < count; ++i)
+    {
+      const TaskStatus_t &status{statuses[i]};
+      const uint32_t delta{status.ulRunTimeCounter - PreviousRuntime(status.xTaskNumber)};
+      // CPU usage in tenths of a percent
+      const uint32_t usage{
+          static_cast<uint32_t>((static_cast<uint64_t>(delta) * 1000) / total_delta)};
+      ESPTOOLS_LOGI("%-16s %3" PRIu32 ".%" PRIu32 "%% hwm %5u prio %2u",
+                    status.pcTaskName, usage / 10, usage % 10,
+                    static_cast<unsigned>(status.usStackHighWaterMark),
+                    static_cast<unsigned>(status.uxCurrentPriority));
+    }
+
+    // Updated after the whole snapshot is processed, as tasks may change their position
+    for (UBaseType_t i{0}; i < count; ++i)
+    {
+      previous_numbers[i] = statuses[i].xTaskNumber;
+      previous_runtimes[i] = statuses[i].ulRunTimeCounter;
+    }
+    previous_count = count;
+    previous_total_runtime = total_runtime;
+    return count;
+#else
+    ESPTOOLS_LOGE("configUSE_TRACE_FACILITY and configGENERATE_RUN_TIME_STATS are required");
+    return 0;
+#endif
+  }
+
+  void TaskProfiler::TaskEntry(void *arg)
+  {
+    const TickType_t period{static_cast<TickType_t>(reinterpret_cast<uintptr_t>(arg))};
+    TickType_t last_wake{xTaskGetTickCount()};
+    while (true)
+    {
+      // Sampled at a fixed rate, independently of the time spent logging
+      xTaskDelayUntil(&last_wake, period);
+      Sample();
+    }
+  }
+
+} // namespace ESPTools
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/logger.h"
+
+#include <freertos/FreeRTOS.h>
+
+#include <cstdint>
+
+// Maximum number of tasks tracked by the profiler
+#ifndef ESPTOOLS_TASK_PROFILER_MAX_TASKS
+#define ESPTOOLS_TASK_PROFILER_MAX_TASKS 24
+#endif
+
+// Stack size in bytes of the task that samples the statistics
+#ifndef ESPTOOLS_TASK_PROFILER_STACK_SIZE
+#define ESPTOOLS_TASK_PROFILER_STACK_SIZE 3072
+#endif
+
+// Compile-time log level of the TaskProfiler module
+#ifndef ESPTOOLS_LOG_LEVEL_TASK_PROFILER
+#define ESPTOOLS_LOG_LEVEL_TASK_PROFILER ESPTOOLS_LOG_LEVEL
+#endif
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Periodic sampler of the FreeRTOS task statistics. Every sample computes, for each
+   * task, the CPU usage since the previous sample and the stack high water mark, and logs them in
+   * one line per task. Requires `configUSE_TRACE_FACILITY` and `configGENERATE_RUN_TIME_STATS`,
+   * as defined by the ESP8684_Debug env.
+   *
+   * @details All the buffers are statically allocated, nothing is allocated after `Start()`. The
+   * CPU usage is relative to the time of a single core, like `vTaskGetRunTimeStats()`, so on
+   * dual-core chips the sum of all tasks is up to 200%.
+   */
+  class TaskProfiler
+  {
+  public:
+    /**
+     * @brief Starts the task that samples the statistics periodically
+     *
+     * @param period_ms Sampling period in milliseconds
+     * @param priority Priority of the sampling task
+     * @param core_id Core the sampling task is pinned to
+     */
+    static void Start(const uint32_t period_ms = 5000,
+                      const UBaseType_t priority = 1,
+                      const BaseType_t core_id = APP_CORE_ID);
+
+    /**
+     * @brief Takes a sample and logs the statistics of every task. Called periodically by the
+     * sampling task, it can also be called manually when the task is not started.
+     *
+     * @return Number of sampled tasks, 0 if the statistics are not available or if more than
+     * ESPTOOLS_TASK_PROFILER_MAX_TASKS tasks exist, in which case the sample is skipped
+     */
+    static UBaseType_t Sample();
+
+  private:
+    // Tag used for the logging system
+    static constexpr char LOG_TAG[]{ESPTOOLS_LOG_TAG_CREATOR("TaskProfiler")};
+    // Compile-time log level of the module
+    static constexpr esp_log_level_t LOG_LEVEL{ESPTOOLS_LOG_LEVEL_TASK_PROFILER};
+
+    /**
+     * @brief Entry point of the sampling task
+     *
+     * @param arg Sampling period in ticks
+     */
+    static void TaskEntry(void *arg);
+  };
+
+} // namespace ESPTools
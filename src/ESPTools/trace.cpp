@@ -0,0 +1,203 @@
+#include "ESPTools/trace.h"
+#include "ESPTools/logger.h"
+
+#include <esp_attr.h>
+#include <esp_cpu.h>
+#include <esp_rom_sys.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+
+namespace ESPTools
+{
+
+  namespace
+  {
+    static_assert((ESPTOOLS_TRACE_BUFFER_SIZE & (ESPTOOLS_TRACE_BUFFER_SIZE - 1)) == 0,
+                  "ESPTOOLS_TRACE_BUFFER_SIZE must be a power of two");
+
+    /**
+     * @brief Events of a core
+     */
+    struct CoreBuffer
+    {
+      // Number of reserved slots, saturated at the size of the buffer so it never wraps around
+      std::atomic<uint32_t> head;
+      // Events that did not fit
+      std::atomic<uint32_t> dropped;
+      // Time of the first event, aligns the cycle counters of the cores
+      int64_t anchor_us;
+      uint32_t anchor_cycles;
+      TraceEvent events[ESPTOOLS_TRACE_BUFFER_SIZE];
+    };
+
+    // Accessed from the ISRs, so it must not be placed in flash
+    DRAM_ATTR CoreBuffer buffers[portNUM_PROCESSORS]{};
+    DRAM_ATTR std::atomic<bool> recording{true};
+
+    /**
+     * @brief Returns the number of valid events of a buffer
+     */
+    uint32_t GetCount(const CoreBuffer &buffer)
+    {
+      return buffer.head.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Formats a line and forwards it to the writer
+     */
+    [[gnu::format(printf, 3, 4)]] void Print(const Trace::Writer writer,
+                                             void *const arg,
+                                             const char *const format, ...)
+    {
+      char line[160];
+      va_list args;
+      va_start(args, format);
+      const int length{vsnprintf(line, sizeof(line), format, args)};
+      va_end(args);
+      if (length > 0)
+      {
+        writer(line, (static_cast<size_t>(length) < sizeof(line)) ? length : sizeof(line) - 1,
+               arg);
+      }
+    }
+
+    /**
+     * @brief Writer that prints to stdout
+     */
+    void StdoutWriter(const char *const data, const size_t size, void *)
+    {
+      fwrite(data, 1, size, stdout);
+    }
+  } // namespace
+
+  void IRAM_ATTR Trace::Begin(const char *const name)
+  {
+    Record(TraceEventType::Begin, name,
+           xPortInIsrContext() ? 0 : reinterpret_cast<uintptr_t>(xTaskGetCurrentTaskHandle()));
+  }
+
+  void IRAM_ATTR Trace::End(const char *const name)
+  {
+    Record(TraceEventType::End, name,
+           xPortInIsrContext() ? 0 : reinterpret_cast<uintptr_t>(xTaskGetCurrentTaskHandle()));
+  }
+
+  void IRAM_ATTR Trace::Counter(const char *const name, const int32_t value)
+  {
+    Record(TraceEventType::Counter, name, static_cast<uint32_t>(value));
+  }
+
+  void Trace::Start() { recording.store(true, std::memory_order_relaxed); }
+
+  void Trace::Stop() { recording.store(false, std::memory_order_relaxed); }
+
+  void Trace::Clear()
+  {
+    for (CoreBuffer &buffer : buffers)
+    {
+      buffer.head.store(0, std::memory_order_release);
+      buffer.dropped.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  uint32_t Trace::GetDropped()
+  {
+    uint32_t dropped{0};
+    for (const CoreBuffer &buffer : buffers)
+    {
+      dropped += buffer.dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+  }
+
+  void Trace::Export(const Writer writer, void *const arg)
+  {
+    const bool was_recording{recording.exchange(false, std::memory_order_relaxed)};
+    static constexpr char PHASES[]{'B', 'E', 'C'};
+
+    Print(writer, arg, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    bool first{true};
+    for (size_t core{0}; core < portNUM_PROCESSORS; ++core)
+    {
+      const CoreBuffer &buffer{buffers[core]};
+      const uint32_t count{GetCount(buffer)};
+      // The cycles are unwrapped from the first event, whose time is known, and converted
+      // interval by interval as the frequency may change between them
+      int64_t ns{buffer.anchor_us * 1000};
+      uint32_t previous{buffer.anchor_cycles};
+      for (uint32_t i{0}; i < count; ++i)
+      {
+        const TraceEvent &event{buffer.events[i]};
+        // Signed, as an ISR may stamp its event before the one it interrupted
+        const int32_t delta{static_cast<int32_t>(event.cycles - previous)};
+        previous = event.cycles;
+        ns += static_cast<int64_t>(delta) * 1000 / ((event.cpu_mhz > 0) ? event.cpu_mhz : 1);
+        const unsigned phase{static_cast<unsigned>(event.type)};
+        Print(writer, arg, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%" PRId64 ".%03" PRId32
+                           ",\"pid\":%u,",
+              first ? "" : ",\n", event.name, PHASES[phase], ns / 1000,
+              static_cast<int32_t>(ns % 1000), static_cast<unsigned>(core));
+        if (event.type == TraceEventType::Counter)
+        {
+          Print(writer, arg, "\"tid\":0,\"args\":{\"value\":%" PRId32 "}}",
+                static_cast<int32_t>(event.value));
+        }
+        else
+        {
+          Print(writer, arg, "\"tid\":%" PRIu32 "}", event.value);
+        }
+        first = false;
+      }
+    }
+    Print(writer, arg, "\n]}\n");
+
+    if (was_recording)
+    {
+      recording.store(true, std::memory_order_relaxed);
+    }
+  }
+
+  void Trace::Dump()
+  {
+    ESPTOOLS_LOGI("Trace begin, %" PRIu32 " events dropped", GetDropped());
+    Export(StdoutWriter);
+    fflush(stdout);
+    ESPTOOLS_LOGI("Trace end");
+  }
+
+  void IRAM_ATTR Trace::Record(const TraceEventType type,
+                               const char *const name,
+                               const uint32_t value)
+  {
+    if (!recording.load(std::memory_order_relaxed))
+    {
+      return;
+    }
+    CoreBuffer &buffer{buffers[esp_cpu_get_core_id()]};
+    // Only reserves a slot while there is one
+    uint32_t index{buffer.head.load(std::memory_order_relaxed)};
+    do
+    {
+      if (index >= ESPTOOLS_TRACE_BUFFER_SIZE)
+      {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+    } while (!buffer.head.compare_exchange_weak(index, index + 1, std::memory_order_relaxed));
+    const uint32_t cycles{esp_cpu_get_cycle_count()};
+    if (index == 0)
+    {
+      buffer.anchor_us = esp_timer_get_time();
+      buffer.anchor_cycles = cycles;
+    }
+    const uint16_t cpu_mhz{static_cast<uint16_t>(esp_rom_get_cpu_ticks_per_us())};
+    buffer.events[index] = {cycles, name, value, type, cpu_mhz};
+  }
+
+} // namespace ESPTools
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "ESPTools/core.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Number of events recorded per core. Must be a power of two.
+#ifndef ESPTOOLS_TRACE_BUFFER_SIZE
+#define ESPTOOLS_TRACE_BUFFER_SIZE 256
+#endif
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Kind of a trace event
+   */
+  enum class TraceEventType : uint8_t
+  {
+    Begin,
+    End,
+    Counter,
+  };
+
+  /**
+   * @brief Binary trace event. The name is stored as a pointer, so it must have static storage
+   * duration (a string literal).
+   */
+  struct TraceEvent
+  {
+    uint32_t cycles;
+    const char *name;
+    // Counter value, or the task that recorded a Begin or End event (0 in an ISR)
+    uint32_t value;
+    TraceEventType type;
+    // CPU frequency when the event was recorded, as it changes with dynamic frequency scaling
+    uint16_t cpu_mhz;
+  };
+
+  /**
+   * @brief Records cycle-stamped events from the `ESPTOOLS_TRACE_SCOPE` and
+   * `ESPTOOLS_TRACE_COUNTER` macros, and exports them as a Chrome trace event JSON document, which
+   * Perfetto (ui.perfetto.dev) and chrome://tracing open directly.
+   *
+   * @details Every core has its own buffer of ESPTOOLS_TRACE_BUFFER_SIZE events, so recording an
+   * event never contends with the other core: a slot is reserved with a compare-and-swap that
+   * stops at the end of the buffer, and the event is written into it, without locks. Only the
+   * tasks and ISRs of the same core can share a buffer. Recording starts at boot and stops when a
+   * buffer is full, so a trace covers the window between two `Clear()` calls; later events are
+   * counted as dropped, and never overwrite the recorded ones.
+   *
+   * The cycle counter of each core is 32 bits wide, so consecutive events of a core must be less
+   * than 2^31 cycles apart (about 13 s at 160 MHz) for the export to place them correctly. The
+   * buffers are aligned with `esp_timer` timestamps taken with the first event of each core.
+   * Every event also stores the CPU frequency, so the cycles are converted with the frequency they
+   * were counted at when dynamic frequency scaling (`esp_pm`, PerfLock) is active. Only the
+   * interval that contains a frequency switch is approximate, as it is converted with the
+   * frequency of its last event.
+   *
+   * The only export format is the JSON document, produced after the fact by `Export()` while the
+   * recording is paused. There is no streaming or binary format: events are not sent while they
+   * are recorded, and a trace longer than the buffers needs several Clear() and Export() rounds.
+   *
+   * Tracing is compiled in when `ESPTOOLS_TRACE` is 1, which is the default in debug builds. In
+   * release builds the macros expand to nothing, arguments included, unless
+   * `-D ESPTOOLS_TRACE=1` is given.
+   */
+  class Trace
+  {
+  public:
+    /**
+     * @brief Function that outputs a chunk of the exported trace
+     *
+     * @param data Text to output, not null terminated
+     * @param size Length of the text
+     * @param arg User argument given to `Export()`
+     */
+    using Writer = void (*)(const char *data, size_t size, void *arg);
+
+    /**
+     * @brief Records the beginning of a scope. Can be called from an ISR.
+     */
+    static void Begin(const char *const name);
+
+    /**
+     * @brief Records the end of a scope. Can be called from an ISR.
+     */
+    static void End(const char *const name);
+
+    /**
+     * @brief Records the value of a counter. Can be called from an ISR.
+     */
+    static void Counter(const char *const name, const int32_t value);
+
+    /**
+     * @brief Resumes the recording of events
+     */
+    static void Start();
+
+    /**
+     * @brief Pauses the recording of events. Events recorded at the same time may be lost.
+     */
+    static void Stop();
+
+    /**
+     * @brief Discards the recorded events, so the recording starts again from an empty buffer
+     */
+    static void Clear();
+
+    /**
+     * @brief Returns the number of events that did not fit in the buffers
+     */
+    static uint32_t GetDropped();
+
+    /**
+     * @brief Exports the recorded events as Chrome trace event JSON. Recording is paused during
+     * the export.
+     *
+     * @details Each core is a process of the trace and each task a thread, ISRs are thread 0.
+     * Timestamps are in microseconds.
+     *
+     * @param writer Function that outputs the text, e.g. to a file or an `esp_apptrace` channel
+     * @param arg User argument forwarded to the writer
+     */
+    static void Export(const Writer writer, void *const arg = nullptr);
+
+    /**
+     * @brief Exports the recorded events to the console (stdout, which is the UART or the USB
+     * JTAG console). The JSON is printed between "Trace begin" and "Trace end" log lines.
+     */
+    static void Dump();
+
+  private:
+    // Tag used for the logging system
+    static constexpr char LOG_TAG[]{ESPTOOLS_LOG_TAG_CREATOR("Trace")};
+
+    /**
+     * @brief Reserves a slot in the buffer of the current core and writes the event into it
+     */
+    static void Record(const TraceEventType type, const char *const name, const uint32_t value);
+  };
+
+  /**
+   * @brief Records a Begin event when constructed and an End event when destroyed. Used by
+   * `ESPTOOLS_TRACE_SCOPE`.
+   */
+  class TraceScope
+  {
+  public:
+    explicit TraceScope(const char *const name) : name_(name) { Trace::Begin(name_); }
+    ~TraceScope() { Trace::End(name_); }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+  private:
+    const char *const name_;
+  };
+
+} // namespace ESPTools
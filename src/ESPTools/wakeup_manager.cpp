@@ -0,0 +1,155 @@
+#include "ESPTools/wakeup_manager.h"
+#include "ESPTools/logger.h"
+
+#include <bit>
+
+namespace ESPTools
+{
+
+  bool WakeupManager::AddPin(const gpio_num_t pin,
+                             const GpioState wake_state,
+                             const bool inverse_logic,
+                             const gpio_int_type_t intr_type)
+  {
+    if (!GPIO_IS_VALID_GPIO(pin) || wake_state == GpioState::Undefined)
+    {
+      ESPTOOLS_LOGE("Invalid wake pin GPIO %d (state %s)", pin, wake_state.ToStr());
+      return false;
+    }
+    const GpioStateSet::Mask mask{CreateBitMaskAt<GpioStateSet::Mask>(pin)};
+    // The logical state is converted to the physical level the same way GpioState does
+    const GpioState level(wake_state == GpioState::High, inverse_logic);
+    pins_ |= mask;
+    wake_high_ = (level == GpioState::High) ? (wake_high_ | mask) : (wake_high_ & ~mask);
+    inverse_ = inverse_logic ? (inverse_ | mask) : (inverse_ & ~mask);
+    intr_types_[pin] = intr_type;
+    ESPTOOLS_LOGD("GPIO %d wakes up on %s (level %s)", pin, wake_state.ToStr(), level.ToStr());
+    return true;
+  }
+
+  void WakeupManager::RemovePin(const gpio_num_t pin)
+  {
+    const GpioStateSet::Mask mask{CreateBitMaskAt<GpioStateSet::Mask>(pin)};
+    pins_ &= ~mask;
+    wake_high_ &= ~mask;
+    inverse_ &= ~mask;
+  }
+
+  Wakeup WakeupManager::LightSleep(const uint64_t timeout_us)
+  {
+    for (GpioStateSet::Mask pins{pins_}; pins; pins &= pins - 1)
+    {
+      const gpio_num_t pin{static_cast<gpio_num_t>(std::countr_zero(pins))};
+      const bool high{(wake_high_ & CreateBitMaskAt<GpioStateSet::Mask>(pin)) != 0};
+      ESP_ERROR_CHECK(gpio_wakeup_enable(pin, high ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL));
+    }
+    ESP_ERROR_CHECK(esp_sleep_enable_gpio_wakeup());
+    if (timeout_us > 0)
+    {
+      ESP_ERROR_CHECK(esp_sleep_enable_timer_wakeup(timeout_us));
+    }
+
+    const esp_err_t ret{esp_light_sleep_start()};
+    // Single read of every wake pin, before anything else delays it
+    const GpioStateSet levels{GpioStateSet::ReadInputs(pins_)};
+    const esp_sleep_wakeup_cause_t cause{esp_sleep_get_wakeup_cause()};
+
+    if (timeout_us > 0)
+    {
+      ESP_ERROR_CHECK(esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER));
+    }
+    for (GpioStateSet::Mask pins{pins_}; pins; pins &= pins - 1)
+    {
+      const gpio_num_t pin{static_cast<gpio_num_t>(std::countr_zero(pins))};
+      ESP_ERROR_CHECK(gpio_wakeup_disable(pin));
+      ESP_ERROR_CHECK(gpio_set_intr_type(pin, intr_types_[pin]));
+    }
+
+    // The sleep is rejected when a wake pin is already in its wake state
+    GpioStateSet::Mask fired{0};
+    if (ret != ESP_OK || cause == ESP_SLEEP_WAKEUP_GPIO)
+    {
+      fired = pins_ & ~levels.Changed(GpioStateSet(wake_high_, pins_));
+    }
+    ESPTOOLS_LOGD("Woken up from light sleep (cause %d, pins 0x%08" PRIx32 "%08" PRIx32 ")",
+                  cause, static_cast<uint32_t>(fired >> 32), static_cast<uint32_t>(fired));
+    return Resolve(cause, levels.Select(fired));
+  }
+
+  void WakeupManager::DeepSleep(const uint64_t timeout_us)
+  {
+#if SOC_PM_SUPPORT_EXT_WAKEUP
+    if (pins_)
+    {
+      // EXT1 applies the same level to every pin
+      if (wake_high_ != 0 && wake_high_ != pins_)
+      {
+        ESPTOOLS_LOGE("Deep sleep wake pins must share the same level");
+        ESP_ERROR_CHECK(ESP_ERR_INVALID_STATE);
+      }
+#if CONFIG_IDF_TARGET_ESP32
+      const esp_sleep_ext1_wakeup_mode_t mode{wake_high_ ? ESP_EXT1_WAKEUP_ANY_HIGH
+                                                         : ESP_EXT1_WAKEUP_ALL_LOW};
+#else
+      const esp_sleep_ext1_wakeup_mode_t mode{wake_high_ ? ESP_EXT1_WAKEUP_ANY_HIGH
+                                                         : ESP_EXT1_WAKEUP_ANY_LOW};
+#endif
+      ESP_ERROR_CHECK(esp_sleep_enable_ext1_wakeup(pins_, mode));
+    }
+#elif SOC_GPIO_SUPPORT_DEEPSLEEP_WAKEUP
+    if (wake_high_)
+    {
+      ESP_ERROR_CHECK(esp_deep_sleep_enable_gpio_wakeup(wake_high_, ESP_GPIO_WAKEUP_GPIO_HIGH));
+    }
+    if (pins_ & ~wake_high_)
+    {
+      ESP_ERROR_CHECK(esp_deep_sleep_enable_gpio_wakeup(pins_ & ~wake_high_,
+                                                        ESP_GPIO_WAKEUP_GPIO_LOW));
+    }
+#else
+    if (pins_)
+    {
+      ESPTOOLS_LOGE("GPIO wakeup from deep sleep is not supported by this chip");
+      ESP_ERROR_CHECK(ESP_ERR_NOT_SUPPORTED);
+    }
+#endif
+    if (timeout_us > 0)
+    {
+      ESP_ERROR_CHECK(esp_sleep_enable_timer_wakeup(timeout_us));
+    }
+    ESPTOOLS_LOGD("Entering deep sleep");
+    esp_deep_sleep_start();
+  }
+
+  Wakeup WakeupManager::GetDeepSleepWakeup() const
+  {
+    const esp_sleep_wakeup_cause_t cause{esp_sleep_get_wakeup_cause()};
+    GpioStateSet::Mask fired{0};
+#if SOC_PM_SUPPORT_EXT_WAKEUP
+    if (cause == ESP_SLEEP_WAKEUP_EXT1)
+    {
+      fired = esp_sleep_get_ext1_wakeup_status() & pins_;
+    }
+#elif SOC_GPIO_SUPPORT_DEEPSLEEP_WAKEUP
+    if (cause == ESP_SLEEP_WAKEUP_GPIO)
+    {
+      fired = esp_sleep_get_gpio_wakeup_status() & pins_;
+    }
+#endif
+    // The latched pins were at their wake level
+    return Resolve(cause, GpioStateSet(wake_high_, fired));
+  }
+
+  Wakeup WakeupManager::Resolve(const esp_sleep_wakeup_cause_t cause,
+                                const GpioStateSet &levels) const
+  {
+    const GpioStateSet::Mask fired{levels.GetDefined()};
+    if (fired == 0)
+    {
+      return {cause, 0, GPIO_NUM_NC, GpioState()};
+    }
+    const gpio_num_t pin{static_cast<gpio_num_t>(std::countr_zero(fired))};
+    return {cause, fired, pin, levels.ApplyInverseLogic(inverse_).Get(pin)};
+  }
+
+} // namespace ESPTools
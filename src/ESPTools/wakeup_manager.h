@@ -0,0 +1,134 @@
+#pragma once
+
+#include "ESPTools/core.h"
+#include "ESPTools/gpio_state.h"
+#include "ESPTools/gpio_state_set.h"
+#include "ESPTools/logger.h"
+
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+#include <soc/soc_caps.h>
+
+#include <cstdint>
+
+// Compile-time log level of the WakeupManager module
+#ifndef ESPTOOLS_LOG_LEVEL_WAKEUP_MANAGER
+#define ESPTOOLS_LOG_LEVEL_WAKEUP_MANAGER ESPTOOLS_LOG_LEVEL
+#endif
+
+namespace ESPTools
+{
+
+  /**
+   * @brief Reason of a wakeup, as reported by the WakeupManager
+   */
+  struct Wakeup
+  {
+    // Wakeup source reported by ESP-IDF
+    esp_sleep_wakeup_cause_t cause;
+    // Wake pins that were in their wake state, bit N corresponds to GPIO N
+    GpioStateSet::Mask fired;
+    // Lowest GPIO of `fired`, GPIO_NUM_NC if the wakeup was not caused by a pin
+    gpio_num_t pin;
+    // Logical state of `pin` at the wakeup
+    GpioState state;
+  };
+
+  /**
+   * @brief Enters light or deep sleep with a set of wake pins, and reports which pin woke the chip
+   * up. Every pin wakes up on a logical GpioState, with the `inverse_logic` parameter applied the
+   * same way as the GpioState constructor does, so an active low button wakes up on "High".
+   *
+   * @details The time spent awake per event is kept to a minimum: after a light sleep all the
+   * wake pins are resolved with a single GpioStateSet read of the input registers, taken right
+   * after `esp_light_sleep_start()` returns. After a deep sleep the pins are taken from the
+   * wakeup status latched by the hardware, so no pin is read at all.
+   *
+   * The wake pins use level triggered wakeup, which replaces their interrupt type while the chip
+   * sleeps. It is set back to the type given in `AddPin()` once the chip wakes up.
+   *
+   * Deep sleep has chip specific restrictions: on the chips with EXT1 wakeup (ESP32, ESP32-S3)
+   * only RTC GPIOs can be used and all the pins must wake up on the same physical level (on the
+   * ESP32 a Low level only wakes up when all the pins are Low). On the chips with deep sleep GPIO
+   * wakeup (ESP32-C2, ESP32-C3) only the pins of the RTC/LP domain can be used.
+   */
+  class WakeupManager
+  {
+  public:
+    constexpr WakeupManager() : pins_(0), wake_high_(0), inverse_(0), intr_types_() {}
+
+    /**
+     * @brief Adds a wake pin. The pin must already be configured as an input.
+     *
+     * @param pin GPIO number
+     * @param wake_state Logical state that wakes up the chip, High or Low
+     * @param inverse_logic If set to true, the logic of the pin is inverted (active low pin)
+     * @param intr_type Interrupt type restored on the pin after every sleep
+     * @return False if the pin or the state are not valid
+     */
+    bool AddPin(const gpio_num_t pin,
+                const GpioState wake_state,
+                const bool inverse_logic = false,
+                const gpio_int_type_t intr_type = GPIO_INTR_DISABLE);
+
+    /**
+     * @brief Removes a wake pin
+     *
+     * @param pin GPIO number
+     */
+    void RemovePin(const gpio_num_t pin);
+
+    /**
+     * @brief Enters light sleep until a wake pin reaches its wake state, or until the timeout
+     * expires
+     *
+     * @param timeout_us Maximum sleep time in microseconds, 0 to sleep without timeout
+     * @return Reason of the wakeup
+     */
+    Wakeup LightSleep(const uint64_t timeout_us = 0);
+
+    /**
+     * @brief Enters deep sleep until a wake pin reaches its wake state, or until the timeout
+     * expires. The chip reboots on wakeup, use `GetDeepSleepWakeup()` at boot to know the reason.
+     *
+     * @param timeout_us Maximum sleep time in microseconds, 0 to sleep without timeout
+     */
+    [[noreturn]] void DeepSleep(const uint64_t timeout_us = 0);
+
+    /**
+     * @brief Returns the reason of the wakeup from deep sleep, from the status latched by the
+     * hardware. The wake pins must have been added again after the reboot, so their logical
+     * states are known.
+     */
+    Wakeup GetDeepSleepWakeup() const;
+
+    /**
+     * @brief Returns the mask of the wake pins
+     */
+    constexpr GpioStateSet::Mask GetPins() const { return pins_; }
+
+  private:
+    // Tag used for the logging system
+    static constexpr char LOG_TAG[]{ESPTOOLS_LOG_TAG_CREATOR("WakeupManager")};
+    // Compile-time log level of the module
+    static constexpr esp_log_level_t LOG_LEVEL{ESPTOOLS_LOG_LEVEL_WAKEUP_MANAGER};
+
+    /**
+     * @brief Builds the wakeup result from the physical levels of the wake pins
+     *
+     * @param cause Wakeup source reported by ESP-IDF
+     * @param levels Physical levels of the wake pins
+     */
+    Wakeup Resolve(const esp_sleep_wakeup_cause_t cause, const GpioStateSet &levels) const;
+
+    // Wake pins
+    GpioStateSet::Mask pins_;
+    // Wake pins that wake up on a physical High level, the rest wake up on Low
+    GpioStateSet::Mask wake_high_;
+    // Wake pins with inverse logic
+    GpioStateSet::Mask inverse_;
+    // Interrupt type restored on each pin after a light sleep
+    gpio_int_type_t intr_types_[SOC_GPIO_PIN_COUNT];
+  };
+
+} // namespace ESPTools
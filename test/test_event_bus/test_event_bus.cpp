@@ -0,0 +1,192 @@
+#include <ESPTools/event_bus.h>
+
+#include <driver/gpio.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <host_hal.h>
+
+#include <unity.h>
+
+#include <cstdint>
+#include <thread>
+
+// EventBus delivery, reference counting and drops, in tasks and in an ISR
+
+namespace
+{
+
+  enum class TestTopic : uint8_t
+  {
+    Sensor,
+    Button,
+  };
+
+  template <size_t POOL_SIZE = 4, size_t QUEUE_SIZE = 4>
+  using TestBus = ESPTools::EventBus<TestTopic, uint32_t, POOL_SIZE, 4, QUEUE_SIZE>;
+
+  void TestMaskOf()
+  {
+    static_assert(TestBus<>::MaskOf<TestTopic::Sensor>() == 0b01);
+    static_assert(TestBus<>::MaskOf<TestTopic::Sensor, TestTopic::Button>() == 0b11);
+  }
+
+  void TestFanOut()
+  {
+    // Every subscriber of the topic sees the same event, the others none
+    TestBus<> bus;
+    TestBus<>::Subscriber first;
+    TestBus<>::Subscriber second;
+    TestBus<>::Subscriber buttons;
+    TEST_ASSERT_TRUE(bus.Subscribe<TestTopic::Sensor>(first));
+    TEST_ASSERT_TRUE((bus.Subscribe<TestTopic::Sensor, TestTopic::Button>(second)));
+    TEST_ASSERT_TRUE(bus.Subscribe<TestTopic::Button>(buttons));
+
+    TEST_ASSERT_TRUE(bus.Publish<TestTopic::Sensor>(42));
+    const TestBus<>::EventRef a{first.Receive(0)};
+    const TestBus<>::EventRef b{second.Receive(0)};
+    TEST_ASSERT_TRUE(a && b);
+    TEST_ASSERT_EQUAL_PTR(&*a, &*b);
+    TEST_ASSERT_EQUAL(TestTopic::Sensor, a->topic);
+    TEST_ASSERT_EQUAL_UINT32(42, a->payload);
+    TEST_ASSERT_FALSE(buttons.Receive(0));
+  }
+
+  void TestSubscriberLimit()
+  {
+    ESPTools::EventBus<TestTopic, uint32_t, 4, 1, 4> bus;
+    decltype(bus)::Subscriber first;
+    decltype(bus)::Subscriber second;
+    TEST_ASSERT_TRUE(bus.Subscribe<TestTopic::Sensor>(first));
+    TEST_ASSERT_FALSE(bus.Subscribe<TestTopic::Sensor>(second));
+  }
+
+  void TestPoolExhausted()
+  {
+    // A slot only returns to the pool when the last subscriber releases its event
+    TestBus<2> bus;
+    TestBus<2>::Subscriber first;
+    TestBus<2>::Subscriber second;
+    bus.Subscribe<TestTopic::Sensor>(first);
+    bus.Subscribe<TestTopic::Sensor>(second);
+
+    TEST_ASSERT_TRUE(bus.Publish<TestTopic::Sensor>(1));
+    TEST_ASSERT_TRUE(bus.Publish<TestTopic::Sensor>(2));
+    TEST_ASSERT_FALSE(bus.Publish<TestTopic::Sensor>(3));
+    TEST_ASSERT_EQUAL_UINT32(1, bus.GetDropped());
+    TEST_ASSERT_EQUAL_UINT(0, bus.GetMinAvailable());
+
+    TestBus<2>::EventRef event{first.Receive(0)};
+    TEST_ASSERT_EQUAL_UINT32(1, event->payload);
+    event.Reset();
+    TEST_ASSERT_FALSE(bus.Publish<TestTopic::Sensor>(4));
+
+    TEST_ASSERT_EQUAL_UINT32(1, second.Receive(0)->payload);
+    TEST_ASSERT_TRUE(bus.Publish<TestTopic::Sensor>(5));
+    TEST_ASSERT_EQUAL_UINT32(2, bus.GetDropped());
+  }
+
+  void TestQueueFull()
+  {
+    // A full subscriber misses the event, the others still get it
+    TestBus<8, 2> bus;
+    TestBus<8, 2>::Subscriber slow;
+    TestBus<8, 2>::Subscriber fast;
+    bus.Subscribe<TestTopic::Sensor>(slow);
+    bus.Subscribe<TestTopic::Sensor>(fast);
+    for (uint32_t i{0}; i < 3; ++i)
+    {
+      TEST_ASSERT_TRUE(bus.Publish<TestTopic::Sensor>(i));
+      TEST_ASSERT_EQUAL_UINT32(i, fast.Receive(0)->payload);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, slow.GetDropped());
+    TEST_ASSERT_EQUAL_UINT32(0, fast.GetDropped());
+    TEST_ASSERT_EQUAL_UINT32(0, bus.GetDropped());
+
+    uint32_t expected{0};
+    TEST_ASSERT_EQUAL_UINT(2, slow.Drain(
+                                  [&expected](const TestBus<8, 2>::Event &event)
+                                  { TEST_ASSERT_EQUAL_UINT32(expected++, event.payload); }));
+    // Every slot went back to the pool
+    for (uint32_t i{0}; i < 8; ++i)
+    {
+      TEST_ASSERT_TRUE(bus.Publish<TestTopic::Button>(i));
+    }
+  }
+
+  void TestReceiveWaitsPastStaleNotifications()
+  {
+    // The notifications of drained events must not end the wait early
+    TestBus<> bus;
+    TestBus<>::Subscriber subscriber;
+    bus.Subscribe<TestTopic::Sensor>(subscriber);
+    bus.Publish<TestTopic::Sensor>(1);
+    bus.Publish<TestTopic::Sensor>(2);
+    TEST_ASSERT_EQUAL_UINT(2, subscriber.Drain([](const TestBus<>::Event &) {}));
+
+    const int64_t start{esp_timer_get_time()};
+    TEST_ASSERT_FALSE(subscriber.Receive(pdMS_TO_TICKS(50)));
+    TEST_ASSERT_GREATER_OR_EQUAL(50000, esp_timer_get_time() - start);
+  }
+
+  void TestReceiveFromOtherTask()
+  {
+    static TestBus<> bus;
+    static TestBus<>::Subscriber subscriber;
+    bus.Subscribe<TestTopic::Sensor>(subscriber);
+    std::thread publisher(
+        []
+        {
+          vTaskDelay(pdMS_TO_TICKS(20));
+          bus.Publish<TestTopic::Sensor>(7);
+        });
+    const TestBus<>::EventRef event{subscriber.Receive()};
+    publisher.join();
+    TEST_ASSERT_TRUE(event);
+    TEST_ASSERT_EQUAL_UINT32(7, event->payload);
+  }
+
+  void TestPublishFromIsr()
+  {
+    static TestBus<> bus;
+    static TestBus<>::Subscriber subscriber;
+    bus.Subscribe<TestTopic::Button>(subscriber);
+
+    gpio_reset_pin(GPIO_NUM_4);
+    gpio_set_intr_type(GPIO_NUM_4, GPIO_INTR_POSEDGE);
+    gpio_install_isr_service(0);
+    gpio_isr_handler_add(
+        GPIO_NUM_4,
+        [](void *)
+        { bus.Publish<TestTopic::Button>(static_cast<uint32_t>(xPortInIsrContext())); },
+        nullptr);
+    gpio_intr_enable(GPIO_NUM_4);
+    host_gpio_set_input_level(GPIO_NUM_4, 0);
+    host_gpio_set_input_level(GPIO_NUM_4, 1);
+    gpio_isr_handler_remove(GPIO_NUM_4);
+
+    const TestBus<>::EventRef event{subscriber.Receive(0)};
+    TEST_ASSERT_TRUE(event);
+    // Published in interrupt context
+    TEST_ASSERT_EQUAL_UINT32(1, event->payload);
+  }
+
+} // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(TestMaskOf);
+  RUN_TEST(TestFanOut);
+  RUN_TEST(TestSubscriberLimit);
+  RUN_TEST(TestPoolExhausted);
+  RUN_TEST(TestQueueFull);
+  RUN_TEST(TestReceiveWaitsPastStaleNotifications);
+  RUN_TEST(TestReceiveFromOtherTask);
+  RUN_TEST(TestPublishFromIsr);
+  return UNITY_END();
+}
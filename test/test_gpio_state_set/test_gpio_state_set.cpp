@@ -0,0 +1,147 @@
+#include <ESPTools/core.h>
+#include <ESPTools/gpio_state.h>
+#include <ESPTools/gpio_state_set.h>
+
+#include <driver/gpio.h>
+#include <host_hal.h>
+#include <soc/soc_caps.h>
+
+#include <unity.h>
+
+#include <cstdint>
+
+// CreateBitMaskAt and GpioStateSet, including the bank accesses on the emulated GPIO registers
+
+namespace
+{
+
+  using ESPTools::CreateBitMaskAt;
+  using ESPTools::GpioState;
+  using ESPTools::GpioStateSet;
+
+  // The masks are also usable at compile time, and 64 bits wide for the upper GPIOs
+  static_assert(CreateBitMaskAt<uint64_t>(0) == 1);
+  static_assert(CreateBitMaskAt<uint64_t>(39) == uint64_t{1} << 39);
+  static_assert(GpioStateSet(0b1010, 0b0110).GetLevels() == 0b0010);
+
+  void TestCreateBitMaskAt()
+  {
+    TEST_ASSERT_EQUAL_HEX32(0x1, CreateBitMaskAt<uint32_t>(0));
+    TEST_ASSERT_EQUAL_HEX32(0x80000000, CreateBitMaskAt<uint32_t>(31));
+    TEST_ASSERT_EQUAL_HEX64(uint64_t{1} << 32, CreateBitMaskAt<uint64_t>(32));
+    TEST_ASSERT_EQUAL_HEX64(uint64_t{1} << 63, CreateBitMaskAt<uint64_t>(63));
+    TEST_ASSERT_EQUAL_HEX32(0x10, CreateBitMaskAt<uint8_t>(4));
+  }
+
+  void TestSetAndGet()
+  {
+    GpioStateSet set;
+    TEST_ASSERT_EQUAL(GpioState::Undefined, set.Get(3));
+    set.Set(3, GpioState::High);
+    set.Set(40, GpioState::Low);
+    TEST_ASSERT_EQUAL(GpioState::High, set.Get(3));
+    TEST_ASSERT_EQUAL(GpioState::Low, set.Get(40));
+    TEST_ASSERT_EQUAL(GpioState::Undefined, set.Get(4));
+    TEST_ASSERT_EQUAL_HEX64(CreateBitMaskAt<uint64_t>(3), set.GetHigh());
+    TEST_ASSERT_EQUAL_HEX64(CreateBitMaskAt<uint64_t>(40), set.GetLow());
+    TEST_ASSERT_EQUAL_HEX64(CreateBitMaskAt<uint64_t>(3) | CreateBitMaskAt<uint64_t>(40),
+                            set.GetDefined());
+
+    // Undefining a pin also clears its level
+    set.Set(3, GpioState::Undefined);
+    TEST_ASSERT_EQUAL(GpioState::Undefined, set.Get(3));
+    TEST_ASSERT_EQUAL_HEX64(0, set.GetLevels());
+  }
+
+  void TestUndefinedLevelsCleared()
+  {
+    // Levels of undefined pins are dropped at construction, so sets compare without masking
+    const GpioStateSet set(0b1111, 0b0101);
+    TEST_ASSERT_EQUAL_HEX64(0b0101, set.GetLevels());
+    TEST_ASSERT_TRUE(set == GpioStateSet(0b0101, 0b0101));
+    TEST_ASSERT_EQUAL_INT(2, set.CountHigh());
+    TEST_ASSERT_EQUAL_INT(0, set.CountLow());
+  }
+
+  void TestChanged()
+  {
+    const GpioStateSet before(0b0011, 0b0111);
+    const GpioStateSet after(0b0101, 0b1101);
+    // Pin 1 and 2 changed level, pin 1 also went undefined, pin 3 became defined
+    TEST_ASSERT_EQUAL_HEX64(0b1110, before.Changed(after));
+    TEST_ASSERT_EQUAL_HEX64(0, before.Changed(before));
+  }
+
+  void TestInverseLogicAndSelect()
+  {
+    const GpioStateSet set(0b0001, 0b0011);
+    const GpioStateSet inverted{set.ApplyInverseLogic(0b1011)};
+    TEST_ASSERT_EQUAL(GpioState::Low, inverted.Get(0));
+    TEST_ASSERT_EQUAL(GpioState::High, inverted.Get(1));
+    // Undefined pins stay undefined
+    TEST_ASSERT_EQUAL(GpioState::Undefined, inverted.Get(3));
+
+    const GpioStateSet selected{set.Select(0b0010)};
+    TEST_ASSERT_EQUAL_HEX64(0b0010, selected.GetDefined());
+    TEST_ASSERT_EQUAL(GpioState::Undefined, selected.Get(0));
+    TEST_ASSERT_EQUAL(GpioState::Low, selected.Get(1));
+  }
+
+  void TestReadInputs()
+  {
+    gpio_reset_pin(GPIO_NUM_2);
+    gpio_reset_pin(GPIO_NUM_5);
+    host_gpio_set_input_level(GPIO_NUM_2, 1);
+    host_gpio_set_input_level(GPIO_NUM_5, 0);
+    const GpioStateSet inputs{GpioStateSet::ReadInputs(
+        CreateBitMaskAt<uint64_t>(GPIO_NUM_2) | CreateBitMaskAt<uint64_t>(GPIO_NUM_5))};
+    TEST_ASSERT_EQUAL(GpioState::High, inputs.Get(GPIO_NUM_2));
+    TEST_ASSERT_EQUAL(GpioState::Low, inputs.Get(GPIO_NUM_5));
+    TEST_ASSERT_EQUAL(GpioState::Undefined, inputs.Get(GPIO_NUM_3));
+
+    // Pins the chip does not have are left undefined
+    const GpioStateSet all{GpioStateSet::ReadInputs()};
+    TEST_ASSERT_EQUAL_HEX64(SOC_GPIO_VALID_GPIO_MASK, all.GetDefined());
+  }
+
+  void TestWriteOutputs()
+  {
+    gpio_set_direction(GPIO_NUM_6, GPIO_MODE_OUTPUT);
+    gpio_set_direction(GPIO_NUM_7, GPIO_MODE_OUTPUT);
+    gpio_set_direction(GPIO_NUM_8, GPIO_MODE_OUTPUT);
+    gpio_set_level(GPIO_NUM_6, 0);
+    gpio_set_level(GPIO_NUM_7, 1);
+    gpio_set_level(GPIO_NUM_8, 1);
+
+    GpioStateSet outputs;
+    outputs.Set(GPIO_NUM_6, GpioState::High);
+    outputs.Set(GPIO_NUM_7, GpioState::Low);
+    outputs.WriteOutputs();
+    TEST_ASSERT_EQUAL_INT(1, gpio_get_level(GPIO_NUM_6));
+    TEST_ASSERT_EQUAL_INT(0, gpio_get_level(GPIO_NUM_7));
+    // Undefined pins are left untouched
+    TEST_ASSERT_EQUAL_INT(1, gpio_get_level(GPIO_NUM_8));
+
+    const uint64_t pins{CreateBitMaskAt<uint64_t>(GPIO_NUM_6) |
+                        CreateBitMaskAt<uint64_t>(GPIO_NUM_7)};
+    TEST_ASSERT_TRUE(GpioStateSet::ReadInputs(pins) == outputs);
+  }
+
+} // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(TestCreateBitMaskAt);
+  RUN_TEST(TestSetAndGet);
+  RUN_TEST(TestUndefinedLevelsCleared);
+  RUN_TEST(TestChanged);
+  RUN_TEST(TestInverseLogicAndSelect);
+  RUN_TEST(TestReadInputs);
+  RUN_TEST(TestWriteOutputs);
+  return UNITY_END();
+}
@@ -0,0 +1,137 @@
+#include <ESPTools/log_rate_limit.h>
+#include <ESPTools/logger.h>
+
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <unity.h>
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+// LogRateLimiter (GCRA token bucket) and the ESPTOOLS_LOG*_RL macros. The intervals are long
+// compared to the time taken by the calls of a burst, so the results do not depend on the load of
+// the host.
+
+namespace
+{
+
+  using ESPTools::LogRateLimiter;
+
+  // Tag used for the logging system
+  constexpr char LOG_TAG[]{"Rate Limit Test"};
+
+  // Interval of the limiters, in milliseconds
+  constexpr uint32_t INTERVAL_MS{100};
+
+  // Lines written by the logging system
+  char last_line[256];
+  int line_count{0};
+
+  int CaptureLine(const char *const format, va_list args)
+  {
+    ++line_count;
+    return vsnprintf(last_line, sizeof(last_line), format, args);
+  }
+
+  void TestBurstThenInterval()
+  {
+    LogRateLimiter limiter{INTERVAL_MS, 3};
+    uint32_t suppressed{UINT32_MAX};
+    for (int i{0}; i < 3; ++i)
+    {
+      TEST_ASSERT_TRUE(limiter.Allow(suppressed));
+      TEST_ASSERT_EQUAL_UINT32(0, suppressed);
+    }
+    TEST_ASSERT_FALSE(limiter.Allow(suppressed));
+    TEST_ASSERT_FALSE(limiter.Allow(suppressed));
+
+    // One token comes back per interval, and reports the suppressed messages once
+    vTaskDelay(pdMS_TO_TICKS(INTERVAL_MS + 20));
+    TEST_ASSERT_TRUE(limiter.Allow(suppressed));
+    TEST_ASSERT_EQUAL_UINT32(2, suppressed);
+    TEST_ASSERT_FALSE(limiter.Allow(suppressed));
+  }
+
+  void TestRefillAfterIdle()
+  {
+    // An idle limiter lets a whole burst through again, but not more
+    LogRateLimiter limiter{INTERVAL_MS, 2};
+    uint32_t suppressed{0};
+    TEST_ASSERT_TRUE(limiter.Allow(suppressed));
+    TEST_ASSERT_TRUE(limiter.Allow(suppressed));
+    TEST_ASSERT_FALSE(limiter.Allow(suppressed));
+
+    vTaskDelay(pdMS_TO_TICKS(5 * INTERVAL_MS));
+    TEST_ASSERT_TRUE(limiter.Allow(suppressed));
+    TEST_ASSERT_EQUAL_UINT32(1, suppressed);
+    TEST_ASSERT_TRUE(limiter.Allow(suppressed));
+    TEST_ASSERT_EQUAL_UINT32(0, suppressed);
+    TEST_ASSERT_FALSE(limiter.Allow(suppressed));
+  }
+
+  void TestNoBurst()
+  {
+    // A burst of 0 behaves as a burst of 1
+    LogRateLimiter limiter{INTERVAL_MS, 0};
+    uint32_t suppressed{0};
+    TEST_ASSERT_TRUE(limiter.Allow(suppressed));
+    TEST_ASSERT_FALSE(limiter.Allow(suppressed));
+  }
+
+  /**
+   * @brief Single rate limited call site, so all the calls share its bucket
+   */
+  void LogMessage(const int i)
+  {
+    ESPTOOLS_LOG_WRITE_RATE_LIMITED(ESP_LOG_WARN, INTERVAL_MS, 2, "message %d", i);
+  }
+
+  void TestMacroReportsSuppressed()
+  {
+    for (int i{0}; i < 10; ++i)
+    {
+      LogMessage(i);
+    }
+    TEST_ASSERT_EQUAL_INT(2, line_count);
+    TEST_ASSERT_NOT_NULL(strstr(last_line, "message 1"));
+
+    vTaskDelay(pdMS_TO_TICKS(INTERVAL_MS + 20));
+    LogMessage(10);
+    LogMessage(11);
+    // "Suppressed 8 messages" precedes the message let through, the next one is suppressed
+    TEST_ASSERT_EQUAL_INT(4, line_count);
+    TEST_ASSERT_NOT_NULL(strstr(last_line, "message 10"));
+  }
+
+  void TestMacroCompiledOut()
+  {
+    // The bucket is removed along with the message
+    static constexpr esp_log_level_t LOG_LEVEL{ESP_LOG_ERROR};
+    ESPTOOLS_LOGW_RL("message");
+    TEST_ASSERT_EQUAL_INT(0, line_count);
+  }
+
+} // namespace
+
+void setUp()
+{
+  line_count = 0;
+  last_line[0] = '\0';
+  esp_log_set_vprintf(CaptureLine);
+}
+
+void tearDown() { esp_log_set_vprintf(vprintf); }
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(TestBurstThenInterval);
+  RUN_TEST(TestRefillAfterIdle);
+  RUN_TEST(TestNoBurst);
+  RUN_TEST(TestMacroReportsSuppressed);
+  RUN_TEST(TestMacroCompiledOut);
+  return UNITY_END();
+}
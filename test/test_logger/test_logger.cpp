@@ -0,0 +1,103 @@
+#include <ESPTools/logger.h>
+
+#include <esp_log.h>
+
+#include <unity.h>
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+// Compile-time filtering of the ESPTOOLS_LOG* macros against the LOG_LEVEL constant in scope
+
+namespace
+{
+
+  // Tag used for the logging system
+  constexpr char LOG_TAG[]{"Logger Test"};
+
+  // Last line written by the logging system, and the number of lines
+  char last_line[256];
+  int line_count{0};
+
+  // Number of times a log argument was evaluated
+  int evaluations{0};
+
+  int CaptureLine(const char *const format, va_list args)
+  {
+    ++line_count;
+    return vsnprintf(last_line, sizeof(last_line), format, args);
+  }
+
+  int Evaluate() { return ++evaluations; }
+
+  void TestEnabledLevelIsWritten()
+  {
+    ESPTOOLS_LOGW("value %d", Evaluate());
+    TEST_ASSERT_EQUAL_INT(1, evaluations);
+    TEST_ASSERT_EQUAL_INT(1, line_count);
+    // The caller function is prepended to the message
+    TEST_ASSERT_NOT_NULL(strstr(last_line, "[TestEnabledLevelIsWritten] value 1"));
+    TEST_ASSERT_NOT_NULL(strstr(last_line, LOG_TAG));
+  }
+
+  void TestLevelsAboveLogLevelAreCompiledOut()
+  {
+    // Shadows the global level, as a module does with its own LOG_LEVEL
+    static constexpr esp_log_level_t LOG_LEVEL{ESP_LOG_WARN};
+    static_assert(ESPTOOLS_LOG_ENABLED(ESP_LOG_WARN));
+    static_assert(!ESPTOOLS_LOG_ENABLED(ESP_LOG_INFO));
+
+    // Compiled out calls do not even evaluate their arguments
+    ESPTOOLS_LOGI("value %d", Evaluate());
+    ESPTOOLS_LOGD("value %d", Evaluate());
+    ESPTOOLS_LOGV("value %d", Evaluate());
+    TEST_ASSERT_EQUAL_INT(0, evaluations);
+    TEST_ASSERT_EQUAL_INT(0, line_count);
+
+    ESPTOOLS_LOGE("value %d", Evaluate());
+    TEST_ASSERT_EQUAL_INT(1, evaluations);
+    TEST_ASSERT_EQUAL_INT(1, line_count);
+  }
+
+  void TestNoneCompilesEverythingOut()
+  {
+    static constexpr esp_log_level_t LOG_LEVEL{ESP_LOG_NONE};
+    ESPTOOLS_LOGE("value %d", Evaluate());
+    ESPTOOLS_LOGE_RL("value %d", Evaluate());
+    TEST_ASSERT_EQUAL_INT(0, evaluations);
+    TEST_ASSERT_EQUAL_INT(0, line_count);
+  }
+
+  void TestRuntimeLevelFiltersCompiledInCalls()
+  {
+    // A compiled in call is still subject to the runtime level of its tag, but its arguments
+    // are evaluated
+    esp_log_level_set(LOG_TAG, ESP_LOG_ERROR);
+    ESPTOOLS_LOGW("value %d", Evaluate());
+    esp_log_level_set(LOG_TAG, ESP_LOG_VERBOSE);
+    TEST_ASSERT_EQUAL_INT(1, evaluations);
+    TEST_ASSERT_EQUAL_INT(0, line_count);
+  }
+
+} // namespace
+
+void setUp()
+{
+  evaluations = 0;
+  line_count = 0;
+  last_line[0] = '\0';
+  esp_log_set_vprintf(CaptureLine);
+}
+
+void tearDown() { esp_log_set_vprintf(vprintf); }
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(TestEnabledLevelIsWritten);
+  RUN_TEST(TestLevelsAboveLogLevelAreCompiledOut);
+  RUN_TEST(TestNoneCompilesEverythingOut);
+  RUN_TEST(TestRuntimeLevelFiltersCompiledInCalls);
+  return UNITY_END();
+}
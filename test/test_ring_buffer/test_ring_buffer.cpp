@@ -0,0 +1,245 @@
+#include <ESPTools/ring_buffer.h>
+
+#include <unity.h>
+
+#include <cstdint>
+#include <thread>
+
+// SpscRingBuffer and MpscRingBuffer: order, full and empty states, and index wraparound
+
+namespace
+{
+
+  using ESPTools::MpscRingBuffer;
+  using ESPTools::SpscRingBuffer;
+
+  void TestSpscPushPop()
+  {
+    SpscRingBuffer<uint32_t, 4> buffer;
+    uint32_t item{0};
+    TEST_ASSERT_TRUE(buffer.Empty());
+    TEST_ASSERT_FALSE(buffer.Pop(item));
+
+    TEST_ASSERT_TRUE(buffer.Push(1));
+    TEST_ASSERT_TRUE(buffer.Push(2));
+    TEST_ASSERT_EQUAL_UINT(2, buffer.Size());
+    TEST_ASSERT_TRUE(buffer.Pop(item));
+    TEST_ASSERT_EQUAL_UINT32(1, item);
+    TEST_ASSERT_TRUE(buffer.Pop(item));
+    TEST_ASSERT_EQUAL_UINT32(2, item);
+    TEST_ASSERT_FALSE(buffer.Pop(item));
+    TEST_ASSERT_TRUE(buffer.Empty());
+  }
+
+  void TestSpscFull()
+  {
+    SpscRingBuffer<uint32_t, 4> buffer;
+    for (uint32_t i{0}; i < buffer.Capacity(); ++i)
+    {
+      TEST_ASSERT_TRUE(buffer.Push(i));
+    }
+    TEST_ASSERT_FALSE(buffer.Push(4));
+    TEST_ASSERT_EQUAL_UINT(4, buffer.Size());
+
+    // Freeing one slot makes room for exactly one element
+    uint32_t item{0};
+    TEST_ASSERT_TRUE(buffer.Pop(item));
+    TEST_ASSERT_EQUAL_UINT32(0, item);
+    TEST_ASSERT_TRUE(buffer.Push(4));
+    TEST_ASSERT_FALSE(buffer.Push(5));
+  }
+
+  void TestSpscWrap()
+  {
+    // Many laps over the slots keep the order
+    SpscRingBuffer<uint32_t, 4> buffer;
+    uint32_t next{0};
+    for (uint32_t i{0}; i < 100; ++i)
+    {
+      TEST_ASSERT_TRUE(buffer.Push(2 * i));
+      TEST_ASSERT_TRUE(buffer.Push(2 * i + 1));
+      for (int j{0}; j < 2; ++j)
+      {
+        uint32_t item{0};
+        TEST_ASSERT_TRUE(buffer.Pop(item));
+        TEST_ASSERT_EQUAL_UINT32(next++, item);
+      }
+    }
+    TEST_ASSERT_TRUE(buffer.Empty());
+  }
+
+  void TestSpscBatchAndDrain()
+  {
+    SpscRingBuffer<uint32_t, 8> buffer;
+    for (uint32_t i{0}; i < 6; ++i)
+    {
+      buffer.Push(i);
+    }
+    uint32_t items[4]{};
+    TEST_ASSERT_EQUAL_UINT(4, buffer.PopBatch(items, 4));
+    TEST_ASSERT_EQUAL_UINT32(0, items[0]);
+    TEST_ASSERT_EQUAL_UINT32(3, items[3]);
+
+    uint32_t expected{4};
+    TEST_ASSERT_EQUAL_UINT(2, buffer.Drain([&expected](const uint32_t &item)
+                                           { TEST_ASSERT_EQUAL_UINT32(expected++, item); }));
+    TEST_ASSERT_EQUAL_UINT32(6, expected);
+    TEST_ASSERT_EQUAL_UINT(0, buffer.PopBatch(items, 4));
+  }
+
+  void TestSpscThreads()
+  {
+    static SpscRingBuffer<uint32_t, 16> buffer;
+    constexpr uint32_t COUNT{100000};
+    std::thread producer(
+        []
+        {
+          for (uint32_t i{0}; i < COUNT; ++i)
+          {
+            while (!buffer.Push(i))
+            {
+              std::this_thread::yield();
+            }
+          }
+        });
+    uint32_t expected{0};
+    bool in_order{true};
+    while (expected < COUNT)
+    {
+      uint32_t item;
+      if (buffer.Pop(item))
+      {
+        in_order = in_order && item == expected;
+        ++expected;
+      }
+    }
+    producer.join();
+    TEST_ASSERT_TRUE(in_order);
+    TEST_ASSERT_TRUE(buffer.Empty());
+  }
+
+  void TestMpscPushPop()
+  {
+    MpscRingBuffer<uint32_t, 4> buffer;
+    uint32_t item{0};
+    TEST_ASSERT_FALSE(buffer.Pop(item));
+    TEST_ASSERT_TRUE(buffer.Push(1));
+    TEST_ASSERT_TRUE(buffer.Push(2));
+    TEST_ASSERT_TRUE(buffer.Pop(item));
+    TEST_ASSERT_EQUAL_UINT32(1, item);
+    TEST_ASSERT_TRUE(buffer.Pop(item));
+    TEST_ASSERT_EQUAL_UINT32(2, item);
+    TEST_ASSERT_FALSE(buffer.Pop(item));
+  }
+
+  void TestMpscFull()
+  {
+    MpscRingBuffer<uint32_t, 4> buffer;
+    for (uint32_t i{0}; i < buffer.Capacity(); ++i)
+    {
+      TEST_ASSERT_TRUE(buffer.Push(i));
+    }
+    TEST_ASSERT_FALSE(buffer.Push(4));
+    uint32_t item{0};
+    TEST_ASSERT_TRUE(buffer.Pop(item));
+    TEST_ASSERT_TRUE(buffer.Push(4));
+    TEST_ASSERT_FALSE(buffer.Push(5));
+  }
+
+  void TestMpscWrap()
+  {
+    MpscRingBuffer<uint32_t, 4> buffer;
+    uint32_t next{0};
+    for (uint32_t i{0}; i < 100; ++i)
+    {
+      TEST_ASSERT_TRUE(buffer.Push(3 * i));
+      TEST_ASSERT_TRUE(buffer.Push(3 * i + 1));
+      TEST_ASSERT_TRUE(buffer.Push(3 * i + 2));
+      uint32_t item{0};
+      TEST_ASSERT_TRUE(buffer.Pop(item));
+      TEST_ASSERT_EQUAL_UINT32(next++, item);
+      TEST_ASSERT_EQUAL_UINT(2, buffer.Drain([&next](const uint32_t &drained)
+                                             { TEST_ASSERT_EQUAL_UINT32(next++, drained); }));
+    }
+    uint32_t item{0};
+    TEST_ASSERT_FALSE(buffer.Pop(item));
+  }
+
+  void TestMpscDrainLimit()
+  {
+    MpscRingBuffer<uint32_t, 8> buffer;
+    for (uint32_t i{0}; i < 5; ++i)
+    {
+      buffer.Push(i);
+    }
+    uint32_t seen{0};
+    TEST_ASSERT_EQUAL_UINT(3, buffer.Drain([&seen](const uint32_t &) { ++seen; }, 3));
+    TEST_ASSERT_EQUAL_UINT(2, buffer.Drain([&seen](const uint32_t &) { ++seen; }));
+    TEST_ASSERT_EQUAL_UINT32(5, seen);
+  }
+
+  void TestMpscThreads()
+  {
+    // Every element of every producer arrives once, in the order of its producer
+    static MpscRingBuffer<uint32_t, 64> buffer;
+    constexpr uint32_t PRODUCERS{4};
+    constexpr uint32_t COUNT{20000};
+    std::thread producers[PRODUCERS];
+    for (uint32_t p{0}; p < PRODUCERS; ++p)
+    {
+      producers[p] = std::thread(
+          [p]
+          {
+            for (uint32_t i{0}; i < COUNT; ++i)
+            {
+              while (!buffer.Push(p << 24 | i))
+              {
+                std::this_thread::yield();
+              }
+            }
+          });
+    }
+    uint32_t next[PRODUCERS]{};
+    uint32_t received{0};
+    bool in_order{true};
+    while (received < PRODUCERS * COUNT)
+    {
+      uint32_t item;
+      if (buffer.Pop(item))
+      {
+        const uint32_t producer{item >> 24};
+        in_order = in_order && producer < PRODUCERS && (item & 0xFFFFFF) == next[producer];
+        ++next[producer & (PRODUCERS - 1)];
+        ++received;
+      }
+    }
+    for (std::thread &producer : producers)
+    {
+      producer.join();
+    }
+    TEST_ASSERT_TRUE(in_order);
+    uint32_t item;
+    TEST_ASSERT_FALSE(buffer.Pop(item));
+  }
+
+} // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(TestSpscPushPop);
+  RUN_TEST(TestSpscFull);
+  RUN_TEST(TestSpscWrap);
+  RUN_TEST(TestSpscBatchAndDrain);
+  RUN_TEST(TestSpscThreads);
+  RUN_TEST(TestMpscPushPop);
+  RUN_TEST(TestMpscFull);
+  RUN_TEST(TestMpscWrap);
+  RUN_TEST(TestMpscDrainLimit);
+  RUN_TEST(TestMpscThreads);
+  return UNITY_END();
+}
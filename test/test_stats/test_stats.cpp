@@ -0,0 +1,147 @@
+#include <ESPTools/stats.h>
+
+#include <unity.h>
+
+#include <cstdint>
+
+// RunningStats, IntegerSqrt and Log2Histogram
+
+namespace
+{
+
+  using ESPTools::IntegerSqrt;
+  using ESPTools::Log2Histogram;
+  using ESPTools::RunningStats;
+
+  static_assert(IntegerSqrt(0) == 0);
+  static_assert(IntegerSqrt(15) == 3);
+  static_assert(IntegerSqrt(16) == 4);
+  static_assert(IntegerSqrt(UINT64_MAX) == UINT32_MAX);
+
+  void TestRunningStatsEmpty()
+  {
+    const RunningStats<> stats;
+    TEST_ASSERT_EQUAL_UINT32(0, stats.GetCount());
+    TEST_ASSERT_EQUAL_UINT32(0, stats.GetMin());
+    TEST_ASSERT_EQUAL_UINT32(0, stats.GetMax());
+    TEST_ASSERT_EQUAL_UINT32(0, stats.GetMean());
+    TEST_ASSERT_EQUAL_UINT64(0, stats.GetVariance());
+  }
+
+  void TestRunningStatsValues()
+  {
+    RunningStats<> stats;
+    for (const uint32_t value : {2, 4, 4, 4, 5, 5, 7, 9})
+    {
+      stats.Add(value);
+    }
+    TEST_ASSERT_EQUAL_UINT32(8, stats.GetCount());
+    TEST_ASSERT_EQUAL_UINT32(2, stats.GetMin());
+    TEST_ASSERT_EQUAL_UINT32(9, stats.GetMax());
+    TEST_ASSERT_EQUAL_UINT32(5, stats.GetMean());
+    TEST_ASSERT_EQUAL_UINT64(4, stats.GetVariance());
+    TEST_ASSERT_EQUAL_UINT32(2, stats.GetStdDev());
+
+    stats.Reset();
+    TEST_ASSERT_EQUAL_UINT32(0, stats.GetCount());
+    stats.Add(7);
+    TEST_ASSERT_EQUAL_UINT32(7, stats.GetMin());
+    TEST_ASSERT_EQUAL_UINT32(7, stats.GetMax());
+  }
+
+  void TestRunningStatsLargeOffset()
+  {
+    // The sums are relative to the first sample, so large values keep an exact variance
+    RunningStats<> stats;
+    for (uint32_t i{0}; i < 1000; ++i)
+    {
+      stats.Add(4000000000U + (i % 2) * 10);
+    }
+    TEST_ASSERT_EQUAL_UINT32(4000000005U, stats.GetMean());
+    TEST_ASSERT_EQUAL_UINT64(25, stats.GetVariance());
+    TEST_ASSERT_EQUAL_UINT32(5, stats.GetStdDev());
+  }
+
+  void TestRunningStatsSigned()
+  {
+    RunningStats<int32_t> stats;
+    stats.Add(-10);
+    stats.Add(10);
+    stats.Add(-3);
+    TEST_ASSERT_EQUAL_INT32(-10, stats.GetMin());
+    TEST_ASSERT_EQUAL_INT32(10, stats.GetMax());
+    // -1 rounded towards zero
+    TEST_ASSERT_EQUAL_INT32(-1, stats.GetMean());
+    // Sum of squares 209, minus 9 / 3, over 3
+    TEST_ASSERT_EQUAL_UINT64(68, stats.GetVariance());
+  }
+
+  void TestLog2HistogramBuckets()
+  {
+    using Histogram = Log2Histogram<>;
+    static_assert(Histogram::GetBucket(0) == 0);
+    static_assert(Histogram::GetBucket(1) == 1);
+    static_assert(Histogram::GetBucket(2) == 2 && Histogram::GetBucket(3) == 2);
+    static_assert(Histogram::GetBucket(UINT32_MAX) == 32);
+    static_assert(Histogram::GetBucketMin(0) == 0 && Histogram::GetBucketMin(5) == 16);
+    // Larger samples go to the last bucket of a short histogram
+    static_assert(Log2Histogram<4>::GetBucket(1000) == 3);
+
+    Histogram histogram;
+    for (const uint32_t value : {0U, 1U, 3U, 3U, 100U})
+    {
+      histogram.Add(value);
+    }
+    TEST_ASSERT_EQUAL_UINT32(5, histogram.GetTotal());
+    TEST_ASSERT_EQUAL_UINT32(1, histogram.GetCount(0));
+    TEST_ASSERT_EQUAL_UINT32(1, histogram.GetCount(1));
+    TEST_ASSERT_EQUAL_UINT32(2, histogram.GetCount(2));
+    TEST_ASSERT_EQUAL_UINT32(1, histogram.GetCount(Histogram::GetBucket(100)));
+
+    histogram.Reset();
+    TEST_ASSERT_EQUAL_UINT32(0, histogram.GetTotal());
+  }
+
+  void TestLog2HistogramPercentiles()
+  {
+    Log2Histogram<> histogram;
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, histogram.GetPercentile(50));
+
+    // 90 samples in [8, 16) and 10 in [1024, 2048)
+    for (uint32_t i{0}; i < 90; ++i)
+    {
+      histogram.Add(8 + i % 8);
+    }
+    for (uint32_t i{0}; i < 10; ++i)
+    {
+      histogram.Add(1024 + i);
+    }
+    // The result is the upper bound of the bucket holding the percentile
+    TEST_ASSERT_EQUAL_UINT32(16, histogram.GetPercentile(50));
+    TEST_ASSERT_EQUAL_UINT32(16, histogram.GetPercentile(90));
+    TEST_ASSERT_EQUAL_UINT32(2048, histogram.GetPercentile(91));
+    TEST_ASSERT_EQUAL_UINT32(2048, histogram.GetPercentile(100));
+
+    // Samples of the last bucket have no upper bound
+    Log2Histogram<4> saturated;
+    saturated.Add(1000);
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, saturated.GetPercentile(50));
+  }
+
+} // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(TestRunningStatsEmpty);
+  RUN_TEST(TestRunningStatsValues);
+  RUN_TEST(TestRunningStatsLargeOffset);
+  RUN_TEST(TestRunningStatsSigned);
+  RUN_TEST(TestLog2HistogramBuckets);
+  RUN_TEST(TestLog2HistogramPercentiles);
+  return UNITY_END();
+}